@@ -106,6 +106,8 @@ CREATE TABLE SensorTypes
 (
   typeId SERIAL,
   typeName varchar(64) not null,
+  positionVariance double precision not null default 0.001,
+  mosVariance double precision not null default 0.001,
 
   CONSTRAINT pk_IdOfType PRIMARY KEY(typeId),
   CONSTRAINT uq_UniqueTypeName UNIQUE(typeName)
@@ -114,6 +116,29 @@ CREATE TABLE SensorTypes
 COMMENT ON TABLE SensorTypes IS 'Contains names of sensor types identifying parameters they are providing';
 COMMENT ON COLUMN SensorTypes.typeId IS 'Unique ID of type of sensor';
 COMMENT ON COLUMN SensorTypes.typeName IS 'Name of type of sensor - human readable';
+COMMENT ON COLUMN SensorTypes.positionVariance IS 'Variance of longitude and latitude measured by sensors of this type';
+COMMENT ON COLUMN SensorTypes.mosVariance IS 'Variance of meters over sea measured by sensors of this type';
+
+CREATE TABLE Sensors
+(
+  sensorId SERIAL,
+  typeId integer not null,
+  lon longitude not null,
+  lat latitude not null,
+  mos metersOverSea not null,
+  range double precision not null,
+  positionVariance double precision,
+  mosVariance double precision,
+
+  CONSTRAINT pk_IdOfSensor PRIMARY KEY(sensorId),
+  CONSTRAINT fk_TypeOfSensor FOREIGN KEY(typeId) REFERENCES SensorTypes(typeId)
+);
+
+COMMENT ON TABLE Sensors IS 'Contains sensors placed in observed area';
+COMMENT ON COLUMN Sensors.sensorId IS 'Unique ID of sensor';
+COMMENT ON COLUMN Sensors.range IS 'Range of sensor [m]';
+COMMENT ON COLUMN Sensors.positionVariance IS 'Variance of longitude and latitude measured by this sensor - when NULL, the one of sensor type is used';
+COMMENT ON COLUMN Sensors.mosVariance IS 'Variance of meters over sea measured by this sensor - when NULL, the one of sensor type is used';
 
 
 END;
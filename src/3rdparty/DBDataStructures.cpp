@@ -1,5 +1,6 @@
 #include "DBDataStructures.h"
 #include <algorithm>
+#include <sstream>
 #include <boost/bind.hpp>
 
 namespace Model
@@ -13,27 +14,47 @@ StreetNode::StreetNode(pqxx::tuple tableRow)
 {
 }
 
-Street::Street(pqxx::tuple tableRow,
-               const StreetNodes& vertexes)
-  : first(NULL),
-    second(NULL)
+StreetNode::StreetNode(int nodeId, double lon, double lat, double mos)
+  : nodeId(nodeId),
+    lon(lon),
+    lat(lat),
+    mos(mos)
+{
+}
+
+StreetNodesIndex indexStreetNodes(const StreetNodes& vertexes)
+{
+  StreetNodesIndex result;
+  result.reserve(vertexes.size());
+  for(const StreetNodePtr& node : vertexes)
+    result.insert(std::make_pair(node->nodeId, node));
+
+  return result;
+}
+
+static StreetNodePtr findStreetNode(const StreetNodesIndex& vertexes, int id)
 {
-  int id[2] = { tableRow["firstNode" ].as<int>(),
-                tableRow["secondNode"].as<int>() };
+  StreetNodesIndex::const_iterator iter = vertexes.find(id);
+  if(iter == vertexes.end())
+  {
+    std::stringstream ss;
+    ss << "Street refers to not existing node " << id;
+    throw GeneralException(ss.str().c_str());
+  }
+  return iter->second;
+}
 
-  first = *std::find_if(vertexes.begin(),
-                        vertexes.end(),
-                        [&id](const StreetNodePtr& ref) -> bool
-                        {
-                          return ref->nodeId == id[0];
-                        });
+Street::Street(pqxx::tuple tableRow,
+               const StreetNodesIndex& vertexes)
+  : first(findStreetNode(vertexes, tableRow["firstNode" ].as<int>())),
+    second(findStreetNode(vertexes, tableRow["secondNode"].as<int>()))
+{
+}
 
-  second = *std::find_if(vertexes.begin(),
-                         vertexes.end(),
-                         [&id](const StreetNodePtr& ref) -> bool
-                         {
-                           return ref->nodeId == id[1];
-                         });
+Street::Street(StreetNodePtr first, StreetNodePtr second)
+  : first(first),
+    second(second)
+{
 }
 
 Map::Map(const StreetNodes &vertexes, const Streets &edges)
@@ -41,23 +62,93 @@ Map::Map(const StreetNodes &vertexes, const Streets &edges)
     edges(edges)
 {
   double minX = 360, minY = 360;
-  for(StreetNodePtr& node : this->vertexes)
+  vertexIndices.reserve(this->vertexes.size());
+  for(std::size_t i = 0; i < this->vertexes.size(); ++i)
   {
+    const StreetNodePtr& node = this->vertexes[i];
     minX = std::min(node->lon.get(), minX);
     minY = std::min(node->lat.get(), minY);
+    vertexIndices.insert(std::make_pair(node->nodeId, i));
   }
   normalizationVector[0] = minX;
   normalizationVector[1] = minY;
+
+  // CSR adjacency: count degrees, prefix sum, then scatter edge indices
+  std::vector<std::pair<std::size_t, std::size_t> > endpoints;
+  endpoints.reserve(this->edges.size());
+  for(const StreetPtr& street : this->edges)
+  {
+    endpoints.push_back(std::make_pair(vertexIndex(street->first->nodeId),
+                                       vertexIndex(street->second->nodeId)));
+    if(endpoints.back().first == npos || endpoints.back().second == npos)
+      throw GeneralException("Street refers to node not existing in Map");
+  }
+
+  adjacencyOffsets.assign(this->vertexes.size()+1, 0);
+  for(const auto& ends : endpoints)
+  {
+    ++adjacencyOffsets[ends.first+1];
+    if(ends.second != ends.first) // loop is listed once
+      ++adjacencyOffsets[ends.second+1];
+  }
+  for(std::size_t i = 1; i < adjacencyOffsets.size(); ++i)
+    adjacencyOffsets[i] += adjacencyOffsets[i-1];
+
+  adjacentEdges.resize(adjacencyOffsets.back());
+  std::vector<std::size_t> fill(adjacencyOffsets.begin(),
+                                adjacencyOffsets.end()-1);
+  for(std::size_t i = 0; i < endpoints.size(); ++i)
+  {
+    adjacentEdges[fill[endpoints[i].first]++] = i;
+    if(endpoints[i].second != endpoints[i].first)
+      adjacentEdges[fill[endpoints[i].second]++] = i;
+  }
 }
 
-Streets Map::streetsInVertex(StreetNodePtr vertex)
+Streets Map::streetsInVertex(StreetNodePtr vertex) const
 {
   Streets result;
-  for(const StreetPtr& street : edges)
-    if(street->first == vertex || street->second == vertex)
-      result.push_back(street);
+  EdgesRange range = edgesInVertex(vertexIndex(vertex->nodeId));
+  for(const std::size_t* edge = range.first; edge != range.second; ++edge)
+    result.push_back(edges[*edge]);
 
   return result;
 }
 
+std::size_t Map::vertexIndex(int nodeId) const
+{
+  std::unordered_map<int, std::size_t>::const_iterator iter
+      = vertexIndices.find(nodeId);
+  if(iter == vertexIndices.end())
+    return npos;
+
+  return iter->second;
+}
+
+Map::EdgesRange Map::edgesInVertex(std::size_t vertexIndex) const
+{
+  if(vertexIndex == npos || vertexIndex+1 >= adjacencyOffsets.size())
+    return EdgesRange(nullptr, nullptr);
+
+  const std::size_t* data = adjacentEdges.data();
+  return EdgesRange(data+adjacencyOffsets[vertexIndex],
+                    data+adjacencyOffsets[vertexIndex+1]);
+}
+
+const std::size_t Map::npos;
+
+bool MapFingerprint::operator==(const MapFingerprint& other) const
+{
+  return nodesCount == other.nodesCount
+      && edgesCount == other.edgesCount
+      && maxNodeId == other.maxNodeId
+      && nodesChecksum == other.nodesChecksum
+      && edgesChecksum == other.edgesChecksum;
+}
+
+bool MapFingerprint::operator!=(const MapFingerprint& other) const
+{
+  return !(*this == other);
+}
+
 }//namespace Model
@@ -4,7 +4,11 @@
 #include "ConstrainedNumeric.hpp"
 #include <pqxx/pqxx>
 
+#include <cstddef>
+#include <cstdint>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <memory>
 
@@ -18,6 +22,7 @@ typedef ConstrainedNumeric<-420, 8850> MetersOverSea;
 struct StreetNode
 {
   StreetNode(pqxx::tuple tableRow);
+  StreetNode(int nodeId, double lon, double lat, double mos);
 
   int nodeId;
   Longitude lon;
@@ -27,11 +32,19 @@ struct StreetNode
 
 typedef std::shared_ptr<StreetNode> StreetNodePtr;
 typedef std::vector<StreetNodePtr> StreetNodes;
+typedef std::unordered_map<int, StreetNodePtr> StreetNodesIndex; // by nodeId
+
+StreetNodesIndex indexStreetNodes(const StreetNodes& vertexes);
 
 struct Street
 {
+  /**
+   * @brief Resolves both endpoints in index, in O(1).
+   * @throw GeneralException - when endpoint is not in index
+   */
   Street(pqxx::tuple tableRow,
-         const StreetNodes& vertexes); //TODO use std::set here
+         const StreetNodesIndex& vertexes);
+  Street(StreetNodePtr first, StreetNodePtr second);
 
   StreetNodePtr first;
   StreetNodePtr second;
@@ -40,18 +53,60 @@ struct Street
 typedef std::shared_ptr<Street> StreetPtr;
 typedef std::vector<StreetPtr> Streets;
 
+/**
+ * @brief Street graph. Adjacency is kept in CSR (compressed sparse row) form:
+ *  edges of vertex i are edges[adjacentEdges[adjacencyOffsets[i]]]
+ *  ... edges[adjacentEdges[adjacencyOffsets[i+1]-1]].
+ *  All endpoints of edges have to be in vertexes.
+ */
 struct Map
 {
+  typedef std::pair<const std::size_t*, const std::size_t*> EdgesRange;
+
+  static const std::size_t npos = static_cast<std::size_t>(-1);
+
   Map(const StreetNodes& vertexes, const Streets& edges);
-  Streets streetsInVertex(StreetNodePtr vertex);
+  Streets streetsInVertex(StreetNodePtr vertex) const;
+
+  /**
+   * @return position of node in vertexes or npos, when there is no such node
+   */
+  std::size_t vertexIndex(int nodeId) const;
+
+  /**
+   * @return [begin,end) range of indices (in edges) of streets,
+   *  which start or end in vertex of given index (in vertexes)
+   */
+  EdgesRange edgesInVertex(std::size_t vertexIndex) const;
 
   StreetNodes vertexes;
   Streets     edges;
   double      normalizationVector[2];
+
+  std::unordered_map<int, std::size_t> vertexIndices; // nodeId -> position
+  std::vector<std::size_t> adjacencyOffsets; // vertexes.size()+1 entries
+  std::vector<std::size_t> adjacentEdges; // 2 entries per edge
 };
 
 typedef std::shared_ptr<Map> MapPtr;
 
+/**
+ * @brief Summary of map content in static DB, cheap to fetch,
+ *  which changes whenever any node or street changes
+ *  (e.g. to detect, that cached map is stale).
+ */
+struct MapFingerprint
+{
+  std::uint64_t nodesCount;
+  std::uint64_t edgesCount;
+  std::int64_t maxNodeId;
+  std::int64_t nodesChecksum; // sum of hashes of nodes' rows
+  std::int64_t edgesChecksum; // sum of hashes of streets' rows
+
+  bool operator==(const MapFingerprint& other) const;
+  bool operator!=(const MapFingerprint& other) const;
+};
+
 }//namespace Model
 
 #endif // DBDATASTRUCTURES_H
@@ -33,6 +33,7 @@ StreetNodes StaticBaseDriver::getStreetNodes()
   std::string query("SELECT streetNodeId, lon, lat, mos FROM StreetNodes");
   pqxx::work t(*connection_);
   pqxx::result nodes = t.exec(query);
+  result.reserve(nodes.size());
   for(const auto& node : nodes)
     result.push_back(StreetNodePtr(new StreetNode(node)));
 
@@ -46,12 +47,14 @@ MapPtr StaticBaseDriver::getMap()
   //Common::globLog("NOT", "DBDri", "Reading whole map from DB...");
   ensureDBConnection();
   StreetNodes vertexes = getStreetNodes();
+  StreetNodesIndex vertexesIndex = indexStreetNodes(vertexes);
   Streets edges; //TODO move getEdges to separedted method
   std::string query("SELECT firstNode, secondNode FROM Streets");
   pqxx::work t(*connection_);
   pqxx::result streets = t.exec(query);
+  edges.reserve(streets.size());
   for(const auto& street : streets)
-    edges.push_back(StreetPtr(new Street(street, vertexes)));
+    edges.push_back(StreetPtr(new Street(street, vertexesIndex)));
 
   MapPtr result(new Map(vertexes, edges));
   disconnectIfNecessary();
@@ -59,6 +62,33 @@ MapPtr StaticBaseDriver::getMap()
   return result;
 }
 
+MapFingerprint StaticBaseDriver::getMapFingerprint()
+{
+  ensureDBConnection();
+  // sums of hashes don't depend on order of rows
+  std::string query(
+        "SELECT"
+        " (SELECT count(*) FROM StreetNodes),"
+        " (SELECT count(*) FROM Streets),"
+        " (SELECT coalesce(max(streetNodeId),0) FROM StreetNodes),"
+        " (SELECT coalesce(sum(hashtext(concat_ws(' ',streetNodeId,"
+        "lon,lat,mos))),0) FROM StreetNodes),"
+        " (SELECT coalesce(sum(hashtext(concat_ws(' ',firstNode,"
+        "secondNode))),0) FROM Streets)");
+  pqxx::work t(*connection_);
+  pqxx::result fingerprint = t.exec(query);
+
+  MapFingerprint result;
+  result.nodesCount = fingerprint[0][0].as<std::uint64_t>();
+  result.edgesCount = fingerprint[0][1].as<std::uint64_t>();
+  result.maxNodeId = fingerprint[0][2].as<std::int64_t>();
+  result.nodesChecksum = fingerprint[0][3].as<std::int64_t>();
+  result.edgesChecksum = fingerprint[0][4].as<std::int64_t>();
+
+  disconnectIfNecessary();
+  return result;
+}
+
 bool StaticBaseDriver::ensureDBConnection()
 {
   if(connection_ != NULL)
@@ -32,6 +32,12 @@ public:
   StreetNodes getStreetNodes();
   MapPtr getMap();
 
+  /**
+   * @brief Computes fingerprint of map in DB (one aggregating query,
+   *  rows are not transferred).
+   */
+  MapFingerprint getMapFingerprint();
+
 private:
   /**
    * @brief ensures that class instantion has established connection to db
@@ -0,0 +1,230 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Common
+{
+
+/**
+ * @brief Monotonic memory arena. Allocation is a pointer bump,
+ *  deallocation does nothing - all memory is freed at once by release().
+ *
+ * Blocks are kept after release(), so in steady state (e.g. every cycle
+ * of tracking allocates similar amount of temporaries) no memory is taken
+ * from global allocator at all. Arena is used by one thread at once.
+ */
+class Arena
+{
+public:
+  explicit Arena(std::size_t blockSize = 64*1024)
+    : blockSize_(std::max(blockSize,std::size_t(alignment))),
+      block_(0),
+      position_(0)
+  {}
+
+  void* allocate(std::size_t bytes)
+  {
+    bytes = (bytes + alignment - 1) & ~(alignment - 1);
+    while (block_ < blocks_.size())
+    {
+      if (blocks_[block_].size - position_ >= bytes)
+      {
+        void* result = blocks_[block_].data.get() + position_;
+        position_ += bytes;
+        return result;
+      }
+      ++block_; // the rest of block is wasted, until release()
+      position_ = 0;
+    }
+
+    // each new block is at least twice as big as the previous one
+    std::size_t size = blocks_.empty() ? blockSize_ : 2*blocks_.back().size;
+    size = std::max(size,bytes);
+    blocks_.push_back(Block(size));
+    block_ = blocks_.size() - 1;
+    position_ = bytes;
+    return blocks_.back().data.get();
+  }
+
+  /**
+   * @brief Frees everything allocated from arena.
+   *  Memory is not returned to the system, but reused.
+   */
+  void release()
+  {
+    block_ = 0;
+    position_ = 0;
+  }
+
+  /**
+   * @return bytes taken from global allocator
+   */
+  std::size_t getCapacity() const
+  {
+    std::size_t capacity = 0;
+    for (const Block& block : blocks_)
+      capacity += block.size;
+    return capacity;
+  }
+
+  /**
+   * @return arena set for current thread by ArenaScope
+   *  (nullptr, when there is no such)
+   */
+  static Arena*& current()
+  {
+    static thread_local Arena* arena = nullptr;
+    return arena;
+  }
+
+private:
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // enough for every fundamental type
+  static const std::size_t alignment = alignof(std::max_align_t);
+
+  struct Block
+  {
+    explicit Block(std::size_t s)
+      : data(new char[s]),
+        size(s)
+    {}
+
+    std::unique_ptr<char[]> data; // new[] is aligned for every fundamental type
+    std::size_t size;
+  };
+
+  const std::size_t blockSize_;
+  std::vector<Block> blocks_;
+  std::size_t block_; // current
+  std::size_t position_; // in current block
+};
+
+/**
+ * @brief Sets arena for current thread, for the lifetime of scope.
+ *  Arena is released, when the outermost scope of it ends,
+ *  so every container allocated from it has to be destroyed before.
+ */
+class ArenaScope
+{
+public:
+  explicit ArenaScope(Arena& arena)
+    : arena_(arena),
+      previous_(Arena::current()),
+      owner_(previous_ != &arena)
+  {
+    Arena::current() = &arena_;
+  }
+
+  ~ArenaScope()
+  {
+    Arena::current() = previous_;
+    if (owner_)
+      arena_.release();
+  }
+
+private:
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  Arena& arena_;
+  Arena* const previous_;
+  const bool owner_;
+};
+
+/**
+ * @brief Standard allocator taking memory from arena of current thread,
+ *  which was set when allocator was created. When there was no arena,
+ *  global allocator is used.
+ *
+ * Use it only for temporaries, which never outlive ArenaScope.
+ */
+template <class Type>
+class ArenaAllocator
+{
+public:
+  typedef Type value_type;
+  typedef Type* pointer;
+  typedef const Type* const_pointer;
+  typedef Type& reference;
+  typedef const Type& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <class Other>
+  struct rebind
+  {
+    typedef ArenaAllocator<Other> other;
+  };
+
+  ArenaAllocator()
+    : arena_(Arena::current())
+  {}
+
+  template <class Other>
+  ArenaAllocator(const ArenaAllocator<Other>& other)
+    : arena_(other.getArena())
+  {}
+
+  Type* allocate(std::size_t n)
+  {
+    if (arena_)
+      return static_cast<Type*>(arena_->allocate(n*sizeof(Type)));
+    return static_cast<Type*>(::operator new(n*sizeof(Type)));
+  }
+
+  void deallocate(Type* p, std::size_t)
+  {
+    if (!arena_)
+      ::operator delete(p);
+  }
+
+  template <class Other, class... Args>
+  void construct(Other* p, Args&&... args)
+  {
+    ::new(static_cast<void*>(p)) Other(std::forward<Args>(args)...);
+  }
+
+  template <class Other>
+  void destroy(Other* p)
+  {
+    p->~Other();
+  }
+
+  std::size_t max_size() const
+  {
+    return std::size_t(-1) / sizeof(Type);
+  }
+
+  Arena* getArena() const
+  {
+    return arena_;
+  }
+
+private:
+  Arena* arena_;
+};
+
+template <class Type, class Other>
+bool operator==(const ArenaAllocator<Type>& l, const ArenaAllocator<Other>& r)
+{
+  return l.getArena() == r.getArena();
+}
+
+template <class Type, class Other>
+bool operator!=(const ArenaAllocator<Type>& l, const ArenaAllocator<Other>& r)
+{
+  return !(l == r);
+}
+
+} // namespace Common
+
+#endif // ARENA_HPP
@@ -242,6 +242,16 @@ ConfigurationManager::KeyValueMap
         "Eg. when 1 DR is at distance of 1km from second (on X axis), "
         "it's approximately 0.01 longitude from it. The rating for such a DRs "
         "is 10000.")
+      ("Model.TrackManager.DormantTTL", bpo::value<std::string>(),
+        "How long (in seconds) after expiration track can be reacquired. "
+        "Expired tracks which are on the street become dormant, "
+        "their positions are propagated along streets, "
+        "and new DRs near propagated position refresh dormant track, "
+        "instead of initializing new one. 0 disables dormant tracks.")
+      ("Model.TrackManager.ReacquisitionDistance", bpo::value<std::string>(),
+        "Maximum distance (in degrees) between DRs "
+        "and propagated position of dormant track, to reacquire it. "
+        "0 disables dormant tracks.")
       ("Model.ResultComparator.MaximumPositionRate", bpo::value<std::string>(),
         "Factor used to normalize result "
         "of comparation distance between DR and Track. "
@@ -249,18 +259,102 @@ ConfigurationManager::KeyValueMap
         "If set to too little value only DRs with almost the same position "
         "as Tracks could be associated. "
         "This option is connected with Model.DataAssociator.Threshold")
+      ("Model.ResultComparator.PlateGradeRate", bpo::value<std::string>(),
+        "Weight of plates similarity in DR->Track similarity grade. "
+        "Plates are compared with edit distance, "
+        "tolerant to characters confused by OCR. 0 - plates are ignored.")
+      ("Model.ResultComparator.ColorGradeRate", bpo::value<std::string>(),
+        "Weight of colors similarity in DR->Track similarity grade. "
+        "0 - colors are ignored.")
       ("Model.ReportManager.PacketSize", bpo::value<std::string>(),
         "How many DRs obtain from DB at once.")
       ("Model.DataManager.TTL", bpo::value<std::string>(),
         "How long tracks are valid (not expired) without refreshing. "
         "Time is calculated from the latest track refresh time.")
+      ("Model.DataManager.MapCache", bpo::value<std::string>(),
+        "Path of binary cache file with static map. "
+        "When file exists and fingerprint of map in static DB "
+        "(counts and checksums of nodes and streets) didn't change, "
+        "map is read from it instead of static DB, "
+        "otherwise it's written after reading map from DB. "
+        "Empty value disables cache.")
+      ("Model.DataManager.Checkpoint", bpo::value<std::string>(),
+        "Path of checkpoint file - tracks and position in DRs stream "
+        "are stored there periodically and restored at start. "
+        "Empty value (default) disables checkpoints. "
+        "Remove file, to start tracking from scratch - batch replay "
+        "of the same DB continues from stored position otherwise.")
+      ("Model.DataManager.CheckpointInterval", bpo::value<std::string>(),
+        "How often (in seconds of wall clock time) checkpoint is written.")
+      ("Model.DataManager.Filter", bpo::value<std::string>(),
+        "Estimation filter of tracks: Kalman - constant velocity model, "
+        "IMM - interacting multiple models (constant velocity, "
+        "constant acceleration and turns), better on maneuvers.")
+      ("Model.DataManager.SteadyStateTolerance", bpo::value<std::string>(),
+        "Kalman filter of track caches it's gain and stops updating "
+        "covariance, when covariance changes (relatively) less than this "
+        "between updates with the same time step and noise. "
+        "Cache is dropped after gap or noise change. 0 - disabled.")
+      ("Model.DataManager.SteadyTimeStepTolerance", bpo::value<std::string>(),
+        "Time steps (between updates of track) differing relatively less "
+        "than this are the same one for cached Kalman gain - timestamps of "
+        "sensors jitter. 0 - time steps have to be equal.")
+      ("Model.FusionExecutor.CombineDRs", bpo::value<std::string>(),
+        "true - DRs associated with track in one packet are combined "
+        "into one measurement (centroid weighted by inverse variances "
+        "of sensors) and track's filter is corrected once.")
+      ("Model.FusionExecutor.Parallel", bpo::value<std::string>(),
+        "true - DRs are fused into tracks in parallel (in chunks of tracks), "
+        "by threads of Model.TaskScheduler. "
+        "Shards always fuse serially (they run in parallel).")
+      ("Model.TaskScheduler.Threads", bpo::value<std::string>(),
+        "How many worker threads are shared by parallel stages of tracking "
+        "(fusion, snapshot cloning). 0 - one per core.")
+      ("Model.TaskScheduler.PinThreads", bpo::value<std::string>(),
+        "true - each worker thread of Model.TaskScheduler is pinned "
+        "to it's own core.")
+      ("Model.MapMatcher.Enabled", bpo::value<std::string>(),
+        "true - snap updated tracks onto the nearest street from static map "
+        "and constrain their predictions to move along this street.")
+      ("Model.MapMatcher.MaximumDistance", bpo::value<std::string>(),
+        "Tracks farther from any street than this distance "
+        "(in degrees, 0.0005 is ~50m) are not snapped.")
+      ("Model.ShardedTracker.Columns", bpo::value<std::string>(),
+        "Area covered by static map is split into Columns x Rows tiles, "
+        "each tracked by it's own thread. 1x1 disables sharding.")
+      ("Model.ShardedTracker.Rows", bpo::value<std::string>(),
+        "See Model.ShardedTracker.Columns.")
+      ("Model.ShardedTracker.Overlap", bpo::value<std::string>(),
+        "Width (in degrees, 0.001 is ~100m) of strip along tiles' borders. "
+        "Not associated DRs from this strip are associated once more "
+        "with Tracks of neighbouring tile.")
+      ("Model.Distributed.Shards", bpo::value<std::string>(),
+        "Comma-separated host:port addresses of TrackerShard processes, "
+        "one per tile (row by row). Empty - shards run in this process.")
       ("Controller.WorkMode", bpo::value<std::string>(),
         "batch - compute as fast as possible. When no more data is available, "
-        "poll DB periodically to check for new data."
+        "poll DB periodically to check for new data. "
         "online - compute in real time.")
+      ("Controller.BatchSnapshotInterval", bpo::value<std::string>(),
+        "In batch mode, snapshot is taken and shown every so many seconds "
+        "of Model's time (sensor time of processed DRs).")
       ("View.Renderer.VarianceFactor", bpo::value<std::string>(),
        "Indicates how big should be circle meaning variance. "
        "It's multiplier for circle size.")
+      ("View.Renderer.RefreshRate", bpo::value<std::string>(),
+       "Maximum number of scene updates per second. "
+       "Snapshots coming faster replace these not drawn yet.")
+      ("View.Renderer.GridCellSize", bpo::value<std::string>(),
+       "Size (in degrees) of grid cell used to find items in viewport. "
+       "Heat map cells drawn when zoomed out are built of these cells.")
+      ("View.Renderer.HeatMapThreshold", bpo::value<std::string>(),
+       "When track on screen is smaller than this number of pixels, "
+       "tracks are drawn as heat map instead.")
+      ("View.Renderer.HeatCellSize", bpo::value<std::string>(),
+       "Size (in pixels) of heat map cell. Grid cells are aggregated "
+       "into heat cells of about this size on screen, whatever the zoom.")
+      ("View.Renderer.PredictionThreshold", bpo::value<std::string>(),
+       "Predictions smaller than this number of pixels are hidden.")
       ;
 
   bpo::store(bpo::parse_config_file(file, desc), vm);
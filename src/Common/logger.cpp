@@ -14,9 +14,16 @@ GlobalLogger& GlobalLogger::getInstance()
   return instance;
 }
 
+GlobalLogger::GlobalLogger()
+  : hasAgent_(false)
+{}
+
 GlobalLogger& GlobalLogger::log(const std::string& module,
                                 const std::string& msg)
 {
+  if (!hasAgent_.load(std::memory_order_acquire))
+    return *this;
+
   std::lock_guard<std::mutex> lock(mutex_);
   if (agent_)
     agent_->log(module,msg);
@@ -26,7 +33,9 @@ GlobalLogger& GlobalLogger::log(const std::string& module,
 
 void GlobalLogger::setAgent(std::unique_ptr<LoggerAgent> agent)
 {
+  std::lock_guard<std::mutex> lock(mutex_);
   agent_ = std::move(agent);
+  hasAgent_.store(static_cast<bool>(agent_),std::memory_order_release);
 }
 
 std::string LoggerAgent::getCurrentTime() const
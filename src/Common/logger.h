@@ -1,6 +1,7 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -30,16 +31,21 @@ class GlobalLogger
 public:
   static GlobalLogger& getInstance();
 
+  /**
+   * @brief Passes message to agent. Without agent returns at once
+   *  (without locking), so logging threads don't wait for each other.
+   */
   GlobalLogger& log(const std::string& module, const std::string& msg);
   void setAgent(std::unique_ptr<LoggerAgent> agent);
 
 private:
-  GlobalLogger() = default;
+  GlobalLogger();
   ~GlobalLogger() = default;
   GlobalLogger(const GlobalLogger&) = delete;
   GlobalLogger& operator=(const GlobalLogger&) = delete;
 
   std::unique_ptr<LoggerAgent> agent_;
+  std::atomic<bool> hasAgent_;
   std::mutex mutex_;
 };
 
@@ -0,0 +1,170 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace Common
+{
+
+/**
+ * @brief Lets consumer sleep until some condition (e.g. non-empty queue)
+ *  becomes true, without locking on the producers' (notifying) side,
+ *  unless consumer really sleeps.
+ *
+ * Producer changes state, then calls notify().
+ * Consumer calls wait() with predicate checking this state.
+ */
+class EventCount
+{
+public:
+  EventCount()
+    : waiters_(0)
+  {}
+
+  void notify()
+  {
+    // pairs with increment of waiters_ in wait() - either producer sees
+    //  the waiter, or the waiter sees changed state (in predicate)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    condVar_.notify_all();
+  }
+
+  template <class Predicate>
+  void wait(Predicate ready)
+  {
+    if (ready()) // fast path - no locking at all
+      return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1,std::memory_order_seq_cst);
+    condVar_.wait(lock,ready);
+    waiters_.fetch_sub(1,std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<unsigned> waiters_;
+  std::mutex mutex_;
+  std::condition_variable condVar_;
+};
+
+/**
+ * @brief Unbounded, lock-free multi-producer single-consumer queue
+ *  (intrusive linked list by Dmitry Vyukov).
+ *
+ * push() may be invoked concurrently from many threads,
+ * tryPop() and pop() only from one (consumer) thread.
+ * Type has to be default constructible (queue keeps one stub element).
+ */
+template <class Type>
+class MPSCQueue
+{
+public:
+  MPSCQueue()
+    : head_(new Node()),
+      tail_(head_.load(std::memory_order_relaxed))
+  {}
+
+  ~MPSCQueue()
+  {
+    Node* node = tail_;
+    while (node)
+    {
+      Node* next = node->next.load(std::memory_order_relaxed);
+      delete node;
+      node = next;
+    }
+  }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  /**
+   * @brief Puts given element as a last in queue
+   *  and wakes consumer waiting in pop(). Never blocks.
+   */
+  void push(const Type& value)
+  {
+    enqueue(value);
+    eventCount_.notify();
+  }
+
+  /**
+   * @brief Puts given element as a last in queue, without waking consumer.
+   *  For owners, whose consumer waits on their own EventCount
+   *  (they notify it after enqueue), instead of in pop(). Never blocks.
+   */
+  void enqueue(const Type& value)
+  {
+    Node* node = new Node(value);
+    Node* previous = head_.exchange(node,std::memory_order_acq_rel);
+    // between exchange and this store, consumer sees queue as shorter
+    previous->next.store(node,std::memory_order_release);
+  }
+
+  /**
+   * @brief Retrieves first element from queue, if there is any.
+   *  Only for consumer thread.
+   * @return false if queue was empty (result is untouched then)
+   */
+  bool tryPop(Type& result)
+  {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+
+    result = std::move(next->value);
+    next->value = Type(); // next becomes stub, don't keep value alive
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+  /**
+   * @brief Retrieves first element from queue, or waits for it.
+   *  Only for consumer thread.
+   */
+  void pop(Type& result)
+  {
+    eventCount_.wait([this,&result]{ return tryPop(result); });
+  }
+
+  /**
+   * @brief Checks whether there is any element to pop.
+   *  Only for consumer thread.
+   */
+  bool empty() const
+  {
+    return tail_->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+private:
+  struct Node
+  {
+    Node()
+      : next(nullptr)
+    {}
+
+    explicit Node(const Type& value)
+      : value(value),
+        next(nullptr)
+    {}
+
+    Type value;
+    std::atomic<Node*> next;
+  };
+
+  std::atomic<Node*> head_; // producers' side (the newest element)
+  Node* tail_; // consumer's side (stub - the last popped node)
+  EventCount eventCount_;
+};
+
+} // namespace Common
+
+#endif // MPSCQUEUE_HPP
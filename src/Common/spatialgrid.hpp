@@ -0,0 +1,149 @@
+#ifndef SPATIALGRID_HPP
+#define SPATIALGRID_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Common
+{
+
+/**
+ * @brief Uniform grid over 2D plane, used as a simple spatial index.
+ *  Only non-empty cells are stored (hashed by cell coordinates),
+ *  so there is no need to know extents of indexed area in advance.
+ *
+ *  Items can be inserted as points (into one cell)
+ *  or as bounding boxes (into every cell box overlaps),
+ *  in the latter case, queries can visit the same item more than once.
+ */
+template <class Type>
+class SpatialGrid
+{
+public:
+  typedef std::vector<Type> items_t;
+
+  /**
+   * @param size of (square) cell, in the same units as coordinates
+   */
+  explicit SpatialGrid(double cellSize)
+    : cellSize_(cellSize)
+  {}
+
+  double getCellSize() const
+  {
+    return cellSize_;
+  }
+
+  void insert(double x, double y, const Type& item)
+  {
+    cells_[key(cellIndex(x),cellIndex(y))].push_back(item);
+  }
+
+  void insert(double minX, double minY, double maxX, double maxY,
+              const Type& item)
+  {
+    const long maxCX = cellIndex(maxX);
+    const long maxCY = cellIndex(maxY);
+    for (long cx = cellIndex(minX); cx <= maxCX; ++cx)
+      for (long cy = cellIndex(minY); cy <= maxCY; ++cy)
+        cells_[key(cx,cy)].push_back(item);
+  }
+
+  void clear()
+  {
+    cells_.clear();
+  }
+
+  bool empty() const
+  {
+    return cells_.empty();
+  }
+
+  /**
+   * @brief Visits every non-empty cell which overlaps given box.
+   * @param visitor - callable as
+   *  visitor(double cellMinX, double cellMinY, const items_t& items)
+   */
+  template <class CellVisitor>
+  void forEachCell(double minX, double minY, double maxX, double maxY,
+                   CellVisitor visitor) const
+  {
+    const long minCX = cellIndex(minX);
+    const long minCY = cellIndex(minY);
+    const long maxCX = cellIndex(maxX);
+    const long maxCY = cellIndex(maxY);
+
+    const double rangeSize = double(maxCX-minCX+1) * double(maxCY-minCY+1);
+    if (rangeSize > cells_.size())
+    { // box covers more cells than there are stored - scan stored ones
+      for (const typename cells_t::value_type& cell : cells_)
+      {
+        long cx = cellX(cell.first);
+        long cy = cellY(cell.first);
+        if (cx >= minCX && cx <= maxCX && cy >= minCY && cy <= maxCY)
+          visitor(cx*cellSize_,cy*cellSize_,cell.second);
+      }
+      return;
+    }
+
+    for (long cx = minCX; cx <= maxCX; ++cx)
+    {
+      for (long cy = minCY; cy <= maxCY; ++cy)
+      {
+        typename cells_t::const_iterator iter = cells_.find(key(cx,cy));
+        if (iter != cells_.end())
+          visitor(cx*cellSize_,cy*cellSize_,iter->second);
+      }
+    }
+  }
+
+  /**
+   * @brief Visits every item from cells overlapping given box.
+   *  Items are not filtered by their exact position - only by cells.
+   * @param visitor - callable as visitor(const Type& item)
+   */
+  template <class ItemVisitor>
+  void query(double minX, double minY, double maxX, double maxY,
+             ItemVisitor visitor) const
+  {
+    forEachCell(minX,minY,maxX,maxY,
+                [&visitor](double, double, const items_t& items)
+                {
+                  for (const Type& item : items)
+                    visitor(item);
+                });
+  }
+
+private:
+  typedef std::unordered_map<std::int64_t,items_t> cells_t;
+
+  long cellIndex(double coordinate) const
+  {
+    return static_cast<long>(std::floor(coordinate/cellSize_));
+  }
+
+  static std::int64_t key(long cx, long cy)
+  {
+    return (static_cast<std::int64_t>(cx) << 32)
+        | (static_cast<std::int64_t>(cy) & 0xffffffffLL);
+  }
+
+  static long cellX(std::int64_t key)
+  {
+    return static_cast<long>(key >> 32);
+  }
+
+  static long cellY(std::int64_t key)
+  {
+    return static_cast<long>(static_cast<std::int32_t>(key & 0xffffffffLL));
+  }
+
+  const double cellSize_;
+  cells_t cells_;
+};
+
+} // namespace Common
+
+#endif // SPATIALGRID_HPP
@@ -0,0 +1,384 @@
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <pthread.h>
+
+namespace Common
+{
+
+namespace
+{
+  // idle worker looks for tasks so many times, before it sleeps
+  const unsigned spinsBeforeSleep = 64;
+
+  // worker running current thread (of any scheduler)
+  thread_local void* currentThreadWorker = nullptr;
+
+  void splitRange(TaskGroup& group,
+                  std::size_t begin, std::size_t end, std::size_t grain,
+                  const std::function<void(std::size_t,std::size_t)>& body)
+  {
+    while (end - begin > grain)
+    { // the second half goes to deque - thieves take the biggest parts
+      const std::size_t middle = begin + (end - begin)/2;
+      group.run([&group,middle,end,grain,&body]
+      {
+        splitRange(group,middle,end,grain,body);
+      });
+      end = middle;
+    }
+    body(begin,end);
+  }
+} // anonymous namespace
+
+/******************************************************************************/
+
+TaskDeque::Buffer::Buffer(std::size_t capacity)
+  : mask(capacity - 1),
+    tasks(new std::atomic<Task*>[capacity])
+{
+  for (std::size_t i = 0; i < capacity; ++i)
+    tasks[i].store(nullptr,std::memory_order_relaxed);
+}
+
+TaskDeque::TaskDeque(std::size_t capacity)
+  : top_(0),
+    bottom_(0)
+{
+  std::size_t size = 1;
+  while (size < capacity)
+    size *= 2;
+  buffers_.push_back(std::unique_ptr<Buffer>(new Buffer(size)));
+  buffer_.store(buffers_.back().get(),std::memory_order_relaxed);
+}
+
+TaskDeque::~TaskDeque()
+{}
+
+void TaskDeque::push(Task* task)
+{
+  const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const std::int64_t top = top_.load(std::memory_order_acquire);
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (bottom - top > buffer->mask)
+    buffer = grow(buffer,bottom,top);
+
+  buffer->put(bottom,task);
+  // publishes task (and what it points to) to thieves
+  bottom_.store(bottom + 1,std::memory_order_release);
+}
+
+Task* TaskDeque::pop()
+{
+  const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(bottom,std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom)
+  { // empty
+    bottom_.store(bottom + 1,std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Task* task = buffer->get(bottom);
+  if (top == bottom)
+  { // the last task - race with thieves
+    if (!top_.compare_exchange_strong(top,top + 1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      task = nullptr; // stolen
+    bottom_.store(bottom + 1,std::memory_order_relaxed);
+  }
+
+  return task;
+}
+
+Task* TaskDeque::steal()
+{
+  std::int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr; // empty
+
+  Buffer* buffer = buffer_.load(std::memory_order_acquire);
+  Task* task = buffer->get(top);
+  if (!top_.compare_exchange_strong(top,top + 1,
+                                    std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return nullptr; // taken by owner or other thief
+
+  return task;
+}
+
+bool TaskDeque::empty() const
+{
+  return bottom_.load(std::memory_order_relaxed)
+         <= top_.load(std::memory_order_relaxed);
+}
+
+TaskDeque::Buffer* TaskDeque::grow(Buffer* buffer,
+                                   std::int64_t bottom, std::int64_t top)
+{
+  std::unique_ptr<Buffer> bigger(new Buffer(2*(buffer->mask + 1)));
+  for (std::int64_t i = top; i < bottom; ++i)
+    bigger->put(i,buffer->get(i));
+
+  buffers_.push_back(std::move(bigger));
+  Buffer* result = buffers_.back().get();
+  buffer_.store(result,std::memory_order_release);
+  return result;
+}
+
+/******************************************************************************/
+
+struct TaskScheduler::Worker
+{
+  Worker(TaskScheduler* scheduler, unsigned index)
+    : scheduler(scheduler),
+      index(index),
+      random(index + 1)
+  {}
+
+  TaskScheduler* const scheduler;
+  const unsigned index;
+  unsigned random; // xorshift state - victims of stealing
+  TaskDeque deque;
+  std::thread thread;
+};
+
+TaskScheduler::TaskScheduler(unsigned threads, bool pinThreads)
+  : stopping_(false)
+{
+  const unsigned cpus = std::max(std::thread::hardware_concurrency(),1u);
+  if (threads == 0)
+    threads = cpus;
+
+  // all deques exist, before any worker starts stealing
+  for (unsigned i = 0; i < threads; ++i)
+  {
+    workers_.push_back(std::unique_ptr<Worker>(new Worker(this,i)));
+  }
+
+  for (const std::unique_ptr<Worker>& worker : workers_)
+  {
+    worker->thread = std::thread(&TaskScheduler::work,this,worker.get());
+    if (pinThreads)
+    { // pinning is only a hint - scheduler works correctly without it
+      cpu_set_t cpu;
+      CPU_ZERO(&cpu);
+      CPU_SET(worker->index % cpus,&cpu);
+      pthread_setaffinity_np(worker->thread.native_handle(),
+                             sizeof(cpu),&cpu);
+    }
+  }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stopping_.store(true);
+  eventCount_.notify();
+  for (const std::unique_ptr<Worker>& worker : workers_)
+  {
+    worker->thread.join();
+  }
+
+  assert(shared_.empty() && "TaskGroup not finished before scheduler!");
+}
+
+unsigned TaskScheduler::getThreadsCount() const
+{
+  return workers_.size();
+}
+
+void TaskScheduler::parallelFor(
+    std::size_t begin, std::size_t end, std::size_t grain,
+    const std::function<void(std::size_t,std::size_t)>& body)
+{
+  if (begin >= end)
+    return;
+
+  grain = std::max<std::size_t>(grain,1);
+  TaskGroup group(*this);
+  group.run([&group,begin,end,grain,&body]
+  {
+    splitRange(group,begin,end,grain,body);
+  });
+  group.wait();
+}
+
+void TaskScheduler::submit(Task* task)
+{
+  Worker* worker = currentWorker();
+  if (worker)
+    worker->deque.push(task);
+  else
+  {
+    std::lock_guard<std::mutex> lock(sharedMutex_);
+    shared_.push_back(task);
+  }
+  eventCount_.notify();
+}
+
+void TaskScheduler::execute(Task* task)
+{
+  TaskGroup* group = task->group;
+  try
+  {
+    task->function();
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(group->errorMutex_);
+    if (!group->error_)
+      group->error_ = std::current_exception();
+  }
+  delete task;
+
+  // group may be destroyed by waiting thread at once after decrement
+  if (group->pending_.fetch_sub(1,std::memory_order_acq_rel) == 1)
+    eventCount_.notify();
+}
+
+Task* TaskScheduler::findTask(Worker* worker)
+{
+  if (worker)
+  {
+    Task* task = worker->deque.pop();
+    if (task)
+      return task;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sharedMutex_);
+    if (!shared_.empty())
+    {
+      Task* task = shared_.front();
+      shared_.pop_front();
+      return task;
+    }
+  }
+
+  // steal from workers, starting from random one
+  unsigned first = 0;
+  if (worker)
+  {
+    worker->random ^= worker->random << 13;
+    worker->random ^= worker->random >> 17;
+    worker->random ^= worker->random << 5;
+    first = worker->random;
+  }
+  for (std::size_t i = 0; i < workers_.size(); ++i)
+  {
+    Worker* victim = workers_[(first + i) % workers_.size()].get();
+    if (victim == worker)
+      continue;
+
+    Task* task = victim->deque.steal();
+    if (task)
+      return task;
+  }
+
+  return nullptr;
+}
+
+bool TaskScheduler::hasTasks()
+{
+  for (const std::unique_ptr<Worker>& worker : workers_)
+  {
+    if (!worker->deque.empty())
+      return true;
+  }
+
+  std::lock_guard<std::mutex> lock(sharedMutex_);
+  return !shared_.empty();
+}
+
+TaskScheduler::Worker* TaskScheduler::currentWorker() const
+{
+  Worker* worker = static_cast<Worker*>(currentThreadWorker);
+  return (worker && worker->scheduler == this ? worker : nullptr);
+}
+
+void TaskScheduler::work(Worker* worker)
+{
+  currentThreadWorker = worker;
+  while (true)
+  {
+    Task* task = nullptr;
+    for (unsigned i = 0; i < spinsBeforeSleep && !task; ++i)
+    {
+      task = findTask(worker);
+      if (!task)
+        std::this_thread::yield();
+    }
+
+    if (task)
+    {
+      execute(task);
+      continue;
+    }
+
+    if (stopping_.load())
+      return;
+    eventCount_.wait([this]{ return stopping_.load() || hasTasks(); });
+  }
+}
+
+/******************************************************************************/
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler)
+  : scheduler_(scheduler),
+    pending_(0)
+{}
+
+TaskGroup::~TaskGroup()
+{
+  waitForTasks();
+}
+
+void TaskGroup::run(std::function<void()> function)
+{
+  pending_.fetch_add(1,std::memory_order_relaxed);
+  scheduler_.submit(new Task{ std::move(function),this });
+}
+
+void TaskGroup::wait()
+{
+  waitForTasks();
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    std::swap(error,error_);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void TaskGroup::waitForTasks()
+{
+  TaskScheduler::Worker* worker = scheduler_.currentWorker();
+  while (pending_.load(std::memory_order_acquire) != 0)
+  {
+    Task* task = scheduler_.findTask(worker);
+    if (task)
+    {
+      scheduler_.execute(task);
+      continue;
+    }
+
+    // the rest of tasks is run by other threads
+    scheduler_.eventCount_.wait([this]
+    {
+      return pending_.load(std::memory_order_acquire) == 0
+             || scheduler_.hasTasks();
+    });
+  }
+}
+
+} // namespace Common
@@ -0,0 +1,226 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mpscqueue.hpp" // EventCount
+
+namespace Common
+{
+
+class TaskGroup;
+
+/**
+ * @brief Function run by TaskScheduler, as a part of TaskGroup.
+ */
+struct Task
+{
+  std::function<void()> function;
+  TaskGroup* group;
+};
+
+/**
+ * @brief Lock-free work-stealing deque of tasks (Chase-Lev,
+ *  with memory orders of Le, Pop, Cohen, Zappa Nardelli).
+ *
+ * Owner thread pushes and pops tasks at the bottom (LIFO - the latest,
+ * still hot in cache, task first), other threads steal from the top
+ * (FIFO - the oldest, usually the biggest, task). Buffer grows when full.
+ * Buffers are freed only with deque, because thieves may still read them.
+ */
+class TaskDeque
+{
+public:
+  /**
+   * @param capacity - initial, rounded up to power of 2
+   */
+  explicit TaskDeque(std::size_t capacity = 256);
+  ~TaskDeque();
+
+  TaskDeque(const TaskDeque&) = delete;
+  TaskDeque& operator=(const TaskDeque&) = delete;
+
+  /**
+   * @brief Puts task at the bottom. Only for owner thread. Never blocks.
+   */
+  void push(Task* task);
+
+  /**
+   * @brief Takes task from the bottom. Only for owner thread.
+   * @return nullptr when deque is empty
+   */
+  Task* pop();
+
+  /**
+   * @brief Takes task from the top. For any thread.
+   * @return nullptr when deque is empty, or other thread took the task
+   */
+  Task* steal();
+
+  /**
+   * @return true, if deque seems to be empty (it may change at once)
+   */
+  bool empty() const;
+
+private:
+  struct Buffer
+  {
+    explicit Buffer(std::size_t capacity);
+
+    Task* get(std::int64_t i) const
+    {
+      return tasks[i & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(std::int64_t i, Task* task)
+    {
+      tasks[i & mask].store(task,std::memory_order_relaxed);
+    }
+
+    const std::int64_t mask; // capacity - 1
+    std::unique_ptr<std::atomic<Task*>[]> tasks;
+  };
+
+  Buffer* grow(Buffer* buffer, std::int64_t bottom, std::int64_t top);
+
+  // top and bottom are in separate cache lines - thieves touch only top;
+  //  padded, not alignas(64): deques live in heap allocated workers
+  //  and plain new does not honour over-alignment before C++17
+  static const std::size_t cacheLine = 64;
+  char padTop_[cacheLine];
+  std::atomic<std::int64_t> top_;
+  char padBottom_[cacheLine - sizeof(std::atomic<std::int64_t>)];
+  std::atomic<std::int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer> > buffers_; // current and old ones
+};
+
+/**
+ * @brief Pool of worker threads, running tasks of TaskGroups.
+ *
+ * Each worker has it's own TaskDeque - tasks created by worker are pushed
+ * there, tasks created by other threads are put into shared queue.
+ * Idle worker takes task from it's deque, then from shared queue, then
+ * steals from other workers. Thread waiting for TaskGroup runs tasks too,
+ * so tasks may create and wait for their own groups (nested parallelism).
+ *
+ * All TaskGroups have to be finished before scheduler is destroyed.
+ */
+class TaskScheduler
+{
+public:
+  /**
+   * @param threads - workers (0 - one per core)
+   * @param pinThreads - pins workers to cores (one worker per core)
+   */
+  explicit TaskScheduler(unsigned threads = 0, bool pinThreads = false);
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  unsigned getThreadsCount() const;
+
+  /**
+   * @brief Runs body over [begin,end) in parallel and waits for it.
+   *  Range is split in halves, until parts are not bigger than grain,
+   *  so idle workers steal big parts and split them further.
+   * @param body - invoked with [begin,end) of each part
+   *  (concurrently for different parts)
+   * @throw the first exception thrown by body (all parts are run anyway)
+   */
+  void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                   const std::function<void(std::size_t,std::size_t)>& body);
+
+private:
+  friend class TaskGroup;
+
+  struct Worker;
+
+  void submit(Task* task);
+  void execute(Task* task);
+
+  /**
+   * @brief Finds task for given worker (nullptr - for not worker thread).
+   */
+  Task* findTask(Worker* worker);
+
+  /**
+   * @return true, if any task seems to be waiting
+   */
+  bool hasTasks();
+
+  /**
+   * @return worker of this scheduler running current thread, or nullptr
+   */
+  Worker* currentWorker() const;
+
+  void work(Worker* worker);
+
+  std::vector<std::unique_ptr<Worker> > workers_;
+
+  std::mutex sharedMutex_;
+  std::deque<Task*> shared_; // tasks created by not worker threads
+
+  EventCount eventCount_; // new task, finished group or stopping
+  std::atomic<bool> stopping_;
+};
+
+/**
+ * @brief Set of tasks, which can be waited for together.
+ *
+ * Usage:
+ *  TaskGroup group(scheduler);
+ *  group.run(task1);
+ *  group.run(task2);
+ *  group.wait(); // runs tasks too, rethrows exception of any task
+ */
+class TaskGroup
+{
+public:
+  explicit TaskGroup(TaskScheduler& scheduler);
+
+  /**
+   * @brief Waits for tasks, which are still running (without rethrowing).
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /**
+   * @brief Schedules function to be run by any thread of scheduler.
+   *  May be called from tasks of this group too.
+   */
+  void run(std::function<void()> function);
+
+  /**
+   * @brief Runs tasks (of any group), until all tasks of this group finish.
+   * @throw the first exception thrown by task of this group
+   */
+  void wait();
+
+private:
+  friend class TaskScheduler;
+
+  void waitForTasks();
+
+  TaskScheduler& scheduler_;
+  std::atomic<std::size_t> pending_; // scheduled, but not finished tasks
+
+  std::mutex errorMutex_;
+  std::exception_ptr error_; // the first one
+};
+
+} // namespace Common
+
+#endif // TASKSCHEDULER_H
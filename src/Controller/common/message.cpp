@@ -8,6 +8,11 @@ namespace Controller
 Message::~Message()
 {}
 
+Message::DeliveryPolicy Message::getDeliveryPolicy() const
+{
+  return Normal;
+}
+
 /******************************************************************************/
 
 WorkingModeChangeMessage::WorkingModeChangeMessage(WorkingMode workingMode)
@@ -31,6 +36,11 @@ void QuitRequestedMessage::accept(MessageDispatcher& md)
   md.visit(*this);
 }
 
+Message::DeliveryPolicy QuitRequestedMessage::getDeliveryPolicy() const
+{
+  return Urgent;
+}
+
 /******************************************************************************/
 
 void MapSnapshotRequestedMessage::accept(MessageDispatcher& md)
@@ -49,4 +59,9 @@ void TimerTickMessage::accept(MessageDispatcher& md)
   md.visit(*this);
 }
 
+Message::DeliveryPolicy TimerTickMessage::getDeliveryPolicy() const
+{
+  return Coalesced; // there is no point in computing the same state twice
+}
+
 } // namespace Controller
@@ -15,7 +15,16 @@ typedef std::shared_ptr<Message> MessagePtr;
 class Message
 {
 public:
+  // how MessageQueue delivers message
+  enum DeliveryPolicy
+  {
+    Normal, // in order of pushing
+    Urgent, // before normal messages
+    Coalesced // at most one pending at once, next ones are dropped
+  };
+
   virtual void accept(MessageDispatcher&) = 0;
+  virtual DeliveryPolicy getDeliveryPolicy() const;
 
 protected:
   Message() = default;
@@ -39,6 +48,7 @@ class QuitRequestedMessage : public Message
 {
 public:
   virtual void accept(MessageDispatcher&);
+  virtual DeliveryPolicy getDeliveryPolicy() const;
 };
 
 class MapSnapshotRequestedMessage : public Message
@@ -52,6 +62,7 @@ class TimerTickMessage : public Message
 public:
   TimerTickMessage(time_types::duration_t timeDuration);
   virtual void accept(MessageDispatcher&);
+  virtual DeliveryPolicy getDeliveryPolicy() const;
 
 private:
   time_types::duration_t timeDuration_;
@@ -1,9 +1,5 @@
 #include "messagedispatcher.h"
 
-#include <cassert>
-
-#include <Common/configurationmanager.h>
-
 #include <Model/model.h>
 #include <Model/modelsnapshot.h>
 
@@ -24,10 +20,12 @@ MessageDispatcher::MessageDispatcher(Model::Model& model,
     view_(view)
 {}
 
-void MessageDispatcher::visit(WorkingModeChangeMessage& /*m*/)
+void MessageDispatcher::visit(WorkingModeChangeMessage& m)
 {
-  // FIXME implement this
-  // perform an action appropriate for WorkingModeChange message
+  if (m.getMode() == WorkingModeChangeMessage::BATCH)
+    controller_.setWorkMode(Batch);
+  else
+    controller_.setWorkMode(Online);
 }
 
 void MessageDispatcher::visit(QuitRequestedMessage& /*m*/)
@@ -45,20 +43,11 @@ void MessageDispatcher::visit(MapSnapshotRequestedMessage& /*m*/)
 
 void MessageDispatcher::visit(TimerTickMessage& /*m*/)
 {
-  Model::Snapshot state;
-
-  Common::Configuration::ConfigurationManager& confMan
-      = Common::Configuration::ConfigurationManager::getInstance();
-
-  const std::string workMode = confMan["Controller"]["WorkMode"];
-
-  if (workMode == "online")
-    state = model_.computeState(time_types::clock_t::now());
-  else if (workMode == "batch")
-    state = model_.computeState();
-  else
-    assert(false && "Not implemented WorkMode!");
+  // in Batch mode Model is driven by Controller's main loop, not by timer
+  if (controller_.getWorkMode() != Online)
+    return;
 
+  Model::Snapshot state = model_.computeState(time_types::clock_t::now());
   view_.showState(state); // put snapshot to View
 }
 
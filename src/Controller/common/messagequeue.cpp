@@ -0,0 +1,84 @@
+#include "messagequeue.h"
+
+namespace Controller
+{
+
+MessageQueue::MessageQueue()
+{
+  for (CoalescedSlot& slot : coalesced_)
+  {
+    slot.type.store(nullptr,std::memory_order_relaxed);
+    slot.pending.store(false,std::memory_order_relaxed);
+  }
+}
+
+void MessageQueue::push(const MessagePtr& message)
+{
+  switch (message->getDeliveryPolicy())
+  {
+  case Message::Urgent:
+    urgent_.enqueue(message);
+    break;
+  case Message::Coalesced:
+  {
+    std::atomic_bool* pending = coalescedPending(*message);
+    // too many types of Coalesced messages - delivered as Normal ones
+    if (pending && pending->exchange(true))
+      return; // the same message is still waiting for consumer
+    normal_.enqueue(message);
+    break;
+  }
+  case Message::Normal:
+    normal_.enqueue(message);
+    break;
+  }
+  eventCount_.notify(); // consumer waits here, not in lanes
+}
+
+std::size_t MessageQueue::popAll(std::vector<MessagePtr>& result)
+{
+  eventCount_.wait([this]{ return !urgent_.empty() || !normal_.empty(); });
+  return tryPopAll(result);
+}
+
+std::size_t MessageQueue::tryPopAll(std::vector<MessagePtr>& result)
+{
+  const std::size_t sizeBefore = result.size();
+
+  MessagePtr message;
+  while (urgent_.tryPop(message))
+  {
+    result.push_back(message);
+  }
+  while (normal_.tryPop(message))
+  {
+    if (message->getDeliveryPolicy() == Message::Coalesced)
+    {
+      std::atomic_bool* pending = coalescedPending(*message);
+      if (pending)
+        *pending = false; // next one can be queued (while processing)
+    }
+    result.push_back(message);
+  }
+
+  return result.size() - sizeBefore;
+}
+
+std::atomic_bool* MessageQueue::coalescedPending(const Message& message)
+{
+  const std::type_info& type = typeid(message);
+  for (CoalescedSlot& slot : coalesced_)
+  {
+    const std::type_info* slotType = slot.type.load(std::memory_order_acquire);
+    // free slot is taken by the first type reaching it
+    if (!slotType && slot.type.compare_exchange_strong(slotType,&type))
+      return &slot.pending;
+    // slotType is set here (by compare_exchange, if other type took slot)
+    if (*slotType == type)
+      return &slot.pending;
+  }
+
+  return nullptr;
+}
+
+} // namespace Controller
@@ -0,0 +1,75 @@
+#ifndef CONTROLLER_MESSAGEQUEUE_H
+#define CONTROLLER_MESSAGEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+
+#include <Common/mpscqueue.hpp>
+
+#include <Controller/common/message.h>
+
+namespace Controller
+{
+
+/**
+ * @brief Queue of messages for Controller (single consumer),
+ *  filled by many producers (View, timers).
+ *
+ * Messages are delivered according to their Message::DeliveryPolicy:
+ *  Urgent - before all normal messages (e.g. quit request),
+ *  Coalesced - at most one pending at once (of each type of message),
+ *   next ones are dropped, until pending one is popped (e.g. timer ticks,
+ *   when computation is slower than timer),
+ *  Normal - in order of pushing.
+ */
+class MessageQueue
+{
+public:
+  MessageQueue();
+
+  /**
+   * @brief Puts message into queue. Never blocks, is lock-free.
+   */
+  void push(const MessagePtr& message);
+
+  /**
+   * @brief Retrieves all pending messages (urgent first), or waits until
+   *  there is at least one.
+   * @param collection where messages are appended
+   * @return number of retrieved messages
+   */
+  std::size_t popAll(std::vector<MessagePtr>& result);
+
+  /**
+   * @brief Retrieves all pending messages (urgent first), never waits.
+   * @param collection where messages are appended
+   * @return number of retrieved messages (can be 0)
+   */
+  std::size_t tryPopAll(std::vector<MessagePtr>& result);
+
+private:
+  // pending flag of one type of Coalesced messages
+  struct CoalescedSlot
+  {
+    std::atomic<const std::type_info*> type; // nullptr - free slot
+    std::atomic_bool pending;
+  };
+
+  /**
+   * @brief Finds (or takes free) slot for type of given message. Lock-free.
+   * @return pending flag of type, or nullptr when all slots are taken
+   */
+  std::atomic_bool* coalescedPending(const Message& message);
+
+  Common::MPSCQueue<MessagePtr> urgent_;
+  Common::MPSCQueue<MessagePtr> normal_;
+  Common::EventCount eventCount_; // signals both lanes
+  static const std::size_t coalescedTypesCount = 8;
+  CoalescedSlot coalesced_[coalescedTypesCount];
+};
+
+} // namespace Controller
+
+#endif // CONTROLLER_MESSAGEQUEUE_H
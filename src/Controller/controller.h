@@ -23,6 +23,13 @@ public:
    * @brief Quits whole application.
    */
   virtual void quit() = 0;
+
+  /**
+   * @brief Switches between computing in real time (Online)
+   *  and replaying data as fast as possible (Batch).
+   */
+  virtual void setWorkMode(WorkMode) = 0;
+  virtual WorkMode getWorkMode() const = 0;
 };
 
 } // namespace Controller
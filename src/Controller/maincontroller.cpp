@@ -1,25 +1,39 @@
 #include "maincontroller.h"
 
+#include <sstream> // used for logging purpose
+
+#include <Common/configurationmanager.h>
 #include <Common/logger.h>
 
 namespace Controller
 {
 
 MainController
-::MainController(std::shared_ptr<Common::BlockingQueue<MessagePtr> > bq,
+::MainController(std::shared_ptr<MessageQueue> mq,
                  std::unique_ptr<Model::Model> model,
                  std::unique_ptr<View::View> view)
-  : blockingQueue_(bq),
+  : messageQueue_(mq),
     model_(std::move(model)),
     view_(std::move(view)),
+    workMode_(Online),
     messageDispatcher_(new MessageDispatcher(*model_,
                                              *this,
                                              *view_)),
     timersManager_(new Common::TimersManager()),
     working_(true)
 {
+  const std::string workMode
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Controller","WorkMode","batch");
+  if (workMode == "batch")
+    workMode_ = Batch;
+
+  batchSnapshotInterval_ = time_types::duration_t(
+        Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Controller","BatchSnapshotInterval",1));
+
   std::shared_ptr<Common::Callable> callable(
-          new RefreshEventProducer(blockingQueue_)
+          new RefreshEventProducer(messageQueue_)
         );
   timersManager_->startTimer(1000,callable);
 }
@@ -31,13 +45,28 @@ void MainController::operator()()
 {
   Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
   logger.log("MainController","Entering main loop.");
+  std::vector<MessagePtr> messages;
+  bool dataAvailable = true;
   while (working_) // main loop
   {
-    MessagePtr msg;
-    blockingQueue_->pop(msg); // get message from queue or hang on,
-                              // when no messages available
-    // perform action appropriate for received msg
-    msg->accept(*messageDispatcher_);
+    messages.clear();
+    if (workMode_ == Batch && dataAvailable)
+      messageQueue_->tryPopAll(messages); // don't wait - replay goes on
+    else
+      messageQueue_->popAll(messages); // get all messages from queue
+                                       // or hang on, when none available
+    for (const MessagePtr& msg : messages)
+    {
+      if (!working_) // quit request is delivered first, skip the rest
+        break;
+      // perform action appropriate for received msg
+      msg->accept(*messageDispatcher_);
+    }
+
+    if (working_ && workMode_ == Batch)
+      // when there is no more data, wait for next message (e.g. timer tick)
+      //  and check again - DB is polled at timer's rate
+      dataAvailable = replayStep();
   }
   logger.log("MainController","Left main loop.");
   view_->quit(); // before stopping work, close View
@@ -48,23 +77,57 @@ void MainController::quit()
   working_ = false;
 }
 
+void MainController::setWorkMode(WorkMode workMode)
+{
+  if (workMode == workMode_)
+    return;
+
+  {
+    std::stringstream msg;
+    msg << "Switching to " << (workMode == Batch ? "batch" : "online")
+        << " mode.";
+    Common::GlobalLogger::getInstance().log("MainController",msg.str());
+  }
+  workMode_ = workMode;
+  nextSnapshotTime_ = time_types::ptime_t(); // snapshot at first replay step
+}
+
+WorkMode MainController::getWorkMode() const
+{
+  return workMode_;
+}
+
+bool MainController::replayStep()
+{
+  if (!model_->processNextPacket())
+    return false;
+
+  const time_types::ptime_t modelTime = model_->getModelTime();
+  if (modelTime >= nextSnapshotTime_)
+  {
+    view_->showState(model_->takeSnapshot(modelTime));
+    nextSnapshotTime_ = modelTime
+        + boost::chrono::duration_cast<time_types::clock_t::duration>(
+            batchSnapshotInterval_);
+  }
+  return true;
+}
+
 bool MainController::isWorking() const
 {
   return working_;
 }
 
-RefreshEventProducer::RefreshEventProducer(std::shared_ptr<
-                                            Common::BlockingQueue<
-                                              MessagePtr>
-                                           > blockingQueue)
-  : blockingQueue_(blockingQueue)
+RefreshEventProducer::RefreshEventProducer(
+    std::shared_ptr<MessageQueue> messageQueue)
+  : messageQueue_(messageQueue)
 {}
 
 void RefreshEventProducer::operator()(Common::EventTimer* /*timer*/)
 {
   MessagePtr msg(new TimerTickMessage(time_types::duration_t(1))); // 1 interval
 
-  blockingQueue_->push(msg);
+  messageQueue_->push(msg); // dropped, if previous tick is still pending
 }
 
 } // namespace Controller
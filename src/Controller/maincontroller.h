@@ -4,12 +4,12 @@
 #include <atomic>
 #include <memory>
 
-#include <Common/blockingqueue.hpp>
 #include <Common/eventtimer.h>
 #include <Common/timersmanager.h>
 
 #include <Controller/controller.h>
 #include <Controller/common/message.h>
+#include <Controller/common/messagequeue.h>
 #include <Controller/common/messagedispatcher.h>
 
 #include <Model/datamanager.h>
@@ -22,20 +22,31 @@ namespace Controller
 class MainController : public Controller
 {
 public:
-  MainController(std::shared_ptr<Common::BlockingQueue<MessagePtr> >,
+  MainController(std::shared_ptr<MessageQueue>,
                  std::unique_ptr<Model::Model>,
                  std::unique_ptr<View::View>);
   virtual ~MainController();
 
   virtual void operator()();
   virtual void quit();
+  virtual void setWorkMode(WorkMode);
+  virtual WorkMode getWorkMode() const;
   bool isWorking() const;
 
 private:
-  std::shared_ptr<Common::BlockingQueue<MessagePtr> > blockingQueue_;
+  /**
+   * @brief Processes next packet of data in Batch mode, and shows snapshot
+   *  to View, whenever Model's (sensor) time passes next snapshot time.
+   * @return false, when there was no data to process.
+   */
+  bool replayStep();
+
+  std::shared_ptr<MessageQueue> messageQueue_;
   std::unique_ptr<Model::Model> model_;
   std::unique_ptr<View::View> view_;
   WorkMode workMode_;
+  time_types::duration_t batchSnapshotInterval_; // in Model's time
+  time_types::ptime_t nextSnapshotTime_; // in Batch mode
   const std::unique_ptr<MessageDispatcher> messageDispatcher_;
   const std::unique_ptr<Common::TimersManager> timersManager_;
 
@@ -45,13 +56,11 @@ private:
 class RefreshEventProducer : public Common::Callable
 {
 public:
-  RefreshEventProducer(std::shared_ptr<
-                        Common::BlockingQueue<MessagePtr>
-                       > blockingQueue);
+  RefreshEventProducer(std::shared_ptr<MessageQueue> messageQueue);
   virtual void operator()(Common::EventTimer*);
 
 private:
-  std::shared_ptr<Common::BlockingQueue<MessagePtr> > blockingQueue_;
+  std::shared_ptr<MessageQueue> messageQueue_;
 };
 
 } // namespace Controller
@@ -89,6 +89,37 @@ std::string DynDBDriver::Track_row::uuidToString(const boost::uuids::uuid& uuid)
 
 /******************************************************************************/
 
+DynDBDriver::FeatureDefinition_row::FeatureDefinition_row(
+    int feature_definition_id,
+    const std::string& name,
+    const std::string& type)
+  : feature_definition_id(feature_definition_id),
+    name(name),
+    type(type)
+{}
+
+/******************************************************************************/
+
+DynDBDriver::SensorNoise_row::SensorNoise_row(int sensor_id,
+                                              double position_variance,
+                                              double mos_variance)
+  : sensor_id(sensor_id),
+    position_variance(position_variance),
+    mos_variance(mos_variance)
+{}
+
+/******************************************************************************/
+
+DynDBDriver::FeatureValue_row::FeatureValue_row(int sensor_id, int dr_id,
+                                                int feature_definition_id,
+                                                const std::string& value)
+  : sensor_id(sensor_id),dr_id(dr_id),
+    feature_definition_id(feature_definition_id),
+    value(value)
+{}
+
+/******************************************************************************/
+
 DynDBDriver::DRCursor::DRCursor(DynDBDriver* dbdriver, time_t timestamp,
                                 unsigned packetSize, int beforeFirstDRId)
   : dbdriver_(dbdriver),
@@ -280,13 +311,15 @@ unsigned long DynDBDriver::TracksSnapshot::getSnapshotIdFromSequence()
 /******************************************************************************/
 
 DynDBDriver::DynDBDriver(const std::string& options_path)
+  : featureDefinitionsLoaded_(false)
 {
   loadOptions(options_path);
   db_connection_ = new pqxx::connection(options_->toString());
 }
 
 DynDBDriver::DynDBDriver(const Common::DBDriverOptions* options)
-  : options_(options)
+  : options_(options),
+    featureDefinitionsLoaded_(false)
 {
   db_connection_ = new pqxx::connection(options_->toString());
 }
@@ -379,6 +412,106 @@ std::set<DynDBDriver::Sensor_row*> DynDBDriver::getSensors()
   return resultSet;
 }
 
+std::vector<DynDBDriver::SensorNoise_row> DynDBDriver::getSensorNoises()
+{
+  const std::string sql
+      = "SELECT s.sensorid,"
+               "COALESCE(s.positionvariance,st.positionvariance),"
+               "COALESCE(s.mosvariance,st.mosvariance) "
+        "FROM sensors as s, sensortypes as st "
+        "WHERE s.typeid = st.typeid "
+        "ORDER BY s.sensorid";
+
+  pqxx::work t(*db_connection_,"Sensor noises fetcher");
+  pqxx::result result = t.exec(sql);
+
+  std::vector<SensorNoise_row> noises;
+  noises.reserve(result.size());
+  for (pqxx::result::const_iterator row = result.begin();
+       row != result.end(); ++row)
+  {
+    noises.push_back(SensorNoise_row(row[0].as<int>(),
+                                     row[1].as<double>(),
+                                     row[2].as<double>()));
+  }
+
+  return noises;
+}
+
+const std::map<int,DynDBDriver::FeatureDefinition_row>&
+  DynDBDriver::getFeatureDefinitions()
+{
+  if (featureDefinitionsLoaded_)
+    return featureDefinitions_;
+
+  const std::string sql
+      = "SELECT feature_definition_id,name,type "
+        "FROM feature_definitions";
+
+  pqxx::work t(*db_connection_,"Feature definitions fetcher");
+  pqxx::result result = t.exec(sql);
+
+  featureDefinitions_.clear();
+  for (pqxx::result::const_iterator row = result.begin();
+       row != result.end(); ++row)
+  {
+    const int id = row[0].as<int>();
+    featureDefinitions_.insert(
+          std::make_pair(id,FeatureDefinition_row(id,
+                                                  row[1].as<std::string>(),
+                                                  row[2].as<std::string>())));
+  }
+  featureDefinitionsLoaded_ = true;
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Loaded " << featureDefinitions_.size() << " feature definitions";
+    ::Common::GlobalLogger::getInstance().log("DynDBDriver",msg.str());
+  }
+
+  return featureDefinitions_;
+}
+
+std::vector<DynDBDriver::FeatureValue_row>
+  DynDBDriver::getFeatureValues(const std::vector<std::pair<int,int> >& DRs)
+{
+  std::vector<FeatureValue_row> values;
+  if (DRs.empty())
+    return values;
+
+  // whole packet of DRs is joined at once, with list of their keys
+  //  (only integers are put into query)
+  std::stringstream sql;
+  sql << "SELECT fv.sensor_id,fv.dr_id,fv.feature_definition_id,fv.value "
+         "FROM feature_values AS fv "
+         "JOIN (VALUES ";
+  for (std::size_t i = 0; i < DRs.size(); ++i)
+  {
+    if (i > 0)
+      sql << ",";
+    sql << "(" << DRs[i].first << "," << DRs[i].second << ")";
+  }
+  sql << ") AS dr(sensor_id,dr_id) "
+         "ON fv.sensor_id = dr.sensor_id AND fv.dr_id = dr.dr_id "
+         "ORDER BY fv.sensor_id, fv.dr_id";
+
+  pqxx::work t(*db_connection_,"Feature values fetcher");
+  pqxx::result result = t.exec(sql.str());
+
+  values.reserve(result.size());
+  for (pqxx::result::const_iterator row = result.begin();
+       row != result.end(); ++row)
+  {
+    values.push_back(FeatureValue_row(row[0].as<int>(),
+                                      row[1].as<int>(),
+                                      row[2].as<int>(),
+                                      row[3].as<std::string>(
+                                        std::string()))); // NULL - empty
+  }
+
+  return values;
+}
+
 void DynDBDriver::loadOptions(const std::string& options_path)
 {
   std::unique_ptr<Common::DBDriverOptions> opts
@@ -1,6 +1,7 @@
 #ifndef DYNDBDRIVER_H
 #define DYNDBDRIVER_H
 
+#include <map>
 #include <vector>
 #include <set>
 #include <string>
@@ -105,6 +106,44 @@ public:
     std::string type;
   };
 
+  /**
+   * @brief Measurement noise of sensor - it's own, or (when not set)
+   *  the one of it's type.
+   */
+  struct SensorNoise_row
+  {
+    SensorNoise_row(int sensor_id,
+                    double position_variance,
+                    double mos_variance);
+
+    int sensor_id;
+    double position_variance; // of longitude and latitude
+    double mos_variance; // of meters over sea
+  };
+
+  struct FeatureDefinition_row
+  {
+    FeatureDefinition_row(int feature_definition_id,
+                          const std::string& name,
+                          const std::string& type);
+
+    int feature_definition_id;
+    std::string name;
+    std::string type;
+  };
+
+  struct FeatureValue_row
+  {
+    FeatureValue_row(int sensor_id, int dr_id,
+                     int feature_definition_id,
+                     const std::string& value);
+
+    int sensor_id;
+    int dr_id;
+    int feature_definition_id;
+    std::string value; // feature serialized to string
+  };
+
   class DRCursor
   {
   public:
@@ -216,11 +255,36 @@ public:
 
   std::set<Sensor_row*> getSensors();
 
+  /**
+   * @brief Fetches measurement noises of all sensors in one query.
+   * @return noises, ordered by sensor_id (empty, when there are no sensors)
+   */
+  std::vector<SensorNoise_row> getSensorNoises();
+
+  /**
+   * @brief Returns definitions of features available in system.
+   *  They are fetched from DB only once - on first call, later
+   *  cached ones are returned.
+   * @return definitions indexed by feature_definition_id
+   */
+  const std::map<int,FeatureDefinition_row>& getFeatureDefinitions();
+
+  /**
+   * @brief Fetches values of features of all given DRs in one query.
+   * @param DRs - pairs of (sensor_id, dr_id)
+   * @return values of features, ordered by sensor_id and dr_id
+   */
+  std::vector<FeatureValue_row>
+    getFeatureValues(const std::vector<std::pair<int,int> >& DRs);
+
 private:
   void loadOptions(const std::string& options_path);
 
   const Common::DBDriverOptions* options_;
   pqxx::connection* db_connection_;
+
+  bool featureDefinitionsLoaded_;
+  std::map<int,FeatureDefinition_row> featureDefinitions_;
 };
 
 } // namespace DB
@@ -0,0 +1,372 @@
+#include "protocol.h"
+
+#include <algorithm>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+namespace
+{
+
+const std::uint32_t maximalPayloadSize = 256*1024*1024;
+
+const std::size_t drSize = 2*sizeof(std::int32_t) + 3*sizeof(double)
+                           + 2*sizeof(std::int64_t) + sizeof(std::uint8_t);
+
+const std::size_t trackStateSize = 16 + 12*sizeof(double)
+                                   + 2*sizeof(std::int64_t)
+                                   + 2*sizeof(std::uint32_t);
+
+} // anonymous namespace
+
+ProtocolError::ProtocolError(const std::string& what)
+  : std::runtime_error(what)
+{}
+
+/******************************************************************************/
+
+void Encoder::putString(const std::string& value)
+{
+  put<std::uint32_t>(value.size());
+  buffer_.insert(buffer_.end(),value.begin(),value.end());
+}
+
+void Encoder::putBounds(const Bounds& bounds)
+{
+  put(bounds.minLon);
+  put(bounds.minLat);
+  put(bounds.maxLon);
+  put(bounds.maxLat);
+}
+
+void Encoder::putFeature(const Feature& feature)
+{
+  put<std::uint8_t>(feature.getType());
+  switch (feature.getType())
+  {
+    case Feature::Color:
+    {
+      const ColorFeature& color = static_cast<const ColorFeature&>(feature);
+      put(color.getL());
+      put(color.getA());
+      put(color.getB());
+      put(color.getWeight());
+      break;
+    }
+    case Feature::Plate:
+      putString(static_cast<const PlateFeature&>(feature).getPlate());
+      break;
+    default:
+      throw ProtocolError("Feature cannot be encoded");
+  }
+}
+
+void Encoder::putDR(const DetectionReport& dr)
+{
+  put<std::int32_t>(dr.getSensorId());
+  put<std::int32_t>(dr.getDrId());
+  put(dr.getLongitude());
+  put(dr.getLatitude());
+  put(dr.getMetersOverSea());
+  put<std::int64_t>(dr.getRawUploadTime());
+  put<std::int64_t>(dr.getRawSensorTime());
+
+  const FeatureTable::row_t& features = dr.getFeatures();
+  put<std::uint8_t>(std::count_if(features.begin(),features.end(),
+                                  [](const Feature* f){ return f != nullptr; }));
+  for (const Feature* feature : features)
+  {
+    if (feature)
+      putFeature(*feature);
+  }
+}
+
+void Encoder::putGroup(const std::set<DetectionReport>& group)
+{
+  put<std::uint32_t>(group.size());
+  for (const DetectionReport& dr : group)
+  {
+    putDR(dr);
+  }
+}
+
+void Encoder::putGroups(const std::vector<std::set<DetectionReport> >& groups)
+{
+  put<std::uint32_t>(groups.size());
+  for (const std::set<DetectionReport>& group : groups)
+  {
+    putGroup(group);
+  }
+}
+
+void Encoder::putIndices(const std::vector<std::size_t>& indices)
+{
+  put<std::uint32_t>(indices.size());
+  for (std::size_t index : indices)
+  {
+    put<std::uint32_t>(index);
+  }
+}
+
+void Encoder::putTrackState(const Track::State& state)
+{
+  buffer_.insert(buffer_.end(),state.uuid.begin(),state.uuid.end());
+  put(state.lon);
+  put(state.lat);
+  put(state.mos);
+  put(state.lonVel);
+  put(state.latVel);
+  put(state.mosVel);
+  put(state.predictedLon);
+  put(state.predictedLat);
+  put(state.predictedMos);
+  put(state.lonPredictionVar);
+  put(state.latPredictionVar);
+  put(state.mosPredictionVar);
+  put(state.refreshTime);
+  put(state.measurementTime);
+  put<std::uint32_t>(state.filterState.size());
+  for (double value : state.filterState)
+  {
+    put(value);
+  }
+  put<std::uint32_t>(state.features.size());
+  for (const std::shared_ptr<const Feature>& feature : state.features)
+  {
+    putFeature(*feature);
+  }
+}
+
+void Encoder::putTrackStates(const std::vector<Track::State>& states)
+{
+  put<std::uint32_t>(states.size());
+  for (const Track::State& state : states)
+  {
+    putTrackState(state);
+  }
+}
+
+const std::vector<char>& Encoder::getBuffer() const
+{
+  return buffer_;
+}
+
+/******************************************************************************/
+
+Decoder::Decoder(const std::vector<char>& buffer, FeatureTable* features)
+  : buffer_(buffer),
+    position_(0),
+    features_(features)
+{}
+
+std::string Decoder::getString()
+{
+  const std::uint32_t size = getCount(1);
+  const char* bytes = take(size);
+  return std::string(bytes,bytes+size);
+}
+
+Bounds Decoder::getBounds()
+{
+  Bounds bounds;
+  bounds.minLon = get<double>();
+  bounds.minLat = get<double>();
+  bounds.maxLon = get<double>();
+  bounds.maxLat = get<double>();
+  return bounds;
+}
+
+std::unique_ptr<Feature> Decoder::getFeature()
+{
+  switch (get<std::uint8_t>())
+  {
+    case Feature::Color:
+    {
+      const double L = get<double>();
+      const double a = get<double>();
+      const double b = get<double>();
+      const double weight = get<double>();
+      return std::unique_ptr<Feature>(new ColorFeature(L,a,b,weight));
+    }
+    case Feature::Plate:
+      return std::unique_ptr<Feature>(new PlateFeature(getString()));
+    default:
+      throw ProtocolError("Unknown type of feature");
+  }
+}
+
+DetectionReport Decoder::getDR()
+{
+  const std::int32_t sensorId = get<std::int32_t>();
+  const std::int32_t drId = get<std::int32_t>();
+  const double lon = get<double>();
+  const double lat = get<double>();
+  const double mos = get<double>();
+  const std::int64_t uploadTime = get<std::int64_t>();
+  const std::int64_t sensorTime = get<std::int64_t>();
+
+  const std::uint8_t featuresCount = get<std::uint8_t>();
+  std::vector<std::unique_ptr<Feature> > features;
+  features.reserve(featuresCount);
+  for (std::uint8_t i = 0; i < featuresCount; ++i)
+  {
+    features.push_back(getFeature());
+  }
+
+  const FeatureTable::row_t* row = nullptr;
+  if (features_ && !features.empty())
+    row = features_->addRow(std::move(features));
+  return DetectionReport(sensorId,drId,lon,lat,mos,uploadTime,sensorTime,
+                         nullptr,row);
+}
+
+std::set<DetectionReport> Decoder::getGroup()
+{
+  std::set<DetectionReport> group;
+  const std::uint32_t size = getCount(drSize);
+  for (std::uint32_t i = 0; i < size; ++i)
+  {
+    group.insert(getDR());
+  }
+
+  return group;
+}
+
+std::vector<std::set<DetectionReport> > Decoder::getGroups()
+{
+  std::vector<std::set<DetectionReport> > groups;
+  const std::uint32_t size = getCount(sizeof(std::uint32_t));
+  groups.reserve(size);
+  for (std::uint32_t i = 0; i < size; ++i)
+  {
+    groups.push_back(getGroup());
+  }
+
+  return groups;
+}
+
+std::vector<std::uint32_t> Decoder::getIndices()
+{
+  std::vector<std::uint32_t> indices(getCount(sizeof(std::uint32_t)));
+  for (std::uint32_t& index : indices)
+  {
+    index = get<std::uint32_t>();
+  }
+
+  return indices;
+}
+
+Track::State Decoder::getTrackState()
+{
+  Track::State state;
+  std::memcpy(state.uuid.data,take(state.uuid.size()),state.uuid.size());
+  state.lon = get<double>();
+  state.lat = get<double>();
+  state.mos = get<double>();
+  state.lonVel = get<double>();
+  state.latVel = get<double>();
+  state.mosVel = get<double>();
+  state.predictedLon = get<double>();
+  state.predictedLat = get<double>();
+  state.predictedMos = get<double>();
+  state.lonPredictionVar = get<double>();
+  state.latPredictionVar = get<double>();
+  state.mosPredictionVar = get<double>();
+  state.refreshTime = get<std::int64_t>();
+  state.measurementTime = get<std::int64_t>();
+  const std::uint32_t size = getCount(sizeof(double));
+  state.filterState.resize(size);
+  for (double& value : state.filterState)
+  {
+    value = get<double>();
+  }
+  const std::uint32_t featuresCount = getCount(sizeof(std::uint8_t));
+  for (std::uint32_t i = 0; i < featuresCount; ++i)
+  {
+    state.features.push_back(std::shared_ptr<const Feature>(getFeature()));
+  }
+
+  return state;
+}
+
+std::vector<Track::State> Decoder::getTrackStates()
+{
+  std::vector<Track::State> states;
+  const std::uint32_t size = getCount(trackStateSize);
+  states.reserve(size);
+  for (std::uint32_t i = 0; i < size; ++i)
+  {
+    states.push_back(getTrackState());
+  }
+
+  return states;
+}
+
+bool Decoder::atEnd() const
+{
+  return position_ == buffer_.size();
+}
+
+const char* Decoder::take(std::size_t bytes)
+{
+  if (buffer_.size() - position_ < bytes)
+    throw ProtocolError("Message is shorter than expected");
+
+  const char* result = buffer_.data() + position_;
+  position_ += bytes;
+  return result;
+}
+
+std::uint32_t Decoder::getCount(std::size_t minimalElementSize)
+{
+  const std::uint32_t count = get<std::uint32_t>();
+  if (count > (buffer_.size() - position_) / minimalElementSize)
+    throw ProtocolError("Count of elements exceeds message size");
+
+  return count;
+}
+
+/******************************************************************************/
+
+void writeMessage(boost::asio::ip::tcp::socket& socket, MessageType type,
+                  const Encoder& payload)
+{
+  const std::vector<char>& buffer = payload.getBuffer();
+  char header[sizeof(std::uint32_t) + sizeof(std::uint8_t)];
+  const std::uint32_t size = buffer.size();
+  std::memcpy(header,&size,sizeof(size));
+  header[sizeof(size)] = static_cast<char>(type);
+
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.push_back(boost::asio::buffer(header));
+  buffers.push_back(boost::asio::buffer(buffer));
+  boost::asio::write(socket,buffers);
+}
+
+MessageType readMessage(boost::asio::ip::tcp::socket& socket,
+                        std::vector<char>& payload)
+{
+  char header[sizeof(std::uint32_t) + sizeof(std::uint8_t)];
+  boost::asio::read(socket,boost::asio::buffer(header));
+
+  std::uint32_t size;
+  std::memcpy(&size,header,sizeof(size));
+  if (size > maximalPayloadSize)
+    throw ProtocolError("Message is too long");
+
+  payload.resize(size);
+  if (size > 0)
+    boost::asio::read(socket,boost::asio::buffer(payload));
+
+  return static_cast<MessageType>(header[sizeof(size)]);
+}
+
+} // namespace Distributed
+
+} // namespace Model
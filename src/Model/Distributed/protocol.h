@@ -0,0 +1,161 @@
+#ifndef DISTRIBUTED_PROTOCOL_H
+#define DISTRIBUTED_PROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include <Model/detectionreport.h>
+#include <Model/feature.h>
+#include <Model/featuretable.h>
+#include <Model/shardedtracker.h>
+#include <Model/track.h>
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+/**
+ * Coordinator (ShardedTracker with RemoteShards) sends requests,
+ * shard process (ShardServer) answers each of them, in order.
+ *
+ * Frame: uint32 payload length, uint8 MessageType, payload.
+ * Values are written in native byte order - all hosts have to share it.
+ * DRs and Track::States carry their features (uint8 Feature::Type,
+ * then value: Color - L, a, b, weight; Plate - string).
+ */
+enum MessageType : std::uint8_t
+{
+  Configure = 1, // Bounds -> Ack
+  Associate, // groups -> AssociateResult
+  AssociateResult, // (Track::State, group)[], not associated groups,
+                   // their indices in request (uint32[])
+  Initialize, // groups -> Initialized
+  Initialized, // (Track::State, group)[]
+  TakeLeavingTracks, // -> Tracks
+  AddTracks, // Track::State[] -> Ack
+  GetTracks, // -> Tracks
+  RestoreTracks, // Track::State[] -> Ack
+  RemoveExpiredTracks, // int64 current time, double TTL -> Count
+  Tracks, // Track::State[]
+  Count, // uint64
+  Ack,
+  Error, // string
+  Quit // no response, connection is closed
+};
+
+class ProtocolError : public std::runtime_error
+{
+public:
+  explicit ProtocolError(const std::string& what);
+};
+
+/**
+ * @brief Builds payload of message.
+ */
+class Encoder
+{
+public:
+  template <class T>
+  void put(T value)
+  {
+    static_assert(std::is_arithmetic<T>::value,"Only arithmetic types!");
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer_.insert(buffer_.end(),bytes,bytes+sizeof(T));
+  }
+
+  void putString(const std::string& value);
+  void putBounds(const Bounds& bounds);
+  void putFeature(const Feature& feature);
+  void putDR(const DetectionReport& dr);
+  void putGroup(const std::set<DetectionReport>& group);
+  void putGroups(const std::vector<std::set<DetectionReport> >& groups);
+  void putIndices(const std::vector<std::size_t>& indices);
+  void putTrackState(const Track::State& state);
+  void putTrackStates(const std::vector<Track::State>& states);
+
+  const std::vector<char>& getBuffer() const;
+
+private:
+  std::vector<char> buffer_;
+};
+
+/**
+ * @brief Reads payload of message. Throws ProtocolError,
+ *  when payload is shorter than expected.
+ */
+class Decoder
+{
+public:
+  /**
+   * @param buffer - payload
+   * @param features - table owning features of decoded DRs
+   *  (nullptr - features of DRs are skipped)
+   */
+  explicit Decoder(const std::vector<char>& buffer,
+                   FeatureTable* features = nullptr);
+
+  template <class T>
+  T get()
+  {
+    static_assert(std::is_arithmetic<T>::value,"Only arithmetic types!");
+    T value;
+    std::memcpy(&value,take(sizeof(T)),sizeof(T));
+    return value;
+  }
+
+  std::string getString();
+  Bounds getBounds();
+  std::unique_ptr<Feature> getFeature();
+  DetectionReport getDR();
+  std::set<DetectionReport> getGroup();
+  std::vector<std::set<DetectionReport> > getGroups();
+  std::vector<std::uint32_t> getIndices();
+  Track::State getTrackState();
+  std::vector<Track::State> getTrackStates();
+
+  bool atEnd() const;
+
+private:
+  const char* take(std::size_t bytes);
+
+  /**
+   * @brief Reads count of elements, checking it against remaining payload,
+   *  so corrupted count never causes huge allocation.
+   */
+  std::uint32_t getCount(std::size_t minimalElementSize);
+
+  const std::vector<char>& buffer_;
+  std::size_t position_;
+  FeatureTable* features_;
+};
+
+/**
+ * @brief Sends one frame. Throws boost::system::system_error on failure.
+ */
+void writeMessage(boost::asio::ip::tcp::socket& socket, MessageType type,
+                  const Encoder& payload = Encoder());
+
+/**
+ * @brief Receives one frame. Throws boost::system::system_error on failure
+ *  (e.g. boost::asio::error::eof, when peer closed connection).
+ * @param payload of received message
+ * @return type of received message
+ */
+MessageType readMessage(boost::asio::ip::tcp::socket& socket,
+                        std::vector<char>& payload);
+
+} // namespace Distributed
+
+} // namespace Model
+
+#endif // DISTRIBUTED_PROTOCOL_H
@@ -0,0 +1,259 @@
+#include "remoteshard.h"
+
+#include <algorithm>
+#include <sstream> // used for logging purpose
+
+#include <boost/asio/connect.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Common/logger.h>
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+RemoteShard::RemoteShard(const Bounds& tile, const std::string& host,
+                         unsigned short port,
+                         std::unique_ptr<estimation::EstimationFilter<> >
+                           filter)
+  : Shard(tile),
+    socket_(ioService_),
+    filter_(std::move(filter))
+{
+  boost::asio::ip::tcp::resolver resolver(ioService_);
+  boost::asio::ip::tcp::resolver::query query(
+        host,boost::lexical_cast<std::string>(port));
+  boost::asio::connect(socket_,resolver.resolve(query));
+  socket_.set_option(boost::asio::ip::tcp::no_delay(true));
+
+  Encoder arguments;
+  arguments.putBounds(tile);
+  call(Configure,arguments,Ack);
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Connected to shard " << host << ":" << port;
+    Common::GlobalLogger::getInstance().log("RemoteShard",msg.str());
+  }
+}
+
+RemoteShard::~RemoteShard()
+{
+  try
+  {
+    writeMessage(socket_,Quit);
+  }
+  catch (const std::exception& e)
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Cannot finish session: " << e.what();
+    Common::GlobalLogger::getInstance().log("RemoteShard",msg.str());
+  }
+}
+
+void RemoteShard::associate(
+    std::vector<std::set<DetectionReport> >& groups,
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& associated,
+    std::vector<std::set<DetectionReport> >& notAssociated,
+    std::vector<std::size_t>& sources)
+{
+  if (groups.empty())
+    return;
+
+  Encoder arguments;
+  arguments.putGroups(groups);
+  rememberSent(groups);
+  const std::size_t sent = groups.size();
+  groups.clear();
+  call(Associate,arguments,AssociateResult);
+
+  Decoder decoder(payload_);
+  readTracksDRs(decoder,associated);
+  const std::vector<std::set<DetectionReport> > rest = decoder.getGroups();
+  const std::vector<std::uint32_t> indices = decoder.getIndices();
+  if (indices.size() != rest.size())
+    throw ProtocolError("Not associated groups have no sources");
+  for (std::size_t i = 0; i < rest.size(); ++i)
+  {
+    if (indices[i] >= sent)
+      throw ProtocolError("Source of not associated group is out of range");
+    notAssociated.push_back(restoreSent(rest[i]));
+    sources.push_back(indices[i]);
+  }
+}
+
+void RemoteShard::initialize(
+    const std::vector<std::set<DetectionReport> >& groups,
+    const estimation::EstimationFilter<>&,
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& initialized)
+{
+  if (groups.empty())
+    return;
+
+  Encoder arguments;
+  arguments.putGroups(groups);
+  rememberSent(groups);
+  call(Initialize,arguments,Initialized);
+
+  Decoder decoder(payload_);
+  readTracksDRs(decoder,initialized);
+}
+
+void RemoteShard::takeLeavingTracks(
+    std::vector<std::shared_ptr<Track> >& leaving)
+{
+  call(TakeLeavingTracks,Encoder(),Tracks);
+  const std::set<std::shared_ptr<Track> > tracks = readTracks();
+  leaving.insert(leaving.end(),tracks.begin(),tracks.end());
+}
+
+void RemoteShard::addTracks(const std::vector<std::shared_ptr<Track> >& tracks)
+{
+  if (tracks.empty())
+    return;
+
+  std::vector<Track::State> states;
+  states.reserve(tracks.size());
+  for (const std::shared_ptr<Track>& track : tracks)
+  {
+    states.push_back(track->getState());
+  }
+
+  Encoder arguments;
+  arguments.putTrackStates(states);
+  call(AddTracks,arguments,Ack);
+}
+
+std::set<std::shared_ptr<Track> > RemoteShard::getTracks()
+{
+  call(GetTracks,Encoder(),Tracks);
+  return readTracks();
+}
+
+void RemoteShard::restoreTracks(const std::set<std::shared_ptr<Track> >& tracks)
+{
+  std::vector<Track::State> states;
+  states.reserve(tracks.size());
+  for (const std::shared_ptr<Track>& track : tracks)
+  {
+    states.push_back(track->getState());
+  }
+
+  Encoder arguments;
+  arguments.putTrackStates(states);
+  call(RestoreTracks,arguments,Ack);
+}
+
+std::size_t RemoteShard::removeExpiredTracks(time_types::ptime_t currentTime,
+                                             time_types::duration_t TTL)
+{
+  Encoder arguments;
+  arguments.put<std::int64_t>(currentTime.time_since_epoch().count());
+  arguments.put(TTL.count());
+  call(RemoveExpiredTracks,arguments,Count);
+
+  Decoder decoder(payload_);
+  return decoder.get<std::uint64_t>();
+}
+
+void RemoteShard::setRoadMotionModel(std::shared_ptr<const RoadMotionModel>,
+                                     time_types::duration_t, double)
+{
+  Common::GlobalLogger::getInstance().log("RemoteShard",
+                                          "Road motion model is not "
+                                          "supported by remote shards.");
+}
+
+void RemoteShard::call(MessageType request, const Encoder& arguments,
+                       MessageType expectedResponse)
+{
+  writeMessage(socket_,request,arguments);
+  const MessageType response = readMessage(socket_,payload_);
+  if (response == Error)
+  {
+    Decoder decoder(payload_);
+    throw ProtocolError("Shard failed: " + decoder.getString());
+  }
+  if (response != expectedResponse)
+    throw ProtocolError("Unexpected response from shard");
+}
+
+void RemoteShard::rememberSent(
+    const std::vector<std::set<DetectionReport> >& groups)
+{
+  sent_.clear();
+  for (const std::set<DetectionReport>& group : groups)
+  {
+    for (const DetectionReport& dr : group)
+    {
+      sent_.insert(std::make_pair(std::make_pair(dr.getSensorId(),
+                                                 dr.getDrId()),
+                                  dr));
+    }
+  }
+}
+
+std::set<DetectionReport>
+  RemoteShard::restoreSent(const std::set<DetectionReport>& received) const
+{
+  std::set<DetectionReport> result;
+  for (const DetectionReport& dr : received)
+  {
+    std::map<std::pair<int,int>,DetectionReport>::const_iterator it
+        = sent_.find(std::make_pair(dr.getSensorId(),dr.getDrId()));
+    result.insert(it != sent_.end() ? it->second : dr);
+  }
+
+  return result;
+}
+
+std::shared_ptr<Track> RemoteShard::makeTrack(const Track::State& state) const
+{
+  return std::make_shared<Track>(filter_->clone(),state);
+}
+
+void RemoteShard::readTracksDRs(
+    Decoder& decoder,
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& into) const
+{
+  const std::uint32_t count = decoder.get<std::uint32_t>();
+  for (std::uint32_t i = 0; i < count; ++i)
+  {
+    const Track::State state = decoder.getTrackState();
+    const std::set<DetectionReport> DRs = restoreSent(decoder.getGroup());
+
+    // the same Track could be received in previous response - it's copy
+    //  is replaced with the newer one
+    auto it = std::find_if(into.begin(),into.end(),
+                           [&state](const std::pair<const std::shared_ptr<Track>,
+                                              std::set<DetectionReport> >& t)
+                           {
+                             return t.first->getUuid() == state.uuid;
+                           });
+    std::set<DetectionReport> allDRs = DRs;
+    if (it != into.end())
+    {
+      allDRs.insert(it->second.begin(),it->second.end());
+      into.erase(it);
+    }
+    into[makeTrack(state)] = allDRs;
+  }
+}
+
+std::set<std::shared_ptr<Track> > RemoteShard::readTracks()
+{
+  Decoder decoder(payload_);
+  std::set<std::shared_ptr<Track> > tracks;
+  for (const Track::State& state : decoder.getTrackStates())
+  {
+    tracks.insert(makeTrack(state));
+  }
+
+  return tracks;
+}
+
+} // namespace Distributed
+
+} // namespace Model
@@ -0,0 +1,131 @@
+#ifndef DISTRIBUTED_REMOTESHARD_H
+#define DISTRIBUTED_REMOTESHARD_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/shardedtracker.h>
+
+#include "protocol.h"
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+/**
+ * @brief Proxy of shard tracking in other process (ShardServer).
+ *
+ * Every operation is synchronous request to the server, made
+ * on shard's worker thread, so all remote shards work in parallel.
+ * Tracks returned by remote shard are copies - rebuilt from their states
+ * each time, so changes made to them are not visible in the shard.
+ */
+class RemoteShard : public Shard
+{
+public:
+  /**
+   * @brief Connects to server and configures it's tile.
+   *  Throws boost::system::system_error, when connection fails
+   *  and ProtocolError, when server refused configuration.
+   * @param tile - area owned by shard
+   * @param host of ShardServer
+   * @param port of ShardServer
+   * @param filter - prototype of filters of Tracks received from server
+   */
+  RemoteShard(const Bounds& tile, const std::string& host,
+              unsigned short port,
+              std::unique_ptr<estimation::EstimationFilter<> > filter);
+
+  /**
+   * @brief Tells server to finish the session.
+   */
+  virtual ~RemoteShard();
+
+  virtual void associate(std::vector<std::set<DetectionReport> >& groups,
+                         std::map<std::shared_ptr<Track>,
+                                  std::set<DetectionReport> >& associated,
+                         std::vector<std::set<DetectionReport> >& notAssociated,
+                         std::vector<std::size_t>& sources);
+
+  /**
+   * @brief Initializes Tracks in remote shard.
+   *  Given filter is ignored - server uses it's own.
+   */
+  virtual void initialize(const std::vector<std::set<DetectionReport> >& groups,
+                          const estimation::EstimationFilter<>& filter,
+                          std::map<std::shared_ptr<Track>,
+                                   std::set<DetectionReport> >& initialized);
+
+  virtual void takeLeavingTracks(std::vector<std::shared_ptr<Track> >& leaving);
+
+  virtual void addTracks(const std::vector<std::shared_ptr<Track> >& tracks);
+
+  virtual std::set<std::shared_ptr<Track> > getTracks();
+
+  virtual void restoreTracks(const std::set<std::shared_ptr<Track> >& tracks);
+
+  virtual std::size_t removeExpiredTracks(time_types::ptime_t currentTime,
+                                          time_types::duration_t TTL);
+
+  /**
+   * @brief Road motion model is not sent to server (it works without it).
+   */
+  virtual void setRoadMotionModel(std::shared_ptr<const RoadMotionModel> model,
+                                  time_types::duration_t dormantTTL,
+                                  double reacquisitionDistance);
+
+private:
+  /**
+   * @brief Sends request and receives response into payload_.
+   *  Throws ProtocolError, when server answered with Error
+   *  or with other type of message than expected.
+   */
+  void call(MessageType request, const Encoder& arguments,
+            MessageType expectedResponse);
+
+  std::shared_ptr<Track> makeTrack(const Track::State& state) const;
+
+  /**
+   * @brief Remembers DRs sent in request, to restore them from response.
+   */
+  void rememberSent(const std::vector<std::set<DetectionReport> >& groups);
+
+  /**
+   * @brief Replaces received DRs with the same DRs sent in request,
+   *  so they point to features (and sensors) of this process again.
+   */
+  std::set<DetectionReport>
+    restoreSent(const std::set<DetectionReport>& received) const;
+
+  /**
+   * @brief Decodes (Track::State, group of DRs) pairs from payload_.
+   */
+  void readTracksDRs(Decoder& decoder,
+                     std::map<std::shared_ptr<Track>,
+                              std::set<DetectionReport> >& into) const;
+
+  std::set<std::shared_ptr<Track> > readTracks();
+
+  boost::asio::io_service ioService_;
+  boost::asio::ip::tcp::socket socket_;
+  std::unique_ptr<estimation::EstimationFilter<> > filter_;
+  std::vector<char> payload_;
+
+  // DRs of the last Associate or Initialize request, by sensor and DR id
+  std::map<std::pair<int,int>,DetectionReport> sent_;
+};
+
+} // namespace Distributed
+
+} // namespace Model
+
+#endif // DISTRIBUTED_REMOTESHARD_H
@@ -0,0 +1,203 @@
+#include "shardserver.h"
+
+#include <sstream> // used for logging purpose
+
+#include <Common/logger.h>
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+ShardServer::ShardServer(unsigned short port,
+                         const ShardedTracker::ShardFactory& factory,
+                         std::unique_ptr<estimation::EstimationFilter<> >
+                           filter)
+  : factory_(factory),
+    filter_(std::move(filter)),
+    acceptor_(ioService_,
+              boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(),port))
+{}
+
+unsigned short ShardServer::getPort() const
+{
+  return acceptor_.local_endpoint().port();
+}
+
+void ShardServer::serve()
+{
+  boost::asio::ip::tcp::socket socket(ioService_);
+  acceptor_.accept(socket);
+  socket.set_option(boost::asio::ip::tcp::no_delay(true));
+  Common::GlobalLogger::getInstance().log("ShardServer",
+                                          "Coordinator connected.");
+
+  try
+  {
+    while (true)
+    {
+      const MessageType request = readMessage(socket,payload_);
+      if (request == Quit)
+        break;
+
+      Encoder response;
+      MessageType responseType;
+      try
+      {
+        responseType = handle(request,response);
+      }
+      catch (const std::exception& e)
+      {
+        response = Encoder();
+        response.putString(e.what());
+        responseType = Error;
+      }
+      writeMessage(socket,responseType,response);
+    }
+  }
+  catch (const std::exception& e)
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Session broken: " << e.what();
+    Common::GlobalLogger::getInstance().log("ShardServer",msg.str());
+  }
+
+  Common::GlobalLogger::getInstance().log("ShardServer",
+                                          "Coordinator disconnected.");
+}
+
+void ShardServer::run()
+{
+  while (true)
+  {
+    serve();
+  }
+}
+
+MessageType ShardServer::handle(MessageType request, Encoder& response)
+{
+  // features of previous request's DRs are already fused into Tracks
+  features_.clear();
+  Decoder arguments(payload_,&features_);
+  if (request == Configure)
+  {
+    configure(arguments);
+    return Ack;
+  }
+
+  if (!shard_)
+    throw ProtocolError("Shard is not configured");
+
+  switch (request)
+  {
+    case Associate:
+    {
+      std::vector<std::set<DetectionReport> > groups = arguments.getGroups();
+      tracks_drs_t associated;
+      std::vector<std::set<DetectionReport> > notAssociated;
+      std::vector<std::size_t> sources;
+      shard_->associate(groups,associated,notAssociated,sources);
+      writeTracksDRs(associated,response);
+      response.putGroups(notAssociated);
+      response.putIndices(sources);
+      return AssociateResult;
+    }
+    case Initialize:
+    {
+      tracks_drs_t initialized;
+      shard_->initialize(arguments.getGroups(),*filter_,initialized);
+      writeTracksDRs(initialized,response);
+      return Initialized;
+    }
+    case TakeLeavingTracks:
+    {
+      std::vector<std::shared_ptr<Track> > leaving;
+      shard_->takeLeavingTracks(leaving);
+      writeTracks(leaving,response);
+      return Tracks;
+    }
+    case AddTracks:
+    {
+      std::vector<std::shared_ptr<Track> > tracks;
+      for (const Track::State& state : arguments.getTrackStates())
+      {
+        tracks.push_back(makeTrack(state));
+      }
+      shard_->addTracks(tracks);
+      return Ack;
+    }
+    case GetTracks:
+      writeTracks(shard_->getTracks(),response);
+      return Tracks;
+    case RestoreTracks:
+    {
+      std::set<std::shared_ptr<Track> > tracks;
+      for (const Track::State& state : arguments.getTrackStates())
+      {
+        tracks.insert(makeTrack(state));
+      }
+      shard_->restoreTracks(tracks);
+      return Ack;
+    }
+    case RemoveExpiredTracks:
+    {
+      const time_types::ptime_t currentTime(
+            time_types::clock_t::duration(arguments.get<std::int64_t>()));
+      const time_types::duration_t TTL(arguments.get<double>());
+      response.put<std::uint64_t>(
+            shard_->removeExpiredTracks(currentTime,TTL));
+      return Count;
+    }
+    default:
+      throw ProtocolError("Unknown request");
+  }
+}
+
+void ShardServer::configure(Decoder& arguments)
+{
+  const Bounds tile = arguments.getBounds();
+  shard_.reset(); // previous session's Tracks are dropped
+
+  std::shared_ptr<TrackManager> trackManager = factory_.trackManager();
+  shard_.reset(new TrackerShard(tile,trackManager,
+                                factory_.dataAssociator(trackManager),
+                                factory_.fusionExecutor()));
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Configured tile: (" << tile.minLon << ", " << tile.minLat
+        << ") - (" << tile.maxLon << ", " << tile.maxLat << ")";
+    Common::GlobalLogger::getInstance().log("ShardServer",msg.str());
+  }
+}
+
+std::shared_ptr<Track> ShardServer::makeTrack(const Track::State& state) const
+{
+  return std::make_shared<Track>(filter_->clone(),state);
+}
+
+void ShardServer::writeTracksDRs(const tracks_drs_t& tracksDRs,
+                                 Encoder& response)
+{
+  // DataAssociator reports all Tracks - only updated ones are sent
+  std::uint32_t count = 0;
+  for (const auto& trackDRs : tracksDRs)
+  {
+    if (!trackDRs.second.empty())
+      ++count;
+  }
+
+  response.put(count);
+  for (const auto& trackDRs : tracksDRs)
+  {
+    if (trackDRs.second.empty())
+      continue;
+    response.putTrackState(trackDRs.first->getState());
+    response.putGroup(trackDRs.second);
+  }
+}
+
+} // namespace Distributed
+
+} // namespace Model
@@ -0,0 +1,98 @@
+#ifndef DISTRIBUTED_SHARDSERVER_H
+#define DISTRIBUTED_SHARDSERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/shardedtracker.h>
+
+#include "protocol.h"
+
+namespace Model
+{
+
+namespace Distributed
+{
+
+/**
+ * @brief Serves one shard of ShardedTracker to coordinator (RemoteShard).
+ *
+ * Coordinator configures shard's tile at the beginning of session,
+ * then each request is answered with result of corresponding operation
+ * of local TrackerShard. Failed operation is answered with Error message,
+ * session continues.
+ */
+class ShardServer
+{
+public:
+  /**
+   * @param port to listen on (0 - any free port, see getPort())
+   * @param factory of shard's components
+   * @param filter used to initialize Tracks and to rebuild received ones
+   */
+  ShardServer(unsigned short port,
+              const ShardedTracker::ShardFactory& factory,
+              std::unique_ptr<estimation::EstimationFilter<> > filter);
+
+  unsigned short getPort() const;
+
+  /**
+   * @brief Accepts coordinator's connection and serves it,
+   *  until coordinator quits or disconnects.
+   *  Throws boost::system::system_error, when accepting fails.
+   */
+  void serve();
+
+  /**
+   * @brief Serves subsequent sessions, forever.
+   */
+  void run();
+
+private:
+  typedef std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
+    tracks_drs_t;
+
+  /**
+   * @brief Handles request (in payload_) and writes response to it.
+   * @return type of response
+   */
+  MessageType handle(MessageType request, Encoder& response);
+
+  void configure(Decoder& arguments);
+
+  std::shared_ptr<Track> makeTrack(const Track::State& state) const;
+
+  static void writeTracksDRs(const tracks_drs_t& tracksDRs, Encoder& response);
+
+  template <class Tracks>
+  static void writeTracks(const Tracks& tracks, Encoder& response)
+  {
+    std::vector<Track::State> states;
+    states.reserve(tracks.size());
+    for (const std::shared_ptr<Track>& track : tracks)
+    {
+      states.push_back(track->getState());
+    }
+    response.putTrackStates(states);
+  }
+
+  const ShardedTracker::ShardFactory factory_;
+  std::unique_ptr<estimation::EstimationFilter<> > filter_;
+
+  boost::asio::io_service ioService_;
+  boost::asio::ip::tcp::acceptor acceptor_;
+
+  std::unique_ptr<TrackerShard> shard_; // created by Configure
+  std::vector<char> payload_;
+  FeatureTable features_; // of DRs of the current request
+};
+
+} // namespace Distributed
+
+} // namespace Model
+
+#endif // DISTRIBUTED_SHARDSERVER_H
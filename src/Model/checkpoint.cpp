@@ -0,0 +1,202 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+namespace boost
+{
+
+namespace serialization
+{
+
+/*
+ * Features are stored as count, then type (uint8) and value of each one
+ *  (as in protocol of distributed shards). Features of types, which
+ *  cannot be stored, are skipped.
+ */
+template <class Archive>
+void saveFeatures(Archive& ar,
+                  const std::vector<std::shared_ptr<const Feature> >& features)
+{
+  std::uint32_t count = 0;
+  for (const std::shared_ptr<const Feature>& feature : features)
+  {
+    if (feature && (feature->getType() == Feature::Color
+                    || feature->getType() == Feature::Plate))
+      ++count;
+  }
+  ar & count;
+
+  for (const std::shared_ptr<const Feature>& feature : features)
+  {
+    if (!feature)
+      continue;
+
+    std::uint8_t type = feature->getType();
+    switch (feature->getType())
+    {
+      case Feature::Color:
+      {
+        const ColorFeature& color = static_cast<const ColorFeature&>(*feature);
+        double L = color.getL();
+        double a = color.getA();
+        double b = color.getB();
+        double weight = color.getWeight();
+        ar & type & L & a & b & weight;
+        break;
+      }
+      case Feature::Plate:
+      {
+        std::string plate
+            = static_cast<const PlateFeature&>(*feature).getPlate();
+        ar & type & plate;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+template <class Archive>
+void loadFeatures(Archive& ar,
+                  std::vector<std::shared_ptr<const Feature> >& features)
+{
+  std::uint32_t count = 0;
+  ar & count;
+  features.clear();
+  for (std::uint32_t i = 0; i < count; ++i)
+  {
+    std::uint8_t type = 0;
+    ar & type;
+    switch (type)
+    {
+      case Feature::Color:
+      {
+        double L, a, b, weight;
+        ar & L & a & b & weight;
+        features.push_back(
+              std::make_shared<const ColorFeature>(L,a,b,weight));
+        break;
+      }
+      case Feature::Plate:
+      {
+        std::string plate;
+        ar & plate;
+        features.push_back(std::make_shared<const PlateFeature>(plate));
+        break;
+      }
+      default: // corrupted file
+        throw std::runtime_error("Unknown type of feature in checkpoint");
+    }
+  }
+}
+
+template <class Archive>
+void serialize(Archive& ar, Track::State& state, const unsigned /*version*/)
+{
+  ar & state.uuid.data;
+  ar & state.lon & state.lat & state.mos;
+  ar & state.lonVel & state.latVel & state.mosVel;
+  ar & state.predictedLon & state.predictedLat & state.predictedMos;
+  ar & state.lonPredictionVar & state.latPredictionVar
+     & state.mosPredictionVar;
+  ar & state.refreshTime & state.measurementTime;
+  ar & state.filterState;
+  if (Archive::is_saving::value)
+    saveFeatures(ar,state.features);
+  else
+    loadFeatures(ar,state.features);
+}
+
+template <class Archive>
+void serialize(Archive& ar, ReportManager::Cursor& cursor,
+               const unsigned /*version*/)
+{
+  ar & cursor.sensorTime & cursor.drId;
+}
+
+template <class Archive>
+void serialize(Archive& ar, Model::TrackerState& state,
+               const unsigned /*version*/)
+{
+  ar & state.tracks & state.cursor & state.modelTime;
+}
+
+} // namespace serialization
+
+} // namespace boost
+
+namespace Model
+{
+
+const std::uint32_t Checkpoint::version;
+const std::string Checkpoint::magic_ = "T0MCHKPT";
+
+Checkpoint::Checkpoint(const std::string& path)
+  : path_(path)
+{}
+
+bool Checkpoint::load(TrackerState& state) const
+{
+  std::ifstream file(path_.c_str(),std::ios::binary);
+  if (!file)
+    return false;
+
+  try
+  {
+    boost::archive::binary_iarchive archive(file);
+    std::string magic;
+    std::uint32_t fileVersion;
+    archive >> magic >> fileVersion;
+    if (magic != magic_ || fileVersion != version)
+      return false;
+
+    archive >> state;
+  }
+  catch (const std::exception& /*ex*/)
+  { // corrupted or truncated file (archive_exception),
+    //  or corrupted size of some collection (bad_alloc, length_error)
+    return false;
+  }
+
+  return true;
+}
+
+bool Checkpoint::store(const TrackerState& state) const
+{
+  const std::string tmpPath = path_ + ".tmp";
+  {
+    std::ofstream file(tmpPath.c_str(),std::ios::binary | std::ios::trunc);
+    if (!file)
+      return false;
+
+    { // archive has to be destroyed (flushed) before closing file
+      boost::archive::binary_oarchive archive(file);
+      archive << magic_ << version << state;
+    }
+    file.close();
+    if (!file)
+    {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(tmpPath.c_str(),path_.c_str()) != 0)
+  {
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace Model
@@ -0,0 +1,61 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Model/reportmanager.h>
+#include <Model/track.h>
+
+namespace Model
+{
+
+/**
+ * @brief State of tracking process, needed to resume it after restart.
+ */
+struct TrackerState
+{
+  std::vector<Track::State> tracks;
+  ReportManager::Cursor cursor; // where reading of DRs should be resumed
+  std::int64_t modelTime; // clock ticks since epoch
+};
+
+/**
+ * @brief Binary file with TrackerState (boost::serialization binary archive),
+ *  written periodically, to not start tracking from scratch at each start.
+ *
+ * Archive begins with magic and version - files with other ones
+ * are treated as not existing, as well as corrupted files.
+ * Format is not portable (binary archive uses native types).
+ */
+class Checkpoint
+{
+public:
+  static const std::uint32_t version = 4;
+
+  explicit Checkpoint(const std::string& path);
+
+  /**
+   * @param state read from file
+   * @return false when file does not exist, is incompatible or corrupted
+   *  (given state is left unspecified then)
+   */
+  bool load(TrackerState& state) const;
+
+  /**
+   * @brief Writes state to temporary file, and then replaces checkpoint
+   *  with it, so crash while writing never destroys previous checkpoint.
+   * @return true if checkpoint was written successfully
+   */
+  bool store(const TrackerState& state) const;
+
+private:
+  static const std::string magic_;
+
+  const std::string path_;
+};
+
+} // namespace Model
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,86 @@
+#include "colormatcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
+namespace
+{
+
+double linearize(unsigned char component)
+{
+  const double c = component/255.0;
+  return (c <= 0.04045) ? c/12.92 : std::pow((c + 0.055)/1.055,2.4);
+}
+
+double labFunction(double t)
+{
+  static const double epsilon = 216.0/24389;
+  static const double kappa = 24389.0/27;
+  return (t > epsilon) ? std::cbrt(t) : (kappa*t + 16)/116;
+}
+
+} // anonymous namespace
+
+void rgbToLab(unsigned char red, unsigned char green, unsigned char blue,
+              double& L, double& a, double& b)
+{
+  const double r = linearize(red);
+  const double g = linearize(green);
+  const double bl = linearize(blue);
+
+  // XYZ normalized to D65 white point
+  const double x = (0.4124564*r + 0.3575761*g + 0.1804375*bl)/0.95047;
+  const double y = 0.2126729*r + 0.7151522*g + 0.0721750*bl;
+  const double z = (0.0193339*r + 0.1191920*g + 0.9503041*bl)/1.08883;
+
+  const double fx = labFunction(x);
+  const double fy = labFunction(y);
+  const double fz = labFunction(z);
+
+  L = 116*fy - 16;
+  a = 500*(fx - fy);
+  b = 200*(fy - fz);
+}
+
+void rateColors(const double* Ls, const double* as, const double* bs,
+                std::size_t count,
+                double L, double a, double b,
+                double* grades)
+{
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128d colorL = _mm_set1_pd(L);
+  const __m128d colorA = _mm_set1_pd(a);
+  const __m128d colorB = _mm_set1_pd(b);
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d scale = _mm_set1_pd(1/maxColorDifference);
+
+  for (; i + 2 <= count; i += 2)
+  {
+    const __m128d dL = _mm_sub_pd(_mm_loadu_pd(Ls + i),colorL);
+    const __m128d dA = _mm_sub_pd(_mm_loadu_pd(as + i),colorA);
+    const __m128d dB = _mm_sub_pd(_mm_loadu_pd(bs + i),colorB);
+    const __m128d squared = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dL,dL),
+                                                  _mm_mul_pd(dA,dA)),
+                                       _mm_mul_pd(dB,dB));
+    const __m128d grade
+        = _mm_sub_pd(one,_mm_mul_pd(_mm_sqrt_pd(squared),scale));
+    _mm_storeu_pd(grades + i,_mm_max_pd(grade,zero));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    const double dL = Ls[i] - L;
+    const double dA = as[i] - a;
+    const double dB = bs[i] - b;
+    const double deltaE = std::sqrt(dL*dL + dA*dA + dB*dB);
+    grades[i] = std::max(0.0,1 - deltaE/maxColorDifference);
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef COLORMATCHER_H
+#define COLORMATCHER_H
+
+#include <cstddef>
+
+/**
+ * @brief Color difference (CIE76 delta E), from which colors are
+ *  completely different (0 similarity). It's distance between black and white.
+ */
+const double maxColorDifference = 100;
+
+/**
+ * @brief Converts sRGB color into CIELAB (D65 white point) - perceptual
+ *  space, where euclidean distance is difference of colors as seen by human.
+ * @param red, green, blue - sRGB components 0-255
+ * @param L, a, b - output
+ */
+void rgbToLab(unsigned char red, unsigned char green, unsigned char blue,
+              double& L, double& a, double& b);
+
+/**
+ * @brief Rates similarity of many colors with one (e.g. of Track) at once:
+ *  1 - deltaE/maxColorDifference, clipped at 0.
+ *
+ *  Vectorized with SSE2 (two colors at once), when available.
+ * @param Ls, as, bs - CIELAB components of colors (structure of arrays)
+ * @param count of colors
+ * @param L, a, b - color to compare with
+ * @param grades - output, count values
+ */
+void rateColors(const double* Ls, const double* as, const double* bs,
+                std::size_t count,
+                double L, double a, double b,
+                double* grades);
+
+#endif // COLORMATCHER_H
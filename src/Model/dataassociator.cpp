@@ -1,8 +1,12 @@
 #include "dataassociator.h"
 
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <tuple>
 
+#include "scoringkernel.h"
+
 DataAssociator::DataAssociator(std::shared_ptr<TrackManager>
                                 trackManager,
                                std::unique_ptr<ResultComparator>
@@ -24,6 +28,9 @@ void DataAssociator::compute()
 
   const std::set<std::shared_ptr<Track> >& tracks
       = trackManager_->getTracksRef();
+  if (featureExtractor_)
+    findPlateCandidates(tracks);
+
   for (std::shared_ptr<Track> track : tracks)
   {
     std::pair<std::set<DetectionReport>,time_types::ptime_t> result
@@ -52,6 +59,7 @@ DataAssociator::getNotAssociated()
 void DataAssociator::setInput(std::vector<std::set<DetectionReport> >& DRsGroups)
 {
   DRGroups_ = std::move(DRsGroups);
+  associatedDRs_.clear(); // Tracks could be removed since previous data set
   computed_ = false; // new data set - not yet computed
 }
 
@@ -86,25 +94,46 @@ std::pair<std::set<DetectionReport>,time_types::ptime_t>
   std::tuple<
       double,
       std::set<DetectionReport>, // choosen group
-      std::set<DetectionReport>, // rest group (not choosen)
+      scratch_DRs_t, // rest group (not choosen)
       time_types::ptime_t // highest sensor time from DRs from choosen group
       > choosen(
                   -1,
                   std::set<DetectionReport>(),
-                  std::set<DetectionReport>(),
+                  scratch_DRs_t(),
                   time_types::ptime_t() // initialized with epoch+0s
                 );
 
-  std::vector<std::set<DetectionReport> >::iterator it = DRGroups_.begin();
-  std::vector<std::set<DetectionReport> >::const_iterator endIt
-      = DRGroups_.end();
+  // Track with plate is rated only against groups without plates
+  //  and groups with plate similar to it's own (found by index),
+  //  other Tracks - against all groups
+  const std::vector<std::size_t>* groups = nullptr;
+  std::vector<std::size_t> plateGroups;
+  if (featureExtractor_ && track.getFeature(Feature::Plate))
+  {
+    auto candidateIt = plateGroups_.find(&track);
+    if (candidateIt == plateGroups_.end())
+      groups = &groupsWithoutPlate_;
+    else
+    { // merged in order of groups, as in full scan
+      plateGroups.reserve(groupsWithoutPlate_.size()
+                          + candidateIt->second.size());
+      std::merge(groupsWithoutPlate_.begin(),groupsWithoutPlate_.end(),
+                 candidateIt->second.begin(),candidateIt->second.end(),
+                 std::back_inserter(plateGroups));
+      groups = &plateGroups;
+    }
+  }
 
-  std::vector<std::set<DetectionReport> >::iterator choosenIt
-      = DRGroups_.end();
+  const std::size_t groupsCount = groups ? groups->size() : DRGroups_.size();
+  std::vector<std::set<DetectionReport> >::iterator endIt = DRGroups_.end();
+  std::vector<std::set<DetectionReport> >::iterator choosenIt = endIt;
 
-  for (; it != endIt; ++it)
+  for (std::size_t k = 0; k < groupsCount; ++k)
   {
-    std::set<DetectionReport> group = *it; // copy current group,
+    std::vector<std::set<DetectionReport> >::iterator it
+        = DRGroups_.begin() + (groups ? (*groups)[k] : k);
+
+    scratch_DRs_t group(it->begin(),it->end()); // copy current group,
                                         // because rateListForTrack modifies it
     std::pair<std::pair<double,std::set<DetectionReport> >,
               time_types::ptime_t> current = rateListForTrack(group,track);
@@ -126,7 +155,9 @@ std::pair<std::set<DetectionReport>,time_types::ptime_t>
     // after checking all groups
     // remove from main DR collection (DRGroups), those DRs which were choosen
 
-    *choosenIt = std::get<2>(choosen); // overwrite choosen group, to have there only not picked DRs
+    const scratch_DRs_t& rest = std::get<2>(choosen);
+    choosenIt->clear(); // overwrite choosen group, to have there only not picked DRs
+    choosenIt->insert(rest.begin(),rest.end());
   }
 
   return std::pair<std::set<DetectionReport>,time_types::ptime_t>(
@@ -136,16 +167,75 @@ std::pair<std::set<DetectionReport>,time_types::ptime_t>
 }
 
 std::pair<std::pair<double,std::set<DetectionReport> >, time_types::ptime_t>
-DataAssociator::rateListForTrack(std::set<DetectionReport>& DRs,const Track& track) const
+DataAssociator::rateListForTrack(scratch_DRs_t& DRs,const Track& track) const
 {
+  // position rates of whole group are computed at once
+  CandidatePositions candidates;
+  candidates.reserve(DRs.size());
+  for (const DetectionReport& dr : DRs)
+  {
+    candidates.add(dr);
+  }
+  std::vector<double,Common::ArenaAllocator<double> >
+      positionRates(candidates.size());
+  rateCandidatePositions(candidates,
+                         track.getLongitude(),
+                         track.getLatitude(),
+                         track.getMetersOverSea(),
+                         resultComparator_->getMaximumPositionRate(),
+                         positionRates.data());
+
+  // DRs too far to reach threshold, are not compared by features at all
+  const double positionGate = resultComparator_->gate(DRRateThreshold_);
+
+  // features of Track are compared with features (of the same type)
+  //  of all DRs passing the gate at once
+  feature_grades_t featureGrades;
+  if (featureExtractor_)
+  {
+    std::vector<const Feature*,Common::ArenaAllocator<const Feature*> >
+        DRFeatures(DRs.size());
+    for (std::size_t type = 0; type < Feature::TypesCount; ++type)
+    {
+      const Feature* trackFeature
+          = track.getFeature(static_cast<Feature::Type>(type));
+      if (!trackFeature)
+        continue;
+
+      std::size_t i = 0;
+      for (const DetectionReport& dr : DRs)
+      {
+        const Feature* feature = dr.getFeatures()[type];
+        if (positionRates[i] < positionGate)
+          feature = nullptr;
+        else if (type == Feature::Plate
+                 && feature && !isPlateCandidate(*feature,track))
+          feature = nullptr; // plate too different, found by index
+
+        DRFeatures[i] = feature;
+        ++i;
+      }
+      featureGrades[type].resize(DRs.size());
+      featureExtractor_->compare(*trackFeature,
+                                 DRFeatures.data(),DRFeatures.size(),
+                                 featureGrades[type].data());
+    }
+  }
+
   std::vector<double> rates;
   std::set<DetectionReport> result;
   time_types::ptime_t highestSensorTime; // initialized by epoch time
   auto it = DRs.begin();
   auto endIt = DRs.end();
-  while (it != endIt)
+  for (std::size_t i = 0; it != endIt; ++i)
   {
-    double DRRate = rateDRForTrack(*it, track);
+    if (positionRates[i] < positionGate)
+    {
+      ++it;
+      continue;
+    }
+
+    double DRRate = rateDRForTrack(*it,featureGrades,i,positionRates[i]);
     if (DRRate >= DRRateThreshold_)
     {
       // take item from DRs set and put into result collection
@@ -171,27 +261,87 @@ DataAssociator::rateListForTrack(std::set<DetectionReport>& DRs,const Track& tra
           >(listPair,highestSensorTime);
 }
 
-double DataAssociator::rateDRForTrack(const DetectionReport& dr, const Track& track) const
+void DataAssociator::findPlateCandidates(
+    const std::set<std::shared_ptr<Track> >& tracks)
 {
-  ResultComparator::feature_grade_map_t m;
-  for (Feature* drFeature : dr.getFeatures())
+  plateCandidates_.clear();
+  plateIndex_.clear();
+  plateGroups_.clear();
+  groupsWithoutPlate_.clear();
+  for (const std::shared_ptr<Track>& track : tracks)
   {
-    std::string name = drFeature->getName();
-    Track::features_set_t trackFeatures = track.getFeatures();
-    m[name] = 0;
+    const Feature* plate = track->getFeature(Feature::Plate);
+    if (plate)
+      plateIndex_.add(
+            static_cast<const PlateFeature*>(plate)->getCanonicalPlate(),
+            track.get());
+  }
+  if (plateIndex_.size() == 0)
+    return;
 
-    // TODO can be optimized - linear search vs logarithmic
-    /*for (Feature* feature : trackFeatures) // FIXME see below
+  for (std::size_t g = 0; g < DRGroups_.size(); ++g)
+  {
+    bool hasPlate = false;
+    std::vector<const Track*> groupCandidates;
+    for (const DetectionReport& dr : DRGroups_[g])
     {
-      if (feature->getName() == name)
-      {
-        // FIXME uncomment this, after implementing compare() method
+      const Feature* plate = dr.getFeature(Feature::Plate);
+      if (!plate)
+        continue;
 
-        //double result = featureExtractor->compare(*drFeature,*feature);
-        //m[name] = result; // we assume, that there are only one Feature with given name in set
-      }
-    }*/
+      hasPlate = true;
+      std::vector<const Track*>& candidates = plateCandidates_[plate];
+      plateIndex_.find(
+            static_cast<const PlateFeature*>(plate)->getCanonicalPlate(),
+            candidates);
+      groupCandidates.insert(groupCandidates.end(),
+                             candidates.begin(),candidates.end());
+    }
+
+    if (!hasPlate)
+    {
+      groupsWithoutPlate_.push_back(g);
+      continue;
+    }
+
+    std::sort(groupCandidates.begin(),groupCandidates.end());
+    groupCandidates.erase(std::unique(groupCandidates.begin(),
+                                      groupCandidates.end()),
+                          groupCandidates.end());
+    for (const Track* track : groupCandidates)
+    {
+      plateGroups_[track].push_back(g); // groups are in ascending order
+    }
+  }
+}
+
+bool DataAssociator::isPlateCandidate(const Feature& plate,
+                                      const Track& track) const
+{
+  auto it = plateCandidates_.find(&plate);
+  if (it == plateCandidates_.end())
+    return false;
+
+  return std::find(it->second.begin(),it->second.end(),&track)
+      != it->second.end();
+}
+
+double DataAssociator::rateDRForTrack(const DetectionReport& dr,
+                                      const feature_grades_t& featureGrades,
+                                      std::size_t index,
+                                      double positionRate) const
+{
+  ResultComparator::feature_grade_map_t m;
+  const FeatureTable::row_t& features = dr.getFeatures();
+  for (std::size_t type = 0; type < features.size(); ++type)
+  {
+    if (!features[type]) // DR has no feature of this type
+      continue;
+
+    // 0, when Track has no feature of this type
+    m[features[type]->getName()]
+        = featureGrades[type].empty() ? 0 : featureGrades[type][index];
   }
 
-  return resultComparator_->operator()(m,dr,track);
+  return resultComparator_->combine(m,positionRate);
 }
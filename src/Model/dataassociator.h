@@ -1,13 +1,18 @@
 #ifndef DATAASSOCIATOR_H
 #define DATAASSOCIATOR_H
 
+#include <array>
 #include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
+#include <Common/arena.hpp>
+
 #include "detectionreport.h"
 #include "featureextractor.h"
+#include "platematcher.h"
 #include "resultcomparator.h"
 #include "track.h"
 #include "trackmanager.h"
@@ -102,6 +107,20 @@ public:
   void setDRRateThreshold(double threshold);
 
 private:
+  // temporary set of DRs, allocated from arena of current cycle (if any)
+  typedef std::set<
+    DetectionReport,
+    std::less<DetectionReport>,
+    Common::ArenaAllocator<DetectionReport>
+    > scratch_DRs_t;
+
+  // grades of features of DRs in group, per type of feature
+  //  (empty - Track has no feature of this type)
+  typedef std::array<
+    std::vector<double,Common::ArenaAllocator<double> >,
+    Feature::TypesCount
+    > feature_grades_t;
+
   /**
    * @brief Returns best fit list of DRs for given track.
    *
@@ -124,6 +143,9 @@ private:
    *
    *  DR groups are disjunctive, so we can use rateListForTrack (which removes DRs from set), for them.
    *
+   *  Track with plate is rated only against groups without plates and groups, which have plate
+   *  similar to plate of Track (see findPlateCandidates), other Tracks - against all groups.
+   *
    * @param Track for which we are looking associations for.
    * @return pair of two values: set of matching DRs and highest sensor time from DRs from this set
    * @see rateListForTrack
@@ -134,7 +156,9 @@ private:
   /**
    * @brief Chooses these DRs from neighborhood, which are good enough, to match given track.
    *
-   *  For each DR from list is invoked rateDRForTrack,
+   *  Position rates of all DRs are computed at once (see rateCandidatePositions),
+   *  then features of DRs, which position rate passes the gate of ResultComparator, are compared with Track's features
+   *  (one batch per type of feature) and for each of these DRs is invoked rateDRForTrack,
    *  DRs with rate above threshold, are returned as winning DRs, with rate. Rest are returned also, as "lost"
    * @param Set of DRs to choose from - is modified: each chosen DR is removed from this collection (it reduces complexity of computation, by so called sweeping)
    * @param Track to match DRs to
@@ -142,20 +166,49 @@ private:
    *          the second is highest sensor time from choosen DRs.
    */
   std::pair<std::pair<double,std::set<DetectionReport> >, time_types::ptime_t>
-    rateListForTrack(std::set<DetectionReport>&,const Track&) const;
+    rateListForTrack(scratch_DRs_t&,const Track&) const;
+
+  /**
+   * @brief Builds index of plates of given Tracks and finds, with it,
+   *  candidate Tracks for plate of each DR, once per cycle.
+   *  Plates of DRs are compared later only with these Tracks,
+   *  and groups with plates are rated only for them (and Tracks without plates).
+   * @param Tracks
+   */
+  void findPlateCandidates(const std::set<std::shared_ptr<Track> >&);
+
+  /**
+   * @return true, when plate of DR is similar enough to plate of Track
+   *  (Track was found in index for it)
+   */
+  bool isPlateCandidate(const Feature& plate, const Track& track) const;
 
   /**
    * @brief Returns 0-1 grade for DR, in comparation for Track.
    *  when Track and DR class mismatch occurs (e.g. Track concerns car and DR human), rate = 0
+   * @param DR
+   * @param grades of features of DRs in group, compared with features of Track
+   * @param index of DR in group
+   * @param 0-1 rate of distance between DR and Track
    * @return grade
    */
-  double rateDRForTrack(const DetectionReport&,const Track&) const;
+  double rateDRForTrack(const DetectionReport&,
+                        const feature_grades_t&,std::size_t index,
+                        double positionRate) const;
 
   std::vector<std::set<DetectionReport> > DRGroups_;
   std::map<std::shared_ptr<Track>,std::set<DetectionReport> > associatedDRs_;
   std::unique_ptr<ResultComparator> resultComparator_;
   std::unique_ptr<ListResultComparator> listResultComparator_;
   std::unique_ptr<FeatureExtractor> featureExtractor_;
+
+  // plates of Tracks in current cycle, and Tracks found with it for plates of DRs
+  PlateIndex plateIndex_;
+  std::unordered_map<const Feature*,std::vector<const Track*> >
+    plateCandidates_;
+  // indices of groups with plates, for which Track is candidate
+  std::unordered_map<const Track*,std::vector<std::size_t> > plateGroups_;
+  std::vector<std::size_t> groupsWithoutPlate_;
   std::shared_ptr<TrackManager> trackManager_;
 
   double DRRateThreshold_;
@@ -3,9 +3,16 @@
 #include <chrono>
 #include <memory>
 #include <sstream> // used for logging purpose
+#include <stdexcept>
 #include <thread>
 
+#include <boost/lexical_cast.hpp>
+
 #include <Model/DB/common.h>
+#include <Model/Distributed/remoteshard.h>
+#include <Model/checkpoint.h>
+#include <Model/immfilter.hpp>
+#include <Model/mapcache.h>
 
 #include <Common/configurationmanager.h>
 #include <Common/logger.h>
@@ -41,12 +48,12 @@ DataManager::DataManager(const std::string& paramsPath,
         = std::make_shared<StaticBaseDriver>(options->toString().c_str());
   }
 
+  scheduler_ = createTaskScheduler();
+
   if (filter)
     filter_ = std::move(filter);
   else
-  {
-    initializeKalmanFilter();
-  }
+    filter_ = createFilter();
 
   if (reportManager)
     reportManager_ = std::move(reportManager);
@@ -93,6 +100,8 @@ DataManager::DataManager(const std::string& paramsPath,
                                      5000); // 5000 - ~200m distance
 
     trackManager_ = std::shared_ptr<TrackManager>(new TrackManager(threshold));
+    trackManager_->setFeatureExtractor(
+          std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
   }
 
   if (dataAssociator)
@@ -100,7 +109,7 @@ DataManager::DataManager(const std::string& paramsPath,
   else
   {
     std::unique_ptr<ResultComparator> resultComparator(
-          new OrComparator(ResultComparator::feature_grade_map_t()));
+          new OrComparator(createGradeRates()));
     std::unique_ptr<ListResultComparator> listComparator(
           new OrListComparator());
 
@@ -115,6 +124,8 @@ DataManager::DataManager(const std::string& paramsPath,
                                             std::move(listComparator),
                                             threshold);
     dataAssociator_ = std::unique_ptr<DataAssociator>(da);
+    dataAssociator_->setFeatureExtractor(
+          std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
   }
 
   if (featureExtractor)
@@ -127,7 +138,9 @@ DataManager::DataManager(const std::string& paramsPath,
   if (fusionExecutor)
     fusionExecutor_ = std::move(fusionExecutor);
   else
-    fusionExecutor_ = std::unique_ptr<FusionExecutor>(new FusionExecutor());
+    fusionExecutor_ = createFusionExecutor(scheduler_);
+
+  loadSensorNoises();
 
   if (TTL == time_types::seconds_t(0))
   { // use default value, instead of given
@@ -139,6 +152,61 @@ DataManager::DataManager(const std::string& paramsPath,
   }
   else
     TTL_ = TTL;
+
+  mapCachePath_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","DataManager.MapCache","");
+
+  mapMatchingEnabled_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","MapMatcher.Enabled","false")
+        == "true";
+  mapMatchingDistance_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","MapMatcher.MaximumDistance",
+                                   0.0005); // ~50m
+
+  dormantTTL_ = time_types::duration_t(
+        Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","TrackManager.DormantTTL",0));
+  reacquisitionDistance_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model",
+                                   "TrackManager.ReacquisitionDistance",
+                                   0.0005); // ~50m
+
+  checkpointPath_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","DataManager.Checkpoint","");
+  checkpointInterval_ = time_types::duration_t(
+        Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","DataManager.CheckpointInterval",
+                                   60));
+  lastCheckpointTime_ = time_types::clock_t::now();
+
+  shardColumns_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<unsigned>("Model","ShardedTracker.Columns",1);
+  shardRows_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<unsigned>("Model","ShardedTracker.Rows",1);
+  shardOverlap_
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","ShardedTracker.Overlap",
+                                   0.001); // ~100m
+  const std::string shards
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","Distributed.Shards","");
+  std::stringstream shardsStream(shards);
+  std::string address;
+  while (std::getline(shardsStream,address,','))
+  {
+    if (!address.empty())
+      shardAddresses_.push_back(address);
+  }
+
+  if (!checkpointPath_.empty())
+    restoreCheckpoint();
 }
 
 Snapshot DataManager::computeState(time_types::ptime_t currentTime)
@@ -149,11 +217,33 @@ Snapshot DataManager::computeState(time_types::ptime_t currentTime)
     m << "Computing state with current time = " << currentTime;
     logger.log("DataManager",m.str());
   }
+  compute(); // loops through data flow, to maintain tracking process
+  return takeSnapshot(currentTime);
+}
+
+bool DataManager::processNextPacket()
+{
+  std::set<DetectionReport> DRs = reportManager_->getDRs();
+  if (DRs.empty())
+    return false;
+
+  processPacket(DRs);
+  return true;
+}
+
+time_types::ptime_t DataManager::getModelTime() const
+{
+  return modelTime_;
+}
+
+Snapshot DataManager::takeSnapshot(time_types::ptime_t currentTime)
+{
   auto tracks = computeTracks(TTL_,currentTime);
   // clone Tracks, to ensure safety in multithreaded environment
   Snapshot s = cloneTracksInSnapshot(tracks);
   snapshot_.put(s);
   putTracksSnapshotIntoDB(s);
+  storeCheckpointIfNeeded();
   return s;
 }
 
@@ -165,33 +255,73 @@ Snapshot DataManager::getSnapshot() const
 MapPtr DataManager::getMap()
 {
   // simple caching, without refreshing - read once, store and never refresh
+  if (staticMap_)
+    return staticMap_;
+
+  // fingerprint is read before map - if map changes meanwhile,
+  //  cache is stale at next start
+  MapFingerprint fingerprint = MapFingerprint();
+  if (!mapCachePath_.empty())
+  {
+    fingerprint = staticDbDriver_->getMapFingerprint();
+    staticMap_ = MapCache(mapCachePath_).load(fingerprint);
+  }
+
   if (!staticMap_)
+  {
     staticMap_ = staticDbDriver_->getMap();
+    if (!mapCachePath_.empty()
+        && !MapCache(mapCachePath_).store(staticMap_,fingerprint))
+    {
+      Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+      std::stringstream m;
+      m << "Unable to write map cache to " << mapCachePath_;
+      logger.log("DataManager",m.str());
+    }
+  }
 
   return staticMap_;
 }
 
+void DataManager::matchTracksToMap(
+    const std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& tracks)
+{
+  if (!mapMatcher_) // map is read lazily, only when it's really needed
+    mapMatcher_.reset(new MapMatcher(getMap(),mapMatchingDistance_));
+
+  for (const auto& trackDRs : tracks)
+  {
+    mapMatcher_->matchTrack(*trackDRs.first);
+  }
+}
+
 std::shared_ptr<
       std::set<std::shared_ptr<Track> >
     >
   DataManager::computeTracks(time_types::duration_t TTL,
                              time_types::ptime_t currentTime)
 {
-  compute(); // loops through data flow, to maintain tracking process
-
-  if (currentTime != time_types::ptime_t())
-    trackManager_->removeExpiredTracks(currentTime,TTL);
+  if (shardedTracker_)
+  {
+    if (currentTime != time_types::ptime_t())
+      shardedTracker_->removeExpiredTracks(currentTime,TTL);
+    else
+      shardedTracker_->removeExpiredTracks(TTL);
+  }
   else
-    trackManager_->removeExpiredTracks(TTL);
+  {
+    if (currentTime != time_types::ptime_t())
+      trackManager_->removeExpiredTracks(currentTime,TTL);
+    else
+      trackManager_->removeExpiredTracks(TTL);
+  }
 
   // create new set of Tracks on heap
-  //  and initialize it with tracks from TrackManager
+  //  and initialize it with tracks from TrackManager (or shards)
   std::shared_ptr<
         std::set<std::shared_ptr<Track> >
       > tracks(
-        new std::set<std::shared_ptr<Track> >(
-          trackManager_->getTracks()
-          )
+        new std::set<std::shared_ptr<Track> >(getTracks())
         );
 
   return tracks; // return tracks to Controller/View
@@ -210,57 +340,329 @@ void DataManager::compute()
 
   while (!DRs.empty())
   {
-    alignmentProcessor_->setDRsCollection(DRs);
-    std::set<DetectionReport> alignedGroup
-        = alignmentProcessor_->getNextAlignedGroup();
+    processPacket(DRs);
+    DRs = reportManager_->getDRs(); // get next group
+  }
+}
 
-    while (!alignedGroup.empty())
-    {
-      { // TODO rewrite this, when logger will be more sophisticated
-        std::stringstream msg;
-        msg << "Generated aligned group of " << alignedGroup.size()
-            << " detection reports.";
-        logger.log("DataManager",msg.str());
-      }
+void DataManager::processPacket(const std::set<DetectionReport>& DRs)
+{
+  if (dormantTTL_ > time_types::duration_t::zero()
+      && reacquisitionDistance_ > 0 && !roadMotionModel_)
+  { // map is read lazily, only when it's really needed
+    roadMotionModel_
+        = std::make_shared<RoadMotionModel>(getMap(),mapMatchingDistance_);
+    trackManager_->setRoadMotionModel(roadMotionModel_,dormantTTL_,
+                                      reacquisitionDistance_);
+  }
 
-      std::vector<std::set<DetectionReport> > DRsGroups
-          = candidateSelector_->getMeasurementGroups(alignedGroup);
+  if (shardColumns_*shardRows_ > 1 && !shardedTracker_)
+    createShardedTracker();
 
-      dataAssociator_->setInput(DRsGroups);
-      std::map<std::shared_ptr<Track>,std::set<DetectionReport> > associated
-          = dataAssociator_->getDRsForTracks();
-      { // TODO rewrite this, when logger will be more sophisticated
-        std::stringstream msg;
-        msg << "Associated tracks: " << associated.size();
-        logger.log("DataManager",msg.str());
-      }
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+
+  // released when packet is processed (arena is reused by the next one)
+  Common::ArenaScope arenaScope(cycleArena_);
+
+  alignmentProcessor_->setDRsCollection(DRs);
+  std::set<DetectionReport> alignedGroup
+      = alignmentProcessor_->getNextAlignedGroup();
+
+  while (!alignedGroup.empty())
+  {
+    { // TODO rewrite this, when logger will be more sophisticated
+      std::stringstream msg;
+      msg << "Generated aligned group of " << alignedGroup.size()
+          << " detection reports.";
+      logger.log("DataManager",msg.str());
+    }
+
+    std::vector<std::set<DetectionReport> > DRsGroups
+        = candidateSelector_->getMeasurementGroups(alignedGroup);
+
+    if (shardedTracker_)
+      trackGroupsInShards(DRsGroups);
+    else
+      trackGroups(DRsGroups);
+
+    alignedGroup = alignmentProcessor_->getNextAlignedGroup();
+  }
+
+  // DRs are ordered by sensor time, so the last one is the latest
+  if (!DRs.empty() && modelTime_ < DRs.rbegin()->getSensorTime())
+    modelTime_ = DRs.rbegin()->getSensorTime();
+}
+
+void DataManager::trackGroups(std::vector<std::set<DetectionReport> >& DRsGroups)
+{
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+
+  dataAssociator_->setInput(DRsGroups);
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > associated
+      = dataAssociator_->getDRsForTracks();
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Associated tracks: " << associated.size();
+    logger.log("DataManager",msg.str());
+  }
+
+  std::vector<std::set<DetectionReport> > notAssociated
+      = dataAssociator_->getNotAssociated();
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Not associated groups of DRs: " << notAssociated.size();
+    logger.log("DataManager",msg.str());
+  }
+
+  std::unique_ptr<estimation::EstimationFilter<> > filter(
+        filter_->clone());
+
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > initialized
+      = trackManager_->initializeTracks(notAssociated,std::move(filter));
+  // here we have Tracks:
+  // associated - for these DRs which matched existing Tracks
+  // initialized - for these DRs which didn't match existing Tracks
+  //  (new Tracks were created)
+
+  fusionExecutor_->fuseDRs(associated);
+  fusionExecutor_->fuseDRs(initialized);
+
+  if (mapMatchingEnabled_)
+  {
+    matchTracksToMap(associated);
+    matchTracksToMap(initialized);
+  }
+}
+
+void DataManager::trackGroupsInShards(
+    const std::vector<std::set<DetectionReport> >& DRsGroups)
+{
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > updated
+      = shardedTracker_->process(DRsGroups,*filter_);
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Updated tracks (in all shards): " << updated.size();
+    Common::GlobalLogger::getInstance().log("DataManager",msg.str());
+  }
+
+  // Tracks of remote shards are copies - matching them would change nothing
+  if (mapMatchingEnabled_ && shardAddresses_.empty())
+    matchTracksToMap(updated);
+}
+
+void DataManager::createShardedTracker()
+{
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
 
-      std::vector<std::set<DetectionReport> > notAssociated
-          = dataAssociator_->getNotAssociated();
+  // map is read lazily, only when it's really needed
+  const Bounds area = Bounds::ofMap(getMap());
+
+  if (!shardAddresses_.empty()
+      && shardAddresses_.size() != shardColumns_*shardRows_)
+  {
+    { // TODO rewrite this, when logger will be more sophisticated
+      std::stringstream msg;
+      msg << "Number of remote shards (" << shardAddresses_.size()
+          << ") doesn't match number of tiles (" << shardColumns_*shardRows_
+          << "), using local shards.";
+      logger.log("DataManager",msg.str());
+    }
+    shardAddresses_.clear();
+  }
+
+  if (!shardAddresses_.empty())
+  {
+    const std::vector<std::string> addresses = shardAddresses_;
+    const estimation::EstimationFilter<>& filter = *filter_;
+    ShardedTracker::shard_creator_t creator
+        = [&addresses,&filter](const Bounds& tile, std::size_t index)
+    {
+      const std::string& address = addresses[index];
+      const std::size_t colon = address.rfind(':');
+      if (colon == std::string::npos)
+        throw std::invalid_argument("Invalid shard address: " + address);
+
+      const unsigned short port
+          = boost::lexical_cast<unsigned short>(address.substr(colon+1));
+      return std::unique_ptr<Shard>(
+            new Distributed::RemoteShard(tile,address.substr(0,colon),port,
+                                         filter.clone()));
+    };
+
+    try
+    {
+      shardedTracker_.reset(new ShardedTracker(area,shardColumns_,shardRows_,
+                                               shardOverlap_,creator));
+    }
+    catch (const std::exception& e)
+    {
       { // TODO rewrite this, when logger will be more sophisticated
         std::stringstream msg;
-        msg << "Not associated groups of DRs: " << notAssociated.size();
+        msg << "Unable to connect remote shards (" << e.what()
+            << "), using local shards.";
         logger.log("DataManager",msg.str());
       }
+      shardAddresses_.clear();
+    }
+  }
 
-      std::unique_ptr<estimation::EstimationFilter<> > filter(
-            filter_->clone());
+  if (!shardedTracker_)
+    shardedTracker_.reset(new ShardedTracker(area,shardColumns_,shardRows_,
+                                             shardOverlap_,
+                                             createShardFactory(sensorNoises_)));
 
-      std::map<std::shared_ptr<Track>,std::set<DetectionReport> > initialized
-          = trackManager_->initializeTracks(notAssociated,std::move(filter));
-      // here we have Tracks:
-      // associated - for these DRs which matched existing Tracks
-      // initialized - for these DRs which didn't match existing Tracks
-      //  (new Tracks were created)
+  // Tracks restored from checkpoint are moved to shards
+  shardedTracker_->restoreTracks(trackManager_->getTracks());
+  trackManager_->restoreTracks(std::set<std::shared_ptr<Track> >());
 
-      fusionExecutor_->fuseDRs(associated);
-      fusionExecutor_->fuseDRs(initialized);
+  if (roadMotionModel_)
+    shardedTracker_->setRoadMotionModel(roadMotionModel_,dormantTTL_,
+                                        reacquisitionDistance_);
+}
 
-      alignedGroup = alignmentProcessor_->getNextAlignedGroup();
+void DataManager::loadSensorNoises()
+{
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+  std::vector<DB::DynDBDriver::SensorNoise_row> rows;
+  try
+  {
+    rows = dynDbDriver_->getSensorNoises();
+  }
+  catch (const std::exception& e)
+  {
+    { // TODO rewrite this, when logger will be more sophisticated
+      std::stringstream msg;
+      msg << "Unable to load noises of sensors (" << e.what()
+          << "), using noise of filter.";
+      logger.log("DataManager",msg.str());
     }
+    return;
+  }
 
-    DRs = reportManager_->getDRs(); // get next group
+  std::shared_ptr<SensorNoiseTable> noises
+      = std::make_shared<SensorNoiseTable>();
+  for (const DB::DynDBDriver::SensorNoise_row& row : rows)
+  {
+    noises->set(row.sensor_id,row.position_variance,row.mos_variance);
+  }
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Loaded noises of " << noises->size() << " sensors.";
+    logger.log("DataManager",msg.str());
   }
+
+  sensorNoises_ = noises;
+  trackManager_->setSensorNoiseTable(sensorNoises_);
+  fusionExecutor_->setSensorNoiseTable(sensorNoises_);
+}
+
+std::shared_ptr<Common::TaskScheduler> DataManager::createTaskScheduler()
+{
+  const unsigned threads
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<unsigned>("Model","TaskScheduler.Threads",0);
+  const bool pinThreads
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","TaskScheduler.PinThreads",
+                                        "false")
+        == "true";
+
+  return std::make_shared<Common::TaskScheduler>(threads,pinThreads);
+}
+
+std::unique_ptr<FusionExecutor> DataManager::createFusionExecutor(
+    std::shared_ptr<Common::TaskScheduler> scheduler)
+{
+  const bool combineDRs
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","FusionExecutor.CombineDRs",
+                                        "false")
+        == "true";
+  const bool parallel
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","FusionExecutor.Parallel",
+                                        "false")
+        == "true";
+
+  if (scheduler && parallel)
+    return std::unique_ptr<FusionExecutor>(
+          new ParallelFusionExecutor(scheduler,
+                                     ParallelFusionExecutor::DefaultChunkSize,
+                                     combineDRs));
+
+  return std::unique_ptr<FusionExecutor>(new FusionExecutor(combineDRs));
+}
+
+ShardedTracker::ShardFactory DataManager::createShardFactory(
+    std::shared_ptr<const SensorNoiseTable> sensorNoises)
+{
+  const double initializationThreshold
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model",
+                                   "TrackManager.InitializationThreshold",
+                                   5000);
+  const double associationThreshold
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","DataAssociator.Threshold",0.3);
+
+  const ResultComparator::feature_grade_map_t gradeRates = createGradeRates();
+
+  ShardedTracker::ShardFactory factory;
+  factory.trackManager = [initializationThreshold,sensorNoises]
+  {
+    std::shared_ptr<TrackManager> trackManager
+        = std::make_shared<TrackManager>(initializationThreshold);
+    trackManager->setFeatureExtractor(
+          std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
+    trackManager->setSensorNoiseTable(sensorNoises);
+    return trackManager;
+  };
+  factory.dataAssociator = [associationThreshold,gradeRates]
+      (std::shared_ptr<TrackManager> trackManager)
+  {
+    std::unique_ptr<DataAssociator> dataAssociator(
+          new DataAssociator(trackManager,
+                             std::unique_ptr<ResultComparator>(
+                               new OrComparator(gradeRates)),
+                             std::unique_ptr<ListResultComparator>(
+                               new OrListComparator()),
+                             associationThreshold));
+    dataAssociator->setFeatureExtractor(
+          std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
+    return dataAssociator;
+  };
+  factory.fusionExecutor = [sensorNoises]
+  {
+    // shards run in parallel already
+    std::unique_ptr<FusionExecutor> fusionExecutor = createFusionExecutor();
+    fusionExecutor->setSensorNoiseTable(sensorNoises);
+    return fusionExecutor;
+  };
+
+  return factory;
+}
+
+ResultComparator::feature_grade_map_t DataManager::createGradeRates()
+{
+  ResultComparator::feature_grade_map_t gradeRates;
+  gradeRates[PlateFeature().getName()]
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model",
+                                   "ResultComparator.PlateGradeRate",
+                                   1.0);
+  gradeRates[ColorFeature().getName()]
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model",
+                                   "ResultComparator.ColorGradeRate",
+                                   0.5);
+  return gradeRates;
+}
+
+std::set<std::shared_ptr<Track> > DataManager::getTracks() const
+{
+  if (shardedTracker_)
+    return shardedTracker_->getTracks();
+  return trackManager_->getTracks();
 }
 
 Snapshot DataManager::cloneTracksInSnapshot(std::shared_ptr<
@@ -271,85 +673,123 @@ Snapshot DataManager::cloneTracksInSnapshot(std::shared_ptr<
       std::set<std::unique_ptr<Track> >
       > result(new std::set<std::unique_ptr<Track> >());
   const std::set<std::shared_ptr<Track> >& s = *tracks;
-  for (auto t : s)
-  { // for each track from set
-    result->insert(t->clone());
+  std::vector<const Track*> originals;
+  originals.reserve(s.size());
+  for (const std::shared_ptr<Track>& t : s)
+  {
+    originals.push_back(t.get());
+  }
+
+  // tracks are cloned in parallel, set is filled serially
+  std::vector<std::unique_ptr<Track> > clones(originals.size());
+  scheduler_->parallelFor(0,originals.size(),64,
+                          [&originals,&clones](std::size_t begin,
+                                               std::size_t end)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      clones[i] = originals[i]->clone();
+    }
+  });
+  for (std::unique_ptr<Track>& clone : clones)
+  {
+    result->insert(std::move(clone));
   }
   return result;
 }
 
-void DataManager::initializeKalmanFilter()
+std::unique_ptr<estimation::EstimationFilter<> >
+  DataManager::createKalmanFilter()
 {
-  estimation::KalmanFilter<>::Matrix A(4,4);
+  // state: lon, lat, mos, lonVelocity, latVelocity, mosVelocity
+  const std::size_t axes = 3;
+
+  // transition for time step 1 - filter scales it by time passed
+  //  between measurements (predictFor(timeStep))
+  estimation::KalmanFilter<>::Matrix A(2*axes,2*axes);
   /*
-   * 1 0 1 0
-   * 0 1 0 1
-   * 0 0 1 0
-   * 0 0 0 1
+   * 1 0 0 1 0 0
+   * 0 1 0 0 1 0
+   * 0 0 1 0 0 1
+   * 0 0 0 1 0 0
+   * 0 0 0 0 1 0
+   * 0 0 0 0 0 1
    */
-  A.clear();
-  A(0,0) = 1;
-  A(0,1) = 0;
-  A(0,2) = 1;
-  A(0,3) = 0;
-
-  A(1,0) = 0;
-  A(1,1) = 1;
-  A(1,2) = 0;
-  A(1,3) = 1;
-
-  A(2,0) = 0;
-  A(2,1) = 0;
-  A(2,2) = 1;
-  A(2,3) = 0;
-
-  A(3,0) = 0;
-  A(3,1) = 0;
-  A(3,2) = 0;
-  A(3,3) = 1;
+  A = ublas::identity_matrix<double>(2*axes);
+  for (std::size_t i = 0; i < axes; ++i)
+  {
+    A(i,axes+i) = 1;
+  }
 
   estimation::KalmanFilter<>::Matrix B;
   B.clear();
 
-  estimation::KalmanFilter<>::Matrix R(2,2);
+  estimation::KalmanFilter<>::Matrix R(axes,axes);
   /*
-   * 100 0.00000
-   * 0.00000 100
+   * 0.001 0.000 0.000
+   * 0.000 0.001 0.000
+   * 0.000 0.000 0.001
    */
-  R.clear();
-  R(0,0) = 0.001;
-  R(1,1) = 0.001;
+  R = 0.001*ublas::identity_matrix<double>(axes);
 
-  estimation::KalmanFilter<>::Matrix Q(4,4);
+  estimation::KalmanFilter<>::Matrix Q(2*axes,2*axes);
   /*
-   * 0.01 0.00 0.00 0.00
-   * 0.00 0.01 0.00 0.00
-   * 0.00 0.00 0.01 0.00
-   * 0.00 0.00 0.00 0.01
+   * 0.001 on diagonal - velocity noise gives spectral density
+   *  of acceleration noise, Q(dt) is built by filter in closed form
    */
-  Q.clear();
-  Q(0,0) = 0.001;
-  Q(1,1) = 0.001;
-  Q(2,2) = 0.001;
-  Q(3,3) = 0.001;
+  Q = 0.001*ublas::identity_matrix<double>(2*axes);
 
-  estimation::KalmanFilter<>::Matrix H(2,4);
+  estimation::KalmanFilter<>::Matrix H(axes,2*axes);
   /*
-   * 1 0 1 0
-   * 0 1 0 1
+   * 1 0 0 0 0 0
+   * 0 1 0 0 0 0
+   * 0 0 1 0 0 0
    */
   H.clear();
-  H(0,0) = 1;
-  H(0,1) = 0;
-  H(0,2) = 1;
-  H(0,3) = 0;
-  H(1,0) = 0;
-  H(1,1) = 1;
-  H(1,2) = 0;
-  H(1,3) = 1;
-
-  filter_ = std::unique_ptr<estimation::KalmanFilter<> >(
+  for (std::size_t i = 0; i < axes; ++i)
+  {
+    H(i,i) = 1;
+  }
+
+  std::unique_ptr<estimation::KalmanFilter<> > filter(
         new estimation::KalmanFilter<>(A,B,R,Q,H));
+  filter->setSteadyStateTolerance(
+        Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model","DataManager.SteadyStateTolerance",
+                                   0));
+  filter->setSteadyTimeStepTolerance(
+        Common::Configuration::ConfigurationManager
+          ::getCastedValue<double>("Model",
+                                   "DataManager.SteadyTimeStepTolerance",
+                                   0.01));
+
+  return std::unique_ptr<estimation::EstimationFilter<> >(std::move(filter));
+}
+
+std::unique_ptr<estimation::EstimationFilter<> > DataManager::createFilter()
+{
+  const std::string filter
+      = Common::Configuration::ConfigurationManager
+          ::getCastedValue<std::string>("Model","DataManager.Filter","Kalman");
+  if (filter == "IMM")
+  {
+    // the same noises as of Kalman filter
+    estimation::IMMFilter<>::Parameters parameters;
+    parameters.measurementNoise = 0.001;
+    parameters.velocityNoise = 0.001;
+    parameters.accelerationNoise = 0.001;
+    parameters.turnNoise = 0.001;
+    return std::unique_ptr<estimation::EstimationFilter<> >(
+          new estimation::IMMFilter<>(parameters));
+  }
+
+  if (filter != "Kalman")
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Unknown filter " << filter << ", Kalman filter is used";
+    Common::GlobalLogger::getInstance().log("DataManager",msg.str());
+  }
+  return createKalmanFilter();
 }
 
 void DataManager::putTracksSnapshotIntoDB(const Snapshot& snapshot)
@@ -376,4 +816,73 @@ void DataManager::putTracksSnapshotIntoDB(const Snapshot& snapshot)
   tracksSnapshot.storeTracks();
 }
 
+void DataManager::storeCheckpointIfNeeded()
+{
+  if (checkpointPath_.empty())
+    return;
+
+  const time_types::ptime_t now = time_types::clock_t::now();
+  if (now - lastCheckpointTime_ < checkpointInterval_)
+    return;
+  lastCheckpointTime_ = now;
+
+  TrackerState state;
+  const std::set<std::shared_ptr<Track> > tracks = getTracks();
+  state.tracks.reserve(tracks.size());
+  for (const std::shared_ptr<Track>& track : tracks)
+  {
+    state.tracks.push_back(track->getState());
+  }
+  state.cursor = reportManager_->getCursor();
+  state.modelTime = modelTime_.time_since_epoch().count();
+
+  if (!Checkpoint(checkpointPath_).store(state))
+  {
+    Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+    std::stringstream m;
+    m << "Unable to write checkpoint to " << checkpointPath_;
+    logger.log("DataManager",m.str());
+  }
+}
+
+void DataManager::restoreCheckpoint()
+{
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+
+  TrackerState state;
+  if (!Checkpoint(checkpointPath_).load(state))
+  {
+    logger.log("DataManager",
+               "No valid checkpoint found, starting from scratch.");
+    return;
+  }
+
+  std::set<std::shared_ptr<Track> > tracks;
+  try
+  {
+    for (const Track::State& trackState : state.tracks)
+    {
+      tracks.insert(std::make_shared<Track>(filter_->clone(),trackState));
+    }
+  }
+  catch (const std::invalid_argument& /*ex*/)
+  { // filter was changed since checkpoint was written
+    logger.log("DataManager","Checkpoint doesn't fit current filter, "
+                             "starting from scratch.");
+    return;
+  }
+
+  trackManager_->restoreTracks(tracks);
+  reportManager_->restoreCursor(state.cursor);
+  modelTime_ = time_types::ptime_t(
+        time_types::clock_t::duration(state.modelTime));
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Restored " << tracks.size() << " track(s) from checkpoint, "
+        << "resuming after DR " << state.cursor.drId << ".";
+    logger.log("DataManager",msg.str());
+  }
+}
+
 } // namespace Model
@@ -3,8 +3,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <Common/arena.hpp>
 #include <Common/logger.h>
+#include <Common/taskscheduler.h>
 #include <Common/threadbuffer.hpp>
 
 #include <Model/model.h>
@@ -17,6 +20,10 @@
 #include <Model/trackmanager.h>
 #include <Model/featureextractor.h>
 #include <Model/fusionexecutor.h>
+#include <Model/mapmatcher.h>
+#include <Model/parallelfusionexecutor.h>
+#include <Model/sensornoisetable.h>
+#include <Model/shardedtracker.h>
 
 #include <3rdparty/StaticBaseDriver.h>
 
@@ -70,10 +77,59 @@ public:
   virtual Snapshot computeState(time_types::ptime_t currentTime
                                   = time_types::ptime_t());
 
+  virtual bool processNextPacket();
+
+  virtual time_types::ptime_t getModelTime() const;
+
+  virtual Snapshot takeSnapshot(time_types::ptime_t currentTime
+                                  = time_types::ptime_t());
+
   virtual Snapshot getSnapshot() const;
 
   virtual MapPtr getMap();
 
+  /**
+   * @return default Kalman filter (constant velocity model)
+   */
+  static std::unique_ptr<estimation::EstimationFilter<> > createKalmanFilter();
+
+  /**
+   * @return filter chosen by Model.DataManager.Filter key:
+   *  Kalman filter or IMM filter (maneuvering vehicles)
+   */
+  static std::unique_ptr<estimation::EstimationFilter<> > createFilter();
+
+  /**
+   * @return pool of threads shared by parallel stages of tracking,
+   *  sized by Model.TaskScheduler.Threads
+   */
+  static std::shared_ptr<Common::TaskScheduler> createTaskScheduler();
+
+  /**
+   * @return FusionExecutor, which combines DRs of Track before correction,
+   *  when Model.FusionExecutor.CombineDRs is true
+   * @param scheduler fusing Tracks in parallel, when
+   *  Model.FusionExecutor.Parallel is true (nullptr - Tracks are fused
+   *  serially, e.g. in shards, which already run in parallel)
+   */
+  static std::unique_ptr<FusionExecutor>
+    createFusionExecutor(std::shared_ptr<Common::TaskScheduler> scheduler
+                           = nullptr);
+
+  /**
+   * @return factory of local shards' components, configured
+   *  by the same keys as components of DataManager
+   * @param noises of sensors, shared by all shards
+   *  (nullptr - filters' own noise is used)
+   */
+  static ShardedTracker::ShardFactory createShardFactory(
+      std::shared_ptr<const SensorNoiseTable> sensorNoises = nullptr);
+
+  /**
+   * @return weights of features in DR->Track similarity, from configuration
+   */
+  static ResultComparator::feature_grade_map_t createGradeRates();
+
 private:
   /**
    * @brief Executes one full step of tracking process,
@@ -92,14 +148,60 @@ private:
 
   void compute();
 
+  /**
+   * @brief Runs given packet of DRs through whole tracking process.
+   */
+  void processPacket(const std::set<DetectionReport>& DRs);
+
+  /**
+   * @brief Associates groups of DRs with Tracks, initializes new Tracks
+   *  and fuses DRs into Tracks (single TrackManager).
+   */
+  void trackGroups(std::vector<std::set<DetectionReport> >& DRsGroups);
+
+  /**
+   * @brief The same as trackGroups(), but in parallel, by ShardedTracker.
+   */
+  void trackGroupsInShards(
+      const std::vector<std::set<DetectionReport> >& DRsGroups);
+
+  void createShardedTracker();
+
+  /**
+   * @brief Loads noises of sensors from DB (once) and passes them
+   *  to TrackManager and FusionExecutor.
+   */
+  void loadSensorNoises();
+
+  /**
+   * @return Tracks of TrackManager, or of all shards in sharded mode
+   */
+  std::set<std::shared_ptr<Track> > getTracks() const;
+
   Snapshot cloneTracksInSnapshot(std::shared_ptr<
                                      std::set<std::shared_ptr<Track> >
                                   > tracks) const;
 
-  void initializeKalmanFilter();
+  /**
+   * @brief Snaps given (just updated) Tracks onto streets from static map.
+   */
+  void matchTracksToMap(
+      const std::map<std::shared_ptr<Track>,std::set<DetectionReport> >&);
 
   void putTracksSnapshotIntoDB(const Snapshot&);
 
+  /**
+   * @brief Stores state of tracking process, if checkpoint interval passed
+   *  since the last checkpoint.
+   */
+  void storeCheckpointIfNeeded();
+
+  /**
+   * @brief Restores Tracks and position in stream of DRs from checkpoint,
+   *  if checkpoint exists.
+   */
+  void restoreCheckpoint();
+
   /* after C++11's std::atomic_load<std::shared_ptr> will be implemented
    * we will use lock-free implementation, based on it,
    * instead of mutexed buffer, to return Snapshot.
@@ -108,6 +210,7 @@ private:
 
   std::shared_ptr<DB::DynDBDriver> dynDbDriver_;
   std::shared_ptr<StaticBaseDriver> staticDbDriver_;
+  std::shared_ptr<Common::TaskScheduler> scheduler_;
   std::unique_ptr<ReportManager> reportManager_;
   std::unique_ptr<AlignmentProcessor> alignmentProcessor_;
   std::unique_ptr<CandidateSelector> candidateSelector_;
@@ -116,10 +219,34 @@ private:
   std::unique_ptr<FeatureExtractor> featureExtractor_;
   std::unique_ptr<FusionExecutor> fusionExecutor_;
   std::unique_ptr<estimation::EstimationFilter<> > filter_;
+  std::shared_ptr<const SensorNoiseTable> sensorNoises_; // nullptr - unknown
 
   time_types::duration_t TTL_;
+  time_types::ptime_t modelTime_; // sensor time of the latest processed DR
+
+  // temporaries of tracking stages, freed at once after each packet
+  Common::Arena cycleArena_;
 
   MapPtr staticMap_;
+  std::string mapCachePath_; // empty - cache disabled
+
+  bool mapMatchingEnabled_;
+  double mapMatchingDistance_;
+  std::unique_ptr<MapMatcher> mapMatcher_;
+
+  std::string checkpointPath_; // empty - checkpoints disabled
+  time_types::duration_t checkpointInterval_; // wall clock time
+  time_types::ptime_t lastCheckpointTime_;
+
+  unsigned shardColumns_; // 1x1 - sharding disabled
+  unsigned shardRows_;
+  double shardOverlap_;
+  std::vector<std::string> shardAddresses_; // host:port, empty - local shards
+  std::unique_ptr<ShardedTracker> shardedTracker_;
+
+  time_types::duration_t dormantTTL_; // zero - dormant Tracks disabled
+  double reacquisitionDistance_;
+  std::shared_ptr<const RoadMotionModel> roadMotionModel_;
 };
 
 } // namespace Model
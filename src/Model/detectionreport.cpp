@@ -1,32 +1,36 @@
 #include "detectionreport.h"
 
 #include <ctime>
+#include <type_traits>
 
-#include "feature.h"
+static_assert(sizeof(DetectionReport) <= 64,
+              "DetectionReport should fit in cache line");
+static_assert(std::is_trivially_copyable<DetectionReport>::value,
+              "DetectionReport should be trivially copyable");
 
-DetectionReport::DetectionReport(const DB::DynDBDriver::DR_row& dr_row, const features_set_t& features)
-  : features(features),
-    sensor_id(dr_row.sensor_id),
+DetectionReport::DetectionReport(const DB::DynDBDriver::DR_row& dr_row, const FeatureTable::row_t* features)
+  : sensor_id(dr_row.sensor_id),
     dr_id(dr_row.dr_id),
     lon(dr_row.lon),
     lat(dr_row.lat),
     mos(dr_row.mos),
     uploadTime(dr_row.upload_time),
     sensorTime(dr_row.sensor_time),
-    sensor(dr_row.sensor)
+    sensor(dr_row.sensor),
+    features(features)
 {}
 
 DetectionReport::DetectionReport(int sensor_id, int dr_id, double lon, double lat, double mos,
-                                 time_t upload_time, time_t sensor_time, Sensor* sensor, const features_set_t& features)
-  : features(features),
-    sensor_id(sensor_id),
+                                 time_t upload_time, time_t sensor_time, Sensor* sensor, const FeatureTable::row_t* features)
+  : sensor_id(sensor_id),
     dr_id(dr_id),
     lon(lon),
     lat(lat),
     mos(mos),
     uploadTime(upload_time),
     sensorTime(sensor_time),
-    sensor(sensor)
+    sensor(sensor),
+    features(features)
 {}
 
 int DetectionReport::getSensorId() const
@@ -64,6 +68,11 @@ time_types::ptime_t DetectionReport::getSensorTime() const
   return time_types::clock_t::from_time_t(sensorTime);
 }
 
+time_t DetectionReport::getRawUploadTime() const
+{
+  return uploadTime;
+}
+
 time_t DetectionReport::getRawSensorTime() const
 {
   return sensorTime;
@@ -74,29 +83,25 @@ Sensor* DetectionReport::getSensor() const
   return sensor;
 }
 
-DetectionReport::features_set_t DetectionReport::getFeatures() const
+const FeatureTable::row_t& DetectionReport::getFeatures() const
 {
-  return features;
+  if (features)
+    return *features;
+  return FeatureTable::emptyRow();
 }
 
-DetectionReport::features_set_t& DetectionReport::getFeaturesRef()
+const Feature* DetectionReport::getFeature(Feature::Type type) const
 {
-  return features;
+  if (!features || type >= Feature::TypesCount)
+    return nullptr;
+  return (*features)[type];
 }
 
-Feature* DetectionReport::getFeatureOfGivenName(const std::string& name) const
+const Feature* DetectionReport::getFeatureOfGivenName(const std::string& name) const
 {
-  // TODO can be optimized (linear vs logarithmic search)
-  for (auto& feature : features)
-  {
-    if (feature->getName() == name)
-      return feature;
-  }
-
-  return nullptr;
+  return getFeature(Feature::typeOfName(name));
 }
 
-
 bool DetectionReport::operator==(const DetectionReport& o) const
 {
   return (getSensorTime() == o.getSensorTime())
@@ -3,24 +3,29 @@
 
 #include <ctime>
 #include <iostream>
-#include <unordered_set>
 
 #include <Common/time.h>
 #include "DB/dyndbdriver.h"
+#include "featuretable.h"
 
-class Feature;
 class Sensor;
 
+/**
+ * @brief Single detection of object by sensor.
+ *
+ * DR is compact (at most 64 bytes) and trivially copyable, because it's
+ * copied a lot (sets, groups, pairs). It's features are not stored
+ * in DR, but in FeatureTable of the current cycle - DR only points
+ * to it's row there.
+ */
 class DetectionReport
 {
 public:
-  typedef std::unordered_set<Feature*> features_set_t;
-
   DetectionReport(const DB::DynDBDriver::DR_row&,
-                  const features_set_t& features = features_set_t());
+                  const FeatureTable::row_t* features = nullptr);
   DetectionReport(int sensor_id, int dr_id, double lon, double lat, double mos,
                   time_t upload_time, time_t sensor_time, Sensor* sensor = nullptr,
-                  const features_set_t& features = features_set_t());
+                  const FeatureTable::row_t* features = nullptr);
 
   int getSensorId() const;
   int getDrId() const;
@@ -29,18 +34,23 @@ public:
   double getMetersOverSea() const;
   time_types::ptime_t getUploadTime() const;
   time_types::ptime_t getSensorTime() const;
+  time_t getRawUploadTime() const;
   time_t getRawSensorTime() const;
   Sensor* getSensor() const;
 
-  features_set_t getFeatures() const;
-  features_set_t& getFeaturesRef();
+  /**
+   * @return features indexed by Feature::Type (nullptr - no such feature)
+   */
+  const FeatureTable::row_t& getFeatures() const;
 
-  Feature* getFeatureOfGivenName(const std::string& name) const;
+  /**
+   * @return feature of given type or nullptr, in O(1)
+   */
+  const Feature* getFeature(Feature::Type type) const;
 
-  bool operator==(const DetectionReport& o) const;
+  const Feature* getFeatureOfGivenName(const std::string& name) const;
 
-protected:
-  features_set_t features;
+  bool operator==(const DetectionReport& o) const;
 
 private:
   int sensor_id;
@@ -51,6 +61,7 @@ private:
   std::time_t uploadTime;
   std::time_t sensorTime;
   Sensor* sensor;
+  const FeatureTable::row_t* features; // nullptr - no features
 };
 
 std::ostream& operator<<(std::ostream&, const DetectionReport&);
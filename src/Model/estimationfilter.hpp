@@ -1,7 +1,10 @@
 #ifndef ESTIMATIONFILTER_H
 #define ESTIMATIONFILTER_H
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <vector>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/lu.hpp>
 #include <boost/numeric/ublas/vector.hpp>
@@ -11,13 +14,26 @@ namespace ublas = boost::numeric::ublas;
 namespace estimation
 {
 
+/**
+ * @brief State layout: longitude, latitude, their velocities.
+ */
 struct PositionAndVelocityModel
 {
   typedef double values_type;
   enum { Dimensions = 4 };
 };
 
-template <class StateModel = PositionAndVelocityModel>
+/**
+ * @brief State layout: longitude, latitude, meters over sea,
+ *  then their velocities (in the same order).
+ */
+struct PositionAndVelocity3DModel
+{
+  typedef double values_type;
+  enum { Dimensions = 6 };
+};
+
+template <class StateModel = PositionAndVelocity3DModel>
 class EstimationFilter
 {
 public:
@@ -35,6 +51,18 @@ public:
    */
   virtual std::pair<vector_t,vector_t> predict(const vector_t* u = nullptr) = 0;
 
+  /**
+   * @brief predicts state of modeled phenomenon after given time
+   *  (since the last correction), e.g. when measurements come
+   *  in irregular intervals
+   * @param timeStep - in the same units as velocities of state
+   *  (predict() is the same as predictFor(1), predictFor(0) - prediction
+   *  to the same instant, e.g. for simultaneous measurements)
+   * @return pair of predicted state and prediction variance, as vectors
+   */
+  virtual std::pair<vector_t,vector_t>
+    predictFor(typename StateModel::values_type timeStep) = 0;
+
   /**
    * @brief corrects prediction of modeled phenomenon state,
    *  basing on given measurements
@@ -43,6 +71,21 @@ public:
    */
   virtual std::pair<vector_t,vector_t> correct(const vector_t& z) = 0;
 
+  /**
+   * @brief corrects prediction with measurements of given noise
+   *  (e.g. of sensor, which reported them), instead of filter's own one
+   * @param z - measurements vector
+   * @param measurementVariance - variance of each measurement in z
+   *  (measurements are independent)
+   * @param noiseClass - measurements with equal variances share class
+   *  (> 0), so filter may reuse computations made for them;
+   *  negative - variances are unique (nothing is reused)
+   * @return pair of corrected state and it's variance, as vectors
+   */
+  virtual std::pair<vector_t,vector_t>
+    correct(const vector_t& z, const vector_t& measurementVariance,
+            int noiseClass) = 0;
+
   /**
    * @brief Initializes estimation filter with given vector of state
    *  and given variance for this state
@@ -56,6 +99,33 @@ public:
     initialize(vector_t /*state*/, vector_t /*varianceError*/)
   {}
 
+  /**
+   * @brief Constrains last prediction, to satisfy D*x = d
+   *  (e.g. to keep position and velocity along the street).
+   * @param D - constraints, each element is one row of constraints matrix
+   * @param d - constraints values, one per row of D
+   * @return pair of constrained prediction and it's variance, as vectors
+   */
+  virtual std::pair<vector_t,vector_t>
+    constrainPrediction(const std::vector<vector_t>& D,
+                        const std::vector<typename StateModel::values_type>& d)
+      = 0;
+
+  /**
+   * @brief Returns internal state of filter (estimates and their covariances)
+   *  as flat collection of values, e.g. to store it in checkpoint.
+   *  Models (transition, noises etc.) are not included.
+   */
+  virtual std::vector<typename StateModel::values_type> exportState() const = 0;
+
+  /**
+   * @brief Restores internal state, returned by exportState(),
+   *  into filter with the same models.
+   * @return false if given state doesn't fit this filter
+   */
+  virtual bool
+    importState(const std::vector<typename StateModel::values_type>&) = 0;
+
   virtual std::unique_ptr<EstimationFilter<StateModel> > clone() const = 0;
 };
 
@@ -66,8 +136,11 @@ public:
  *  kf.predict(); // returns predicted state
  *  kf.correct(measurement);
  *  kf.predict(); // and so on...
+ *
+ * When measurements come in irregular intervals, use predictFor(timeStep)
+ *  before each correct() instead.
  */
-template <class StateModel = PositionAndVelocityModel>
+template <class StateModel = PositionAndVelocity3DModel>
 class KalmanFilter : public EstimationFilter<StateModel>
 {
 public:
@@ -82,8 +155,16 @@ public:
       controlModel(B),
       measurementNoise(R),
       processNoise(Q),
-      measurementModel(H)
-  {}
+      measurementModel(H),
+      measurementNoiseClass(0),
+      lastTimeStep(1),
+      predictionConstrained(false),
+      steadyStateTolerance(0),
+      steadyTimeStepTolerance(0)
+  {
+    findNoiseAxes();
+    resetSteadyState();
+  }
 
   KalmanFilter(Vector ps, // predictedState
                Vector cs, // correctedState
@@ -103,8 +184,16 @@ public:
       controlModel(B),
       measurementNoise(R),
       processNoise(Q),
-      measurementModel(H)
-  {}
+      measurementModel(H),
+      measurementNoiseClass(0),
+      lastTimeStep(1),
+      predictionConstrained(false),
+      steadyStateTolerance(0),
+      steadyTimeStepTolerance(0)
+  {
+    findNoiseAxes();
+    resetSteadyState();
+  }
 
   virtual ~KalmanFilter()
   {}
@@ -112,15 +201,7 @@ public:
   virtual std::pair<vector_t,vector_t> predict(const vector_t* u = nullptr)
   {
     assert(initialized);
-    // predictedState (x')
-    //  = transitionModel (A) * correctedState (x) + controlModel (B) * u
-    predictedState = ublas::prod(transitionModel,correctedState);
-    // predictedCovarianceError (P')
-    //  = transitionModel (A) * correctedCovarianceError (P)
-    //    * transposed (transitionModel (A)) + processNoise (Q)
-    Matrix transposedTrModel = ublas::trans(transitionModel);
-    Matrix mult = ublas::prod(correctedCovarianceError,transposedTrModel);
-    predictedCovarianceError = ublas::prod(transitionModel,mult) + processNoise;
+    predictWith(1);
 
     if (u != nullptr)
       predictedState += ublas::prod(controlModel,arrayToUblas(*u,controlModel.size2()));
@@ -131,38 +212,47 @@ public:
           );
   }
 
-  virtual std::pair<vector_t,vector_t> correct(const vector_t& z)
+  /*
+   * Transition model A is given for time step 1. For other steps
+   *  A(dt) = I + (A - I)*dt, which is exact for kinematic models,
+   *  where (A - I)^2 = 0 (e.g. constant velocity). Process noise Q(dt)
+   *  is built in closed form (see setProcessNoiseDensity()). Both are
+   *  built in place, only when time step changes.
+   */
+  virtual std::pair<vector_t,vector_t>
+    predictFor(typename StateModel::values_type timeStep)
   {
     assert(initialized);
-    // Kalman gain = P' * transposed(H) / (H * P' * transposed(H) + R)
-
-    Matrix transposedMeasurement = ublas::trans(measurementModel);
-    Matrix top = ublas::prod(predictedCovarianceError,transposedMeasurement);
-    // bottom = H * P' * transposed(H) + R
-    Matrix bottom1 = ublas::prod(measurementModel, predictedCovarianceError);
-    Matrix bottom_all = ublas::prod(bottom1,transposedMeasurement) + measurementNoise;
-    Matrix bottom(bottom_all.size1(),bottom_all.size2());
-    bool inverted = invertMatrix(bottom_all,bottom);
-    assert(inverted);
+    predictWith(timeStep);
 
-    Matrix K = ublas::prod(top,bottom); // Kalman gain
-
-    Vector residual
-        = arrayToUblas(z,measurementModel.size1()) - ublas::prod(measurementModel,predictedState);
+    return std::pair<vector_t,vector_t>(
+            ublasToArray(predictedState),
+            getDiagonal(predictedCovarianceError)
+          );
+  }
 
-    // correctedState = predictedState + kalmanGain*(z - H*x')
-    correctedState = predictedState + ublas::prod(K,residual);
+  virtual std::pair<vector_t,vector_t> correct(const vector_t& z)
+  {
+    return correctWith(z,measurementNoise,measurementNoiseClass);
+  }
 
-    // P = (I - K*H)*P'
-    Matrix KH = ublas::prod(K,measurementModel);
-    Matrix Iminus
-       = ublas::identity_matrix<typename Vector::value_type>(KH.size1(),KH.size2()) - KH;
-    correctedCovarianceError = ublas::prod(Iminus,predictedCovarianceError);
+  /*
+   * R is built from given variances in already allocated matrix,
+   *  so correction doesn't allocate more than correct(z).
+   */
+  virtual std::pair<vector_t,vector_t>
+    correct(const vector_t& z, const vector_t& measurementVariance,
+            int noiseClass)
+  {
+    const std::size_t m = measurementModel.size1();
+    sensorMeasurementNoise.resize(m,m,false);
+    sensorMeasurementNoise.clear();
+    for (std::size_t i = 0; i < m; ++i)
+    {
+      sensorMeasurementNoise(i,i) = measurementVariance[i];
+    }
 
-    return std::pair<vector_t,vector_t>(
-            ublasToArray(correctedState),
-            getDiagonal(correctedCovarianceError)
-          );
+    return correctWith(z,sensorMeasurementNoise,noiseClass);
   }
 
   virtual std::pair<vector_t,vector_t>
@@ -175,9 +265,64 @@ public:
     return initializeState(vec,m);
   }
 
+  virtual std::pair<vector_t,vector_t>
+    constrainPrediction(const std::vector<vector_t>& D,
+                        const std::vector<typename StateModel::values_type>& d)
+  {
+    assert(initialized);
+    assert(D.size() == d.size());
+    if (D.empty())
+      return std::pair<vector_t,vector_t>(
+              ublasToArray(predictedState),
+              getDiagonal(predictedCovarianceError)
+            );
+
+    const std::size_t size = std::tuple_size<vector_t>::value;
+    Matrix constraints(D.size(),size);
+    Vector values(d.size());
+    for (std::size_t i = 0; i < D.size(); ++i)
+    {
+      for (std::size_t j = 0; j < size; ++j)
+      {
+        constraints(i,j) = D[i][j];
+      }
+      values(i) = d[i];
+    }
+
+    // estimate projection (minimum variance estimate satisfying D*x = d):
+    // x' = x' - P'*trans(D) * inv(D*P'*trans(D)) * (D*x' - d)
+    // P' = P' - P'*trans(D) * inv(D*P'*trans(D)) * D*P'
+    Matrix PDt = ublas::prod(predictedCovarianceError,ublas::trans(constraints));
+    Matrix DPDt = ublas::prod(constraints,PDt);
+    Matrix inverse(DPDt.size1(),DPDt.size2());
+    if (!invertMatrix(DPDt,inverse))
+    { // prediction is already certain in constrained directions
+      return std::pair<vector_t,vector_t>(
+              ublasToArray(predictedState),
+              getDiagonal(predictedCovarianceError)
+            );
+    }
+
+    predictionConstrained = true; // cached gain doesn't fit this prediction
+
+    Matrix gain = ublas::prod(PDt,inverse);
+    Vector residual = ublas::prod(constraints,predictedState) - values;
+    predictedState -= ublas::prod(gain,residual);
+    // D*P' = trans(P'*trans(D)), because P' is symmetric
+    Matrix correction = ublas::prod(gain,ublas::trans(PDt));
+    predictedCovarianceError -= correction;
+
+    return std::pair<vector_t,vector_t>(
+            ublasToArray(predictedState),
+            getDiagonal(predictedCovarianceError)
+          );
+  }
+
   virtual void setTransitionModel(Matrix m)
   {
     transitionModel = m;
+    findNoiseAxes();
+    resetSteadyState();
   }
 
   virtual void setControlModel(Matrix v)
@@ -188,16 +333,94 @@ public:
   virtual void setMeasurementModel(Matrix m)
   {
     measurementModel = m;
+    resetSteadyState();
   }
 
   virtual void setMeasurementNoise(Matrix m)
   {
     measurementNoise = m;
+    measurementNoiseClass = 0;
+    resetSteadyState();
+  }
+
+  /**
+   * @brief Sets measurement noise of given class - e.g. of sensor type.
+   *  Steady-state gain is kept for one class, so noises of the same class
+   *  have to be equal.
+   */
+  virtual void setMeasurementNoise(Matrix m, int noiseClass)
+  {
+    measurementNoise = m;
+    measurementNoiseClass = noiseClass;
+  }
+
+  /**
+   * @brief Enables steady-state gain mode: when covariance of corrections
+   *  following predictions for the same time step, with the same class
+   *  of measurement noise, stops changing (relatively, by less than
+   *  tolerance), Kalman gain is cached and covariances are no more
+   *  updated. Correction costs then a few multiply-adds, until time step
+   *  or noise class changes (or prediction is constrained).
+   *  Corrections after prediction to the same instant (e.g. extra
+   *  measurements from overlapping sensors) belong to the current cycle -
+   *  they are made in full, but neither break the mode nor convergence.
+   * @param tolerance - 0 disables mode
+   */
+  virtual void setSteadyStateTolerance(typename StateModel::values_type tolerance)
+  {
+    steadyStateTolerance = tolerance;
+    resetSteadyState();
+  }
+
+  /**
+   * @brief Sets, how much (relatively) time steps may differ to be treated
+   *  as the same one by steady-state gain mode - time steps of real
+   *  sensors jitter. Steps shorter than this part of the current one
+   *  are treated as prediction to the same instant.
+   * @param tolerance - 0 - time steps have to be equal
+   */
+  virtual void setSteadyTimeStepTolerance(typename StateModel::values_type tolerance)
+  {
+    steadyTimeStepTolerance = tolerance;
+    resetSteadyState();
   }
 
+  /**
+   * @return true, when corrections use cached steady-state gain
+   */
+  virtual bool isSteadyState() const
+  {
+    return steadyState;
+  }
+
+  /**
+   * @brief Sets process noise Q for time step 1. Spectral density
+   *  of each axis (see setProcessNoiseDensity()) is taken from Q,
+   *  as variance of it's velocity.
+   */
   virtual void setProcessNoise(Matrix m)
   {
     processNoise = m;
+    findNoiseAxes();
+    resetSteadyState();
+  }
+
+  /**
+   * @brief Sets spectral density q of white noise acceleration
+   *  of all axes. Axis is pair of position p and velocity v, where
+   *  A(p,v) != 0. Process noise of axis for time step dt is
+   *   Q(p,p) = q*dt^3/3, Q(p,v) = Q(v,p) = q*dt^2/2, Q(v,v) = q*dt,
+   *  noises of different axes are independent. Elements of Q outside
+   *  of axes (if any) don't depend on time step.
+   */
+  virtual void setProcessNoiseDensity(typename StateModel::values_type q)
+  {
+    for (NoiseAxis& axis : noiseAxes)
+    {
+      axis.density = q;
+    }
+    stepModelsValid = false;
+    resetSteadyState();
   }
 
   virtual Vector getPredictedState() const
@@ -220,6 +443,60 @@ public:
     return correctedCovarianceError;
   }
 
+  /*
+   * Layout: n, x'(n), x(n), P'(n*n), P(n*n) - matrices row by row.
+   */
+  virtual std::vector<typename StateModel::values_type> exportState() const
+  {
+    assert(initialized);
+    const std::size_t n = correctedState.size();
+    std::vector<typename StateModel::values_type> result;
+    result.reserve(1 + 2*n + 2*n*n);
+    result.push_back(n);
+    result.insert(result.end(),predictedState.begin(),predictedState.end());
+    result.insert(result.end(),correctedState.begin(),correctedState.end());
+    for (const Matrix* m : { &predictedCovarianceError,
+                             &correctedCovarianceError })
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+          result.push_back((*m)(i,j));
+    }
+
+    return result;
+  }
+
+  virtual bool
+    importState(const std::vector<typename StateModel::values_type>& state)
+  {
+    const std::size_t n = transitionModel.size1();
+    if (state.empty() || std::size_t(state[0]) != n
+        || state.size() != 1 + 2*n + 2*n*n)
+      return false;
+
+    typename std::vector<
+        typename StateModel::values_type
+      >::const_iterator iter = state.begin() + 1;
+    predictedState.resize(n);
+    correctedState.resize(n);
+    std::copy(iter,iter+n,predictedState.begin());
+    iter += n;
+    std::copy(iter,iter+n,correctedState.begin());
+    iter += n;
+    for (Matrix* m : { &predictedCovarianceError,
+                       &correctedCovarianceError })
+    {
+      m->resize(n,n,false);
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+          (*m)(i,j) = *iter++;
+    }
+
+    resetSteadyState();
+    initialized = true;
+    return true;
+  }
+
   virtual std::unique_ptr<EstimationFilter<StateModel> > clone() const
   {
     std::unique_ptr<EstimationFilter<StateModel> > result(
@@ -228,12 +505,296 @@ public:
   }
 
 private:
+  // position and velocity of one axis, moved by white noise acceleration
+  struct NoiseAxis
+  {
+    std::size_t position;
+    std::size_t velocity;
+    typename StateModel::values_type density; // q
+  };
+
+  // axes are found in A, their densities in Q (velocity variance)
+  void findNoiseAxes()
+  {
+    noiseAxes.clear();
+    const std::size_t n = transitionModel.size1();
+    axisOfState.assign(n,-1);
+    for (std::size_t p = 0; p < n; ++p)
+    {
+      for (std::size_t v = 0; v < transitionModel.size2(); ++v)
+      {
+        if (p == v || transitionModel(p,v) == 0
+            || axisOfState[p] >= 0 || axisOfState[v] >= 0)
+          continue;
+
+        const typename StateModel::values_type density
+            = (v < processNoise.size1() && v < processNoise.size2()
+               ? processNoise(v,v) : 0);
+        axisOfState[p] = axisOfState[v] = noiseAxes.size();
+        noiseAxes.push_back(NoiseAxis{ p, v, density });
+      }
+    }
+    stepModelsValid = false;
+  }
+
+  // A(dt) and Q(dt) into already allocated matrices, if dt changed
+  void buildStepModels(typename StateModel::values_type timeStep)
+  {
+    if (stepModelsValid && timeStep == stepModelsTimeStep)
+      return;
+
+    const std::size_t n = transitionModel.size1();
+    stepTransitionModel.resize(n,n,false);
+    stepProcessNoise.resize(n,n,false);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      for (std::size_t j = 0; j < n; ++j)
+      {
+        const typename StateModel::values_type identity = (i == j ? 1 : 0);
+        stepTransitionModel(i,j)
+            = identity + (transitionModel(i,j) - identity)*timeStep;
+        // noise of axes is set below, other noise is constant
+        stepProcessNoise(i,j)
+            = (axisOfState[i] < 0 && axisOfState[j] < 0
+               ? processNoise(i,j) : 0);
+      }
+    }
+
+    const typename StateModel::values_type dt = timeStep;
+    for (const NoiseAxis& axis : noiseAxes)
+    {
+      const std::size_t p = axis.position;
+      const std::size_t v = axis.velocity;
+      stepProcessNoise(p,p) = axis.density*dt*dt*dt/3;
+      stepProcessNoise(p,v) = axis.density*dt*dt/2;
+      stepProcessNoise(v,p) = stepProcessNoise(p,v);
+      stepProcessNoise(v,v) = axis.density*dt;
+    }
+
+    stepModelsValid = true;
+    stepModelsTimeStep = timeStep;
+  }
+
+  /*
+   * x' = A(dt)*x, P' = A*P*trans(A) + Q - into already allocated matrices.
+   *  In steady-state gain mode covariance is predicted for time step
+   *  of the current cycle, when given one differs from it less than
+   *  tolerance - so covariance converges despite jitter of time steps.
+   */
+  void predictWith(typename StateModel::values_type timeStep)
+  {
+    const typename StateModel::values_type covarianceTimeStep
+        = cycleTimeStepFor(timeStep);
+    buildStepModels(timeStep);
+
+    const std::size_t n = stepTransitionModel.size1();
+    if (predictedState.size() != n)
+      predictedState.resize(n,false);
+    predictedCovarianceError.resize(n,n,false);
+    covarianceWorkspace.resize(n,n,false);
+    lastTimeStep = covarianceTimeStep;
+    predictionConstrained = false;
+
+    // predictedState (x')
+    //  = transitionModel (A) * correctedState (x) + controlModel (B) * u
+    ublas::noalias(predictedState)
+        = ublas::prod(stepTransitionModel,correctedState);
+
+    if (steadyState && covarianceTimeStep == steadyTimeStep)
+    { // P' is the same after each steady correction
+      predictedCovarianceError.assign(steadyPredictedCovarianceError);
+      return;
+    }
+    buildStepModels(covarianceTimeStep);
+    const Matrix& A = stepTransitionModel;
+    const Matrix& Q = stepProcessNoise;
+    // predictedCovarianceError (P')
+    //  = transitionModel (A) * correctedCovarianceError (P)
+    //    * transposed (transitionModel (A)) + processNoise (Q)
+    ublas::noalias(covarianceWorkspace)
+        = ublas::prod(correctedCovarianceError,ublas::trans(A));
+    ublas::noalias(predictedCovarianceError) = ublas::prod(A,covarianceWorkspace);
+    predictedCovarianceError += Q;
+  }
+
+  // Kalman correction with measurement noise R of given class
+  std::pair<vector_t,vector_t>
+    correctWith(const vector_t& z, const Matrix& R, int noiseClass)
+  {
+    assert(initialized);
+    const bool simultaneous = isSimultaneous();
+    if (steadyState && !predictionConstrained && noiseClass >= 0
+        && !simultaneous
+        && sameTimeStep(lastTimeStep,steadyTimeStep)
+        && noiseClass == steadyNoiseClass)
+    { // covariance doesn't change any more - only state is corrected
+      const std::size_t m = measurementModel.size1();
+      residualWorkspace.resize(m,false);
+      ublas::noalias(residualWorkspace) = -ublas::prod(measurementModel,predictedState);
+      for (std::size_t i = 0; i < m; ++i)
+      {
+        residualWorkspace(i) += z[i];
+      }
+      ublas::noalias(correctedState)
+          = predictedState + ublas::prod(steadyGain,residualWorkspace);
+      // simultaneous corrections of previous cycle start from it again
+      correctedCovarianceError.assign(steadyCorrectedCovarianceError);
+
+      return std::pair<vector_t,vector_t>(
+              ublasToArray(correctedState),
+              getDiagonal(correctedCovarianceError)
+            );
+    }
+    if (!simultaneous || predictionConstrained)
+      steadyState = false; // time step or noise changed (if it was steady)
+
+    // Kalman gain = P' * transposed(H) / (H * P' * transposed(H) + R)
+
+    Matrix transposedMeasurement = ublas::trans(measurementModel);
+    Matrix top = ublas::prod(predictedCovarianceError,transposedMeasurement);
+    // bottom = H * P' * transposed(H) + R
+    Matrix bottom1 = ublas::prod(measurementModel, predictedCovarianceError);
+    Matrix bottom_all = ublas::prod(bottom1,transposedMeasurement) + R;
+    Matrix bottom(bottom_all.size1(),bottom_all.size2());
+    bool inverted = invertMatrix(bottom_all,bottom);
+    assert(inverted);
+
+    Matrix K = ublas::prod(top,bottom); // Kalman gain
+
+    Vector residual
+        = arrayToUblas(z,measurementModel.size1()) - ublas::prod(measurementModel,predictedState);
+
+    // correctedState = predictedState + kalmanGain*(z - H*x')
+    correctedState = predictedState + ublas::prod(K,residual);
+
+    // P = (I - K*H)*P'
+    Matrix KH = ublas::prod(K,measurementModel);
+    Matrix Iminus
+       = ublas::identity_matrix<typename Vector::value_type>(KH.size1(),KH.size2()) - KH;
+    Matrix covarianceError = ublas::prod(Iminus,predictedCovarianceError);
+
+    if (simultaneous && !predictionConstrained)
+    {
+      // convergence is checked once per cycle - after it's first correction
+    }
+    else if (steadyStateTolerance > 0 && noiseClass >= 0)
+      detectSteadyState(K,covarianceError,noiseClass);
+    else
+      convergenceChecked = false; // nothing to compare next correction with
+    correctedCovarianceError.swap(covarianceError);
+
+    return std::pair<vector_t,vector_t>(
+            ublasToArray(correctedState),
+            getDiagonal(correctedCovarianceError)
+          );
+  }
+
+  /*
+   * Covariance converged, when corrected covariance changed (relatively)
+   *  less than tolerance since first correction of previous cycle, both
+   *  made after predictions for the same time step (the one, which
+   *  started tracking), with the same noise class.
+   */
+  void detectSteadyState(const Matrix& K, const Matrix& covarianceError,
+                         int noiseClass)
+  {
+    const bool sameConditions = convergenceChecked
+        && sameTimeStep(convergenceTimeStep,lastTimeStep)
+        && convergenceNoiseClass == noiseClass
+        && !predictionConstrained;
+    convergenceChecked = !predictionConstrained;
+    if (!sameConditions)
+    { // jittering time steps are compared with the first one, so don't drift
+      convergenceTimeStep = lastTimeStep;
+      convergenceNoiseClass = noiseClass;
+      convergenceCovarianceError = covarianceError;
+      return;
+    }
+
+    typename StateModel::values_type difference = 0;
+    typename StateModel::values_type magnitude = 0;
+    for (std::size_t i = 0; i < covarianceError.size1(); ++i)
+    {
+      for (std::size_t j = 0; j < covarianceError.size2(); ++j)
+      {
+        difference = std::max(difference,
+                              std::abs(covarianceError(i,j)
+                                       - convergenceCovarianceError(i,j)));
+        magnitude = std::max(magnitude,std::abs(covarianceError(i,j)));
+      }
+    }
+    convergenceCovarianceError.assign(covarianceError);
+    if (difference > steadyStateTolerance*magnitude)
+      return;
+
+    steadyState = true;
+    steadyTimeStep = convergenceTimeStep;
+    steadyNoiseClass = noiseClass;
+    steadyGain = K;
+    steadyPredictedCovarianceError = predictedCovarianceError;
+    steadyCorrectedCovarianceError = covarianceError;
+  }
+
+  /*
+   * Time step of the current cycle of steady-state gain mode, if given one
+   *  is the same (see setSteadyTimeStepTolerance()), otherwise given one.
+   */
+  typename StateModel::values_type
+    cycleTimeStepFor(typename StateModel::values_type timeStep) const
+  {
+    if (steadyStateTolerance <= 0)
+      return timeStep;
+
+    typename StateModel::values_type cycleTimeStep = 0;
+    if (steadyState)
+      cycleTimeStep = steadyTimeStep;
+    else if (convergenceChecked)
+      cycleTimeStep = convergenceTimeStep;
+
+    return (cycleTimeStep > 0 && sameTimeStep(timeStep,cycleTimeStep)
+            ? cycleTimeStep : timeStep);
+  }
+
+  bool sameTimeStep(typename StateModel::values_type a,
+                    typename StateModel::values_type b) const
+  {
+    return std::abs(a - b)
+        <= steadyTimeStepTolerance*std::max(std::abs(a),std::abs(b));
+  }
+
+  /*
+   * Latest prediction was to the same instant (or negligibly later), as
+   *  prediction of the current cycle of steady-state gain mode.
+   */
+  bool isSimultaneous() const
+  {
+    typename StateModel::values_type cycleTimeStep = 0;
+    if (steadyState)
+      cycleTimeStep = steadyTimeStep;
+    else if (convergenceChecked)
+      cycleTimeStep = convergenceTimeStep;
+
+    return cycleTimeStep > 0
+        && lastTimeStep <= steadyTimeStepTolerance*cycleTimeStep;
+  }
+
+  void resetSteadyState()
+  {
+    steadyState = false;
+    steadyTimeStep = 0;
+    steadyNoiseClass = 0;
+    convergenceChecked = false;
+    convergenceTimeStep = 0;
+    convergenceNoiseClass = 0;
+  }
+
   // only after successful end of this method execution, filter is properly initialized
   virtual std::pair<vector_t,vector_t>
     initializeState(Vector state, Matrix covarianceError)
   {
     correctedState = state;
     correctedCovarianceError = covarianceError;
+    resetSteadyState();
     initialized = true;
     return predict(); // needed to setup predictedCovarianceError
   }
@@ -339,6 +900,38 @@ private:
   Matrix processNoise; // Q
 
   Matrix measurementModel; // H
+
+  // white noise acceleration axes of Q(dt), axis of each state (or -1)
+  std::vector<NoiseAxis> noiseAxes;
+  std::vector<int> axisOfState;
+
+  // A(dt), Q(dt) and P*trans(A) of the last prediction, kept to avoid allocations
+  Matrix stepTransitionModel;
+  Matrix stepProcessNoise;
+  bool stepModelsValid; // A(dt) and Q(dt) are built for stepModelsTimeStep
+  typename StateModel::values_type stepModelsTimeStep;
+  Matrix covarianceWorkspace;
+  Vector residualWorkspace;
+  Matrix sensorMeasurementNoise; // R of the last correct() with variances
+
+  int measurementNoiseClass; // of R
+  typename StateModel::values_type lastTimeStep; // of the latest prediction
+  bool predictionConstrained; // since the latest prediction
+
+  // steady-state gain mode (see setSteadyStateTolerance())
+  typename StateModel::values_type steadyStateTolerance;
+  typename StateModel::values_type steadyTimeStepTolerance; // relative
+  bool steadyState;
+  typename StateModel::values_type steadyTimeStep; // key of cached gain
+  int steadyNoiseClass; // key of cached gain
+  Matrix steadyGain;
+  Matrix steadyPredictedCovarianceError;
+  Matrix steadyCorrectedCovarianceError;
+  // conditions and covariance of the first correction of previous cycle
+  bool convergenceChecked;
+  typename StateModel::values_type convergenceTimeStep;
+  int convergenceNoiseClass;
+  Matrix convergenceCovarianceError;
 };
 
 } // namespace estimation
@@ -1,14 +1,55 @@
 #include "feature.h"
-#include "featureextractor.h"
 
-void ColorFeature::accept(FeatureVisitor& v) const
+#include "colormatcher.h"
+#include "platematcher.h"
+
+#include <unordered_map>
+
+Feature::~Feature()
+{
+}
+
+Feature::Type Feature::typeOfName(const std::string& name)
+{
+  static const std::unordered_map<std::string,Type> types = {
+    { "Color", Color },
+    { "Plate", Plate },
+    // names used in FEATURE_DEFINITIONS table
+    { "color", Color },
+    { "plate", Plate }
+  };
+
+  std::unordered_map<std::string,Type>::const_iterator it = types.find(name);
+  if (it == types.end())
+    return TypesCount;
+  return it->second;
+}
+
+ColorFeature::ColorFeature(double L, double a, double b, double weight)
+  : L_(L),
+    a_(a),
+    b_(b),
+    weight_(weight)
+{}
+
+ColorFeature ColorFeature::fromRGB(unsigned char red,
+                                   unsigned char green,
+                                   unsigned char blue)
 {
-  v.visit(*this);
+  ColorFeature color;
+  rgbToLab(red,green,blue,color.L_,color.a_,color.b_);
+  return color;
 }
 
-std::string ColorFeature::getName() const
+const std::string& ColorFeature::getName() const
 {
-  return "Color";
+  static const std::string name = "Color";
+  return name;
+}
+
+Feature::Type ColorFeature::getType() const
+{
+  return Color;
 }
 
 Feature* ColorFeature::clone() const
@@ -16,17 +57,78 @@ Feature* ColorFeature::clone() const
   return new ColorFeature(*this);
 }
 
-void PlateFeature::accept(FeatureVisitor& v) const
+double ColorFeature::getL() const
+{
+  return L_;
+}
+
+double ColorFeature::getA() const
+{
+  return a_;
+}
+
+double ColorFeature::getB() const
 {
-  v.visit(*this);
+  return b_;
 }
 
-std::string PlateFeature::getName() const
+double ColorFeature::getWeight() const
 {
-  return "Plate";
+  return weight_;
+}
+
+bool ColorFeature::parse(const std::string& value)
+{
+  if (value.size() != 7 || value[0] != '#')
+    return false;
+
+  unsigned long rgb = 0;
+  for (std::size_t i = 1; i < value.size(); ++i)
+  {
+    const char c = value[i];
+    unsigned long digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else
+      return false;
+    rgb = (rgb << 4) | digit;
+  }
+
+  *this = fromRGB((rgb >> 16) & 0xFF,(rgb >> 8) & 0xFF,rgb & 0xFF);
+  return true;
+}
+
+PlateFeature::PlateFeature(const std::string& plate)
+  : plate_(plate),
+    canonicalPlate_(canonicalPlate(plate)) // once, not on every comparison
+{}
+
+const std::string& PlateFeature::getName() const
+{
+  static const std::string name = "Plate";
+  return name;
+}
+
+Feature::Type PlateFeature::getType() const
+{
+  return Plate;
 }
 
 Feature* PlateFeature::clone() const
 {
   return new PlateFeature(*this);
 }
+
+const std::string& PlateFeature::getPlate() const
+{
+  return plate_;
+}
+
+const std::string& PlateFeature::getCanonicalPlate() const
+{
+  return canonicalPlate_;
+}
@@ -3,30 +3,91 @@
 
 #include <string>
 
-class FeatureVisitor;
-
 class Feature
 {
 public:
-  virtual void accept(FeatureVisitor&) const = 0;
-  virtual std::string getName() const = 0;
+  /**
+   * @brief Interned names of features - index of feature in FeatureTable.
+   */
+  enum Type
+  {
+    Color = 0,
+    Plate,
+    TypesCount // number of types, also returned for unknown names
+  };
+
+  virtual ~Feature();
+
+  virtual const std::string& getName() const = 0;
+  virtual Type getType() const = 0;
   virtual Feature* clone() const = 0;
+
+  /**
+   * @return type of feature with given name (TypesCount, when there is no such)
+   */
+  static Type typeOfName(const std::string& name);
 };
 
+/**
+ * @brief Color kept in CIELAB space (converted once, when read),
+ *  so it's compared and fused without conversions.
+ *
+ *  Weight is number of observations fused into color - Track's color
+ *  is running weighted mean of colors of it's DRs.
+ */
 class ColorFeature : public Feature
 {
 public:
-  virtual void accept(FeatureVisitor&) const;
-  virtual std::string getName() const;
+  ColorFeature(double L = 0, double a = 0, double b = 0, double weight = 1);
+
+  /**
+   * @brief Creates color from sRGB components (0-255).
+   */
+  static ColorFeature fromRGB(unsigned char red,
+                              unsigned char green,
+                              unsigned char blue);
+
+  virtual const std::string& getName() const;
+  virtual Type getType() const;
   virtual Feature* clone() const;
+
+  double getL() const;
+  double getA() const;
+  double getB() const;
+  double getWeight() const;
+
+  /**
+   * @brief Reads color serialized as "#RRGGBB" (hex sRGB).
+   * @return false, when value is malformed (color is not changed then)
+   */
+  bool parse(const std::string& value);
+
+private:
+  double L_;
+  double a_;
+  double b_;
+  double weight_;
 };
 
 class PlateFeature : public Feature
 {
 public:
-  virtual void accept(FeatureVisitor&) const;
-  virtual std::string getName() const;
+  explicit PlateFeature(const std::string& plate = std::string());
+
+  virtual const std::string& getName() const;
+  virtual Type getType() const;
   virtual Feature* clone() const;
+
+  const std::string& getPlate() const;
+
+  /**
+   * @return plate in form used for comparison (see canonicalPlate())
+   */
+  const std::string& getCanonicalPlate() const;
+
+private:
+  std::string plate_;
+  std::string canonicalPlate_;
 };
 
 #endif // FEATURE_H
@@ -1,30 +1,169 @@
 #include "featureextractor.h"
 
+#include <vector>
+
+#include <Common/arena.hpp>
+
+#include "colormatcher.h"
+#include "platematcher.h"
+
+FeatureExtractor::FeatureExtractor()
+{
+  for (auto& row : functions_)
+  {
+    for (Functions& functions : row)
+    {
+      functions.compare = nullptr;
+      functions.batchCompare = nullptr;
+      functions.fuse = nullptr;
+    }
+  }
+
+  setComparator(Feature::Color,Feature::Color,&compareColors);
+  setBatchComparator(Feature::Color,Feature::Color,&compareColors);
+  setComparator(Feature::Plate,Feature::Plate,&comparePlates);
+  setFusioner(Feature::Color,Feature::Color,&fuseColors);
+}
+
 FeatureExtractor::~FeatureExtractor()
 {
 }
 
-void FeatureExtractor::visit(const ColorFeature&)
+double FeatureExtractor::compare(const Feature& a, const Feature& b) const
+{
+  compare_function_t comparator = functions_[a.getType()][b.getType()].compare;
+  if (!comparator)
+    return 0;
+  return comparator(a,b);
+}
+
+void FeatureExtractor::compare(const Feature& feature,
+                               const Feature* const* features,
+                               std::size_t count,
+                               double* grades) const
+{
+  const auto& row = functions_[feature.getType()];
+
+  // the whole batch at once, when all features are of the same type
+  const Feature* first = nullptr;
+  bool sameType = true;
+  for (std::size_t i = 0; i < count && sameType; ++i)
+  {
+    if (!features[i])
+      continue;
+    if (!first)
+      first = features[i];
+    else
+      sameType = (features[i]->getType() == first->getType());
+  }
+  if (first && sameType && row[first->getType()].batchCompare)
+  {
+    row[first->getType()].batchCompare(feature,features,count,grades);
+    return;
+  }
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    compare_function_t comparator
+        = features[i] ? row[features[i]->getType()].compare : nullptr;
+    grades[i] = comparator ? comparator(feature,*features[i]) : 0;
+  }
+}
+
+Feature* FeatureExtractor::fuse(const Feature& a, const Feature& b) const
+{
+  fuse_function_t fusioner = functions_[a.getType()][b.getType()].fuse;
+  if (!fusioner)
+    return nullptr;
+  return fusioner(a,b);
+}
+
+void FeatureExtractor::setComparator(Feature::Type a, Feature::Type b,
+                                     compare_function_t comparator)
 {
-  // TODO implement this
+  functions_[a][b].compare = comparator;
 }
 
-void FeatureExtractor::visit(const PlateFeature&)
+void FeatureExtractor::setBatchComparator(Feature::Type a, Feature::Type b,
+                                          batch_compare_function_t comparator)
 {
-  // TODO implement this
+  functions_[a][b].batchCompare = comparator;
 }
 
-double FeatureExtractor::compare(const ColorFeature& a, const ColorFeature& b) const
+void FeatureExtractor::setFusioner(Feature::Type a, Feature::Type b,
+                                   fuse_function_t fusioner)
 {
-  // TODO implement this
+  functions_[a][b].fuse = fusioner;
 }
 
-double FeatureExtractor::compare(const PlateFeature& a, const PlateFeature& b) const
+double FeatureExtractor::compareColors(const Feature& a, const Feature& b)
 {
-  // TODO implement this
+  double grade = 0;
+  const Feature* features[] = { &b };
+  compareColors(a,features,1,&grade);
+  return grade;
 }
 
-Feature* FeatureExtractor::fuse(const ColorFeature& a, const ColorFeature& b) const
+void FeatureExtractor::compareColors(const Feature& feature,
+                                     const Feature* const* features,
+                                     std::size_t count,
+                                     double* grades)
 {
-  // TODO implement this
+  const ColorFeature& color = static_cast<const ColorFeature&>(feature);
+
+  // colors are gathered into structure of arrays, for vectorized rating
+  typedef std::vector<double,Common::ArenaAllocator<double> > components_t;
+  components_t Ls;
+  components_t as;
+  components_t bs;
+  Ls.reserve(count);
+  as.reserve(count);
+  bs.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!features[i])
+      continue;
+    const ColorFeature& other = static_cast<const ColorFeature&>(*features[i]);
+    Ls.push_back(other.getL());
+    as.push_back(other.getA());
+    bs.push_back(other.getB());
+  }
+
+  components_t rated(Ls.size());
+  rateColors(Ls.data(),as.data(),bs.data(),Ls.size(),
+             color.getL(),color.getA(),color.getB(),
+             rated.data());
+
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    grades[i] = features[i] ? rated[j++] : 0;
+  }
+}
+
+double FeatureExtractor::comparePlates(const Feature& a, const Feature& b)
+{
+  const PlateFeature& first = static_cast<const PlateFeature&>(a);
+  const PlateFeature& second = static_cast<const PlateFeature&>(b);
+
+  return plateSimilarity(first.getCanonicalPlate(),
+                         second.getCanonicalPlate());
+}
+
+Feature* FeatureExtractor::fuseColors(const Feature& a, const Feature& b)
+{
+  const ColorFeature& first = static_cast<const ColorFeature&>(a);
+  const ColorFeature& second = static_cast<const ColorFeature&>(b);
+
+  // running weighted mean - color is not recomputed from all observations
+  const double weight = first.getWeight() + second.getWeight();
+  if (weight <= 0)
+    return nullptr;
+  const double firstShare = first.getWeight()/weight;
+  const double secondShare = second.getWeight()/weight;
+
+  return new ColorFeature(firstShare*first.getL() + secondShare*second.getL(),
+                          firstShare*first.getA() + secondShare*second.getA(),
+                          firstShare*first.getB() + secondShare*second.getB(),
+                          weight);
 }
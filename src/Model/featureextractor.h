@@ -1,74 +1,122 @@
 #ifndef FEATUREEXTRACTOR_H
 #define FEATUREEXTRACTOR_H
 
-#include "feature.h"
+#include <array>
+#include <cstddef>
 
-class FeatureVisitor
-{
-public:
-  virtual void visit(const ColorFeature&) = 0;
-  virtual void visit(const PlateFeature&) = 0;
-};
+#include "feature.h"
 
 /**
- * @brief The FeatureExtractor class, uses multimethod design pattern (based on visitor design pattern)
- *  It's task is to compare and fuse features, when it's possible.
- *  You may define many types of available fusions and comparations, without changing interface of this class.
+ * @brief The FeatureExtractor class compares and fuses features, when it's possible.
+ *  Functions doing it are kept in table indexed by types of both features,
+ *  so finding the one for given pair of features is O(1), without any virtual call.
+ *  You may register comparators and fusioners for new types of features, without changing interface of this class.
  *  E.g. fusion of two colors, can be realized as a linear combination of them.
  */
 class FeatureExtractor
 {
 public:
+  /**
+   * @return 0-1 grade of similarity
+   */
+  typedef double (*compare_function_t)(const Feature& a, const Feature& b);
+
+  /**
+   * @brief Compares one feature with many others, at once
+   *  (the same as compare_function_t for each of them).
+   * @param feature
+   * @param features - of the same type (or nullptr, graded 0)
+   * @param count of features
+   * @param grades - output, count values
+   */
+  typedef void (*batch_compare_function_t)(const Feature& feature,
+                                           const Feature* const* features,
+                                           std::size_t count,
+                                           double* grades);
+
+  /**
+   * @return new Feature (caller takes ownership), nullptr when cannot fuse
+   */
+  typedef Feature* (*fuse_function_t)(const Feature& a, const Feature& b);
+
+  /**
+   * @brief Creates extractor with default comparators (Color-Color, Plate-Plate)
+   *  and fusioners (Color-Color - weighted mean).
+   */
+  FeatureExtractor();
   virtual ~FeatureExtractor();
 
+  /**
+   * @return 0-1 grade, 0 when there is no comparator for given types
+   */
   double compare(const Feature& a, const Feature& b) const;
+
+  /**
+   * @brief Compares one feature (e.g. of Track) with many others (e.g. of DRs).
+   * @param feature
+   * @param features - nullptr entries are graded 0
+   * @param count of features
+   * @param grades - output, count values
+   */
+  void compare(const Feature& feature,
+               const Feature* const* features, std::size_t count,
+               double* grades) const;
+
+  /**
+   * @return fused feature (caller takes ownership),
+   *  nullptr when there is no fusioner for given types
+   */
   Feature* fuse(const Feature& a, const Feature& b) const;
 
-  // creates ColorVisitor => second feature is ColorFeature
-  virtual void visit(const ColorFeature&);
-  // creates PlateVisitor => second feature is PlateFeature
-  virtual void visit(const PlateFeature&);
+  /**
+   * @brief Registers comparator for features of given types (in this order).
+   *  Overrides previous one, nullptr removes it.
+   */
+  void setComparator(Feature::Type a, Feature::Type b,
+                     compare_function_t comparator);
+
+  /**
+   * @brief Registers batch comparator for features of given types (in this order),
+   *  used by compare() of many features, when all of them have the second type.
+   *  Overrides previous one, nullptr removes it (then comparator is used for each feature).
+   */
+  void setBatchComparator(Feature::Type a, Feature::Type b,
+                          batch_compare_function_t comparator);
+
+  /**
+   * @brief Registers fusioner for features of given types (in this order).
+   *  Overrides previous one, nullptr removes it.
+   */
+  void setFusioner(Feature::Type a, Feature::Type b,
+                   fuse_function_t fusioner);
 
 protected:
   /*
-   * Implementations of concrete comparators.
-   * Can be overloaded to provide other comparators for color and plate features.
+   * Implementations of default comparators.
    */
-  virtual double compare(const ColorFeature& a, const ColorFeature& b) const;
-  virtual double compare(const PlateFeature& a, const PlateFeature& b) const;
-  //comparing Plate with Color does not make sense for the moment, but if possible - implement applicable comparator
+  static double compareColors(const Feature& a, const Feature& b);
+  static void compareColors(const Feature& feature,
+                            const Feature* const* features, std::size_t count,
+                            double* grades);
+  static double comparePlates(const Feature& a, const Feature& b);
+  //comparing Plate with Color does not make sense for the moment, but if possible - register applicable comparator
 
   /*
-   * Implementation of concrete fusioners;
-   * Can be overloaded to provide different type of color fusion.
+   * Implementation of default fusioners;
    */
-  virtual Feature* fuse(const ColorFeature& a, const ColorFeature& b) const;
-  //Feature fuse(const PlateFeature& a, const PlateFeature& b) const;
-  //fusing Plate with Color does not make sense for the moment, but if possible in future, implement applicable fuser
+  static Feature* fuseColors(const Feature& a, const Feature& b);
+  //fusing Plate with Color does not make sense for the moment, but if possible in future, register applicable fuser
 
 private:
-  class ColorVisitor : public FeatureVisitor
-  {
-  public:
-    virtual void visit(const ColorFeature&);
-    virtual void visit(const PlateFeature&);
-
-    // value for compare(Color,X)
-    double value;
-    // feature for fuse(Color,X)
-    Feature* fValue;
-  };
-
-  class PlateVisitor : public FeatureVisitor
+  struct Functions
   {
-  public:
-    virtual void visit(const ColorFeature&);
-    virtual void visit(const PlateFeature&);
-
-    double value;
-    Feature* fValue;
+    compare_function_t compare;
+    batch_compare_function_t batchCompare;
+    fuse_function_t fuse;
   };
 
+  std::array<std::array<Functions,Feature::TypesCount>,Feature::TypesCount>
+    functions_;
 };
 
 #endif // FEATUREEXTRACTOR_H
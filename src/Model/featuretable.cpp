@@ -0,0 +1,77 @@
+#include "featuretable.h"
+
+const FeatureTable::row_t*
+  FeatureTable::addRow(std::vector<std::unique_ptr<Feature> > features)
+{
+  rows_.push_back(emptyRow());
+  row_t& row = rows_.back();
+  for (std::unique_ptr<Feature>& feature : features)
+  {
+    if (!feature)
+      continue;
+
+    const Feature::Type type = feature->getType();
+    row[type] = feature.get();
+    features_.push_back(std::move(feature));
+  }
+
+  return &row;
+}
+
+const FeatureTable::row_t* FeatureTable::addRow(const row_t& row)
+{
+  rows_.push_back(row);
+  return &rows_.back();
+}
+
+const Feature* FeatureTable::decode(Feature::Type type,
+                                    const std::string& value)
+{
+  switch (type)
+  {
+    case Feature::Color:
+    {
+      ColorFeature color;
+      if (!color.parse(value))
+        return nullptr;
+
+      if (colorsUsed_ == colors_.size())
+        colors_.push_back(color);
+      else
+        colors_[colorsUsed_] = color;
+      return &colors_[colorsUsed_++];
+    }
+    case Feature::Plate:
+    {
+      if (value.empty())
+        return nullptr;
+
+      if (platesUsed_ == plates_.size())
+        plates_.push_back(PlateFeature(value));
+      else
+        plates_[platesUsed_] = PlateFeature(value);
+      return &plates_[platesUsed_++];
+    }
+    default:
+      return nullptr;
+  }
+}
+
+void FeatureTable::clear()
+{
+  rows_.clear();
+  features_.clear();
+  colorsUsed_ = 0;
+  platesUsed_ = 0;
+}
+
+std::size_t FeatureTable::getRowsCount() const
+{
+  return rows_.size();
+}
+
+const FeatureTable::row_t& FeatureTable::emptyRow()
+{
+  static const row_t row = {{}}; // all nullptr
+  return row;
+}
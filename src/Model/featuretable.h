@@ -0,0 +1,77 @@
+#ifndef FEATURETABLE_H
+#define FEATURETABLE_H
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "feature.h"
+
+/**
+ * @brief Owns features of DRs read in one cycle (one packet of DRs).
+ *
+ * Each DR points to it's row - array of features indexed by
+ * Feature::Type (nullptr - DR has no such feature), so DR stays trivially
+ * copyable and finding it's feature is O(1). Rows never move, until
+ * table is cleared - DRs (and features) of previous cycle are invalid then.
+ */
+class FeatureTable
+{
+public:
+  typedef std::array<const Feature*,Feature::TypesCount> row_t;
+
+  FeatureTable() = default;
+
+  /**
+   * @brief Stores features of one DR. At most one feature of each type
+   *  is kept (the last one given).
+   * @param features - table takes ownership
+   * @return row to be given to DR
+   */
+  const row_t* addRow(std::vector<std::unique_ptr<Feature> > features);
+
+  /**
+   * @brief Stores row of features created by decode().
+   * @return row to be given to DR
+   */
+  const row_t* addRow(const row_t& row);
+
+  /**
+   * @brief Creates feature of given type from it's serialized value
+   *  (as read from DB). Features are taken from typed pools of table,
+   *  which are reused after clear(), so no allocation per feature is done
+   *  in steady state.
+   * @return feature owned by table, nullptr when type is unknown
+   *  or value is malformed
+   */
+  const Feature* decode(Feature::Type type, const std::string& value);
+
+  /**
+   * @brief Frees all features and rows.
+   */
+  void clear();
+
+  std::size_t getRowsCount() const;
+
+  /**
+   * @return row without any feature
+   */
+  static const row_t& emptyRow();
+
+private:
+  FeatureTable(const FeatureTable&) = delete;
+  FeatureTable& operator=(const FeatureTable&) = delete;
+
+  std::deque<row_t> rows_; // deque - addresses are stable
+  std::vector<std::unique_ptr<Feature> > features_;
+
+  // pools of decoded features - objects are kept after clear()
+  std::deque<ColorFeature> colors_;
+  std::size_t colorsUsed_ = 0;
+  std::deque<PlateFeature> plates_;
+  std::size_t platesUsed_ = 0;
+};
+
+#endif // FEATURETABLE_H
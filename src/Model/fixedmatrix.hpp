@@ -0,0 +1,227 @@
+#ifndef FIXEDMATRIX_HPP
+#define FIXEDMATRIX_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace estimation
+{
+
+/**
+ * @brief Matrix of size known at compile time, stored in place
+ *  (row by row), so operations on it never allocate and loops
+ *  of known length are unrolled by compiler.
+ *
+ *  Used by filters working on small state models, where
+ *  ublas dynamic matrices cost more in allocations than in computations.
+ */
+template <std::size_t Rows, std::size_t Cols, class T = double>
+class FixedMatrix
+{
+public:
+  typedef T value_type;
+  enum { RowsCount = Rows, ColsCount = Cols };
+
+  /**
+   * @brief Creates zero matrix.
+   */
+  FixedMatrix()
+  {
+    data_.fill(T());
+  }
+
+  static FixedMatrix identity()
+  {
+    static_assert(Rows == Cols, "Identity matrix has to be square");
+    FixedMatrix result;
+    for (std::size_t i = 0; i < Rows; ++i)
+      result(i,i) = 1;
+    return result;
+  }
+
+  T& operator()(std::size_t row, std::size_t col)
+  {
+    return data_[row*Cols + col];
+  }
+
+  const T& operator()(std::size_t row, std::size_t col) const
+  {
+    return data_[row*Cols + col];
+  }
+
+  // element access for vectors (one column)
+  T& operator[](std::size_t i)
+  {
+    return data_[i];
+  }
+
+  const T& operator[](std::size_t i) const
+  {
+    return data_[i];
+  }
+
+  FixedMatrix& operator+=(const FixedMatrix& o)
+  {
+    for (std::size_t i = 0; i < Rows*Cols; ++i)
+      data_[i] += o.data_[i];
+    return *this;
+  }
+
+  FixedMatrix& operator-=(const FixedMatrix& o)
+  {
+    for (std::size_t i = 0; i < Rows*Cols; ++i)
+      data_[i] -= o.data_[i];
+    return *this;
+  }
+
+  FixedMatrix& operator*=(T scalar)
+  {
+    for (std::size_t i = 0; i < Rows*Cols; ++i)
+      data_[i] *= scalar;
+    return *this;
+  }
+
+  FixedMatrix<Cols,Rows,T> transposed() const
+  {
+    FixedMatrix<Cols,Rows,T> result;
+    for (std::size_t i = 0; i < Rows; ++i)
+      for (std::size_t j = 0; j < Cols; ++j)
+        result(j,i) = (*this)(i,j);
+    return result;
+  }
+
+private:
+  std::array<T,Rows*Cols> data_;
+};
+
+/**
+ * @brief Column vector of size known at compile time.
+ */
+template <std::size_t Size, class T = double>
+using FixedVector = FixedMatrix<Size,1,T>;
+
+template <std::size_t Rows, std::size_t Inner, std::size_t Cols, class T>
+FixedMatrix<Rows,Cols,T> operator*(const FixedMatrix<Rows,Inner,T>& a,
+                                   const FixedMatrix<Inner,Cols,T>& b)
+{
+  FixedMatrix<Rows,Cols,T> result;
+  for (std::size_t i = 0; i < Rows; ++i)
+    for (std::size_t k = 0; k < Inner; ++k)
+    {
+      const T aik = a(i,k);
+      for (std::size_t j = 0; j < Cols; ++j)
+        result(i,j) += aik*b(k,j);
+    }
+  return result;
+}
+
+template <std::size_t Rows, std::size_t Cols, class T>
+FixedMatrix<Rows,Cols,T> operator+(FixedMatrix<Rows,Cols,T> a,
+                                   const FixedMatrix<Rows,Cols,T>& b)
+{
+  return a += b;
+}
+
+template <std::size_t Rows, std::size_t Cols, class T>
+FixedMatrix<Rows,Cols,T> operator-(FixedMatrix<Rows,Cols,T> a,
+                                   const FixedMatrix<Rows,Cols,T>& b)
+{
+  return a -= b;
+}
+
+template <std::size_t Rows, std::size_t Cols, class T>
+FixedMatrix<Rows,Cols,T> operator*(FixedMatrix<Rows,Cols,T> a, T scalar)
+{
+  return a *= scalar;
+}
+
+/**
+ * @return A * M * trans(A) - e.g. covariance transformed by model A
+ */
+template <std::size_t Rows, std::size_t Cols, class T>
+FixedMatrix<Rows,Rows,T> sandwich(const FixedMatrix<Rows,Cols,T>& a,
+                                  const FixedMatrix<Cols,Cols,T>& m)
+{
+  return (a*m)*a.transposed();
+}
+
+/**
+ * @return v * trans(v)
+ */
+template <std::size_t Size, class T>
+FixedMatrix<Size,Size,T> outer(const FixedVector<Size,T>& v)
+{
+  FixedMatrix<Size,Size,T> result;
+  for (std::size_t i = 0; i < Size; ++i)
+    for (std::size_t j = 0; j < Size; ++j)
+      result(i,j) = v[i]*v[j];
+  return result;
+}
+
+/**
+ * @brief Inverts matrix with Gauss-Jordan elimination (partial pivoting).
+ * @param m - matrix to invert
+ * @param inverse - output
+ * @param determinant - output (optional)
+ * @return false when matrix is singular
+ */
+template <std::size_t Size, class T>
+bool invert(FixedMatrix<Size,Size,T> m, FixedMatrix<Size,Size,T>& inverse,
+            T* determinant = nullptr)
+{
+  inverse = FixedMatrix<Size,Size,T>::identity();
+  T det = 1;
+  for (std::size_t col = 0; col < Size; ++col)
+  {
+    std::size_t pivot = col;
+    for (std::size_t row = col + 1; row < Size; ++row)
+    {
+      if (std::abs(m(row,col)) > std::abs(m(pivot,col)))
+        pivot = row;
+    }
+    if (m(pivot,col) == T())
+      return false;
+
+    if (pivot != col)
+    {
+      for (std::size_t j = 0; j < Size; ++j)
+      {
+        std::swap(m(pivot,j),m(col,j));
+        std::swap(inverse(pivot,j),inverse(col,j));
+      }
+      det = -det;
+    }
+
+    const T diagonal = m(col,col);
+    det *= diagonal;
+    for (std::size_t j = 0; j < Size; ++j)
+    {
+      m(col,j) /= diagonal;
+      inverse(col,j) /= diagonal;
+    }
+
+    for (std::size_t row = 0; row < Size; ++row)
+    {
+      if (row == col)
+        continue;
+      const T factor = m(row,col);
+      if (factor == T())
+        continue;
+      for (std::size_t j = 0; j < Size; ++j)
+      {
+        m(row,j) -= factor*m(col,j);
+        inverse(row,j) -= factor*inverse(col,j);
+      }
+    }
+  }
+
+  if (determinant)
+    *determinant = det;
+  return true;
+}
+
+} // namespace estimation
+
+#endif // FIXEDMATRIX_HPP
@@ -1,15 +1,103 @@
 #include "fusionexecutor.h"
 
+FusionExecutor::FusionExecutor(bool combineDRs)
+  : combineDRs_(combineDRs),
+    featureExtractor_(new FeatureExtractor())
+{}
+
+FusionExecutor::~FusionExecutor()
+{}
+
 void FusionExecutor::fuseDRs(
     std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& collection)
 {
    for (auto& item : collection)
    {
-     std::shared_ptr<Track> track = item.first;
-     for (const DetectionReport& DR : item.second)
-     {
-       track->applyMeasurement(DR);
-     }
+     fuseTrack(*item.first,item.second);
    }
 
 }
+
+void FusionExecutor::fuseTrack(Track& track,
+                               const std::set<DetectionReport>& DRs) const
+{
+  if (combineDRs_ && DRs.size() > 1)
+  {
+    applyCombinedMeasurement(track,DRs);
+    for (const DetectionReport& DR : DRs)
+    {
+      track.updateFeatures(DR,featureExtractor_.get());
+    }
+    return;
+  }
+
+  for (const DetectionReport& DR : DRs)
+  {
+    track.applyMeasurement(DR,findSensorNoise(DR));
+    track.updateFeatures(DR,featureExtractor_.get());
+  }
+}
+
+void FusionExecutor::setFeatureExtractor(
+    std::unique_ptr<FeatureExtractor> extractor)
+{
+  featureExtractor_ = std::move(extractor);
+}
+
+void FusionExecutor::setSensorNoiseTable(
+    std::shared_ptr<const SensorNoiseTable> noises)
+{
+  sensorNoises_ = noises;
+}
+
+const SensorNoise*
+  FusionExecutor::findSensorNoise(const DetectionReport& DR) const
+{
+  return (sensorNoises_ ? sensorNoises_->find(DR.getSensorId()) : nullptr);
+}
+
+void FusionExecutor::applyCombinedMeasurement(
+    Track& track, const std::set<DetectionReport>& DRs) const
+{
+  bool noisesKnown = true;
+  const DetectionReport* latest = nullptr;
+  for (const DetectionReport& DR : DRs)
+  {
+    const SensorNoise* noise = findSensorNoise(DR);
+    noisesKnown = noisesKnown && noise
+                  && noise->positionVariance > 0 && noise->mosVariance > 0;
+    if (!latest || DR.getRawSensorTime() > latest->getRawSensorTime())
+      latest = &DR;
+  }
+
+  double lon = 0;
+  double lat = 0;
+  double mos = 0;
+  double positionWeights = 0;
+  double mosWeights = 0;
+  for (const DetectionReport& DR : DRs)
+  {
+    const SensorNoise* noise = (noisesKnown ? findSensorNoise(DR) : nullptr);
+    const double positionWeight = (noise ? 1/noise->positionVariance : 1);
+    const double mosWeight = (noise ? 1/noise->mosVariance : 1);
+    lon += positionWeight*DR.getLongitude();
+    lat += positionWeight*DR.getLatitude();
+    mos += mosWeight*DR.getMetersOverSea();
+    positionWeights += positionWeight;
+    mosWeights += mosWeight;
+  }
+
+  const DetectionReport centroid(latest->getSensorId(),latest->getDrId(),
+                                 lon/positionWeights,lat/positionWeights,
+                                 mos/mosWeights,
+                                 latest->getRawUploadTime(),
+                                 latest->getRawSensorTime(),
+                                 latest->getSensor());
+  if (noisesKnown)
+  { // variance of weighted mean is inverse of sum of weights
+    const SensorNoise noise = { 1/positionWeights,1/mosWeights,-1 };
+    track.applyMeasurement(centroid,&noise);
+  }
+  else
+    track.applyMeasurement(centroid);
+}
@@ -6,11 +6,21 @@
 #include <set>
 
 #include "detectionreport.h"
+#include "featureextractor.h"
+#include "sensornoisetable.h"
 #include "track.h"
 
 class FusionExecutor
 {
 public:
+  /**
+   * @param combineDRs - false: Track's filter is corrected with each DR
+   *  of it's interest; true: DRs of Track are combined into one
+   *  measurement first (see fuseTrack()), so filter is corrected once
+   */
+  explicit FusionExecutor(bool combineDRs = false);
+  virtual ~FusionExecutor();
+
   /**
    * @brief Makes detection reports fusion on given collection.
    *  Collection will be changed after this call!
@@ -18,10 +28,47 @@ public:
    *
    *  Method can be overloaded to achieve special type of fusion.
    *  Default fusion invokes correct() on estimation filter,
-   *  connected with Track for each DR of it's interest.
+   *  connected with Track for each DR of it's interest (or once, for
+   *  combined DRs) and takes features of DR into Track.
    */
   virtual void fuseDRs(std::map<std::shared_ptr<Track>,
                        std::set<DetectionReport> >&);
+
+  /**
+   * @brief Sets FeatureExtractor, used to fuse features of DRs into Track's.
+   * @param FeatureExtractor - takes ownership
+   */
+  void setFeatureExtractor(std::unique_ptr<FeatureExtractor> extractor);
+
+  /**
+   * @brief Sets noises of sensors, used to correct Tracks with noise
+   *  of sensor which reported DR (nullptr - filters' own noise is used).
+   */
+  void setSensorNoiseTable(std::shared_ptr<const SensorNoiseTable> noises);
+
+protected:
+  /**
+   * @brief Fuses DRs of one Track (measurements and features).
+   *
+   *  When DRs are combined, measurement is their centroid, weighted
+   *  by inverse variances of sensors, with variance of weighted mean
+   *  and the latest sensor time. When noise of any sensor is unknown,
+   *  it's plain mean, corrected with noise of filter.
+   */
+  void fuseTrack(Track& track, const std::set<DetectionReport>& DRs) const;
+
+  /**
+   * @return noise of DR's sensor, nullptr when it's unknown
+   */
+  const SensorNoise* findSensorNoise(const DetectionReport&) const;
+
+  const bool combineDRs_;
+  std::unique_ptr<FeatureExtractor> featureExtractor_;
+  std::shared_ptr<const SensorNoiseTable> sensorNoises_;
+
+private:
+  void applyCombinedMeasurement(Track& track,
+                                const std::set<DetectionReport>& DRs) const;
 };
 
 #endif // FUSIONEXECUTOR_H
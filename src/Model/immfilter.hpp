@@ -0,0 +1,532 @@
+#ifndef IMMFILTER_HPP
+#define IMMFILTER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "estimationfilter.hpp"
+#include "fixedmatrix.hpp"
+
+namespace estimation
+{
+
+/**
+ * @brief Interacting Multiple Model filter - bank of Kalman filters
+ *  with different motion models, mixed by probabilities of models
+ *  (which are updated by likelihood of each measurement).
+ *
+ * Models:
+ *  - constant velocity (cruising, stopped),
+ *  - constant acceleration (starting, braking),
+ *  - coordinated turn left and right with known turn rate
+ *    (in plane of first two axes).
+ *
+ * All models share one linear state: positions, velocities
+ *  and accelerations of each axis (StateModel layout is positions,
+ *  then velocities). Measurements are positions only (H = [I 0 0]).
+ *  Every model is computed with fixed-size matrices, so filter
+ *  doesn't allocate after construction.
+ *
+ * Usage is the same as of KalmanFilter.
+ */
+template <class StateModel = PositionAndVelocity3DModel>
+class IMMFilter : public EstimationFilter<StateModel>
+{
+public:
+  typedef typename EstimationFilter<StateModel>::vector_t vector_t;
+  typedef typename StateModel::values_type value_t;
+
+  enum
+  {
+    Axes = StateModel::Dimensions/2,
+    States = 3*Axes // positions, velocities, accelerations
+  };
+
+  enum Model
+  {
+    ConstantVelocity = 0,
+    ConstantAcceleration,
+    TurnLeft,
+    TurnRight,
+
+    ModelsCount // keep it last
+  };
+
+  typedef FixedMatrix<States,States,value_t> Matrix;
+  typedef FixedVector<States,value_t> Vector;
+
+  struct Parameters
+  {
+    Parameters()
+      : measurementNoise(0.001),
+        velocityNoise(0.001),
+        accelerationNoise(0.001),
+        turnNoise(0.001),
+        turnRate(0.3),
+        switchProbability(0.05),
+        timeStep(1)
+    {}
+
+    value_t measurementNoise; // variance of measured position (each axis)
+    value_t velocityNoise; // acceleration variance of constant velocity model
+    value_t accelerationNoise; // jerk variance of constant acceleration model
+    value_t turnNoise; // acceleration variance of turn models
+    value_t turnRate; // of turn models [rad per time unit]
+    value_t switchProbability; // of leaving model between two predictions
+    value_t timeStep; // of predict() without arguments
+  };
+
+  explicit IMMFilter(const Parameters& parameters = Parameters())
+    : initialized_(false),
+      parameters_(parameters)
+  {
+    static_assert(Axes >= 2,"Turn models need at least two axes");
+    buildModels(parameters_.timeStep);
+
+    // the same probability of switching to any other model
+    const value_t stay = 1 - parameters_.switchProbability;
+    const value_t leave = parameters_.switchProbability/(ModelsCount - 1);
+    for (std::size_t i = 0; i < ModelsCount; ++i)
+      for (std::size_t j = 0; j < ModelsCount; ++j)
+        switching_[i][j] = (i == j ? stay : leave);
+
+    probabilities_.fill(value_t(1)/ModelsCount);
+    predictedProbabilities_ = probabilities_;
+  }
+
+  virtual ~IMMFilter()
+  {}
+
+  virtual std::pair<vector_t,vector_t> predict(const vector_t* = nullptr)
+  {
+    return predictFor(parameters_.timeStep);
+  }
+
+  virtual std::pair<vector_t,vector_t> predictFor(value_t timeStep)
+  {
+    assert(initialized_);
+    if (timeStep != modelsTimeStep_)
+      buildModels(timeStep); // closed form, in place
+
+    // mixing - each model starts from combination of all models' estimates,
+    //  weighted by probability of switching from them
+    std::array<Vector,ModelsCount> mixedStates;
+    std::array<Matrix,ModelsCount> mixedCovariances;
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      value_t normalizer = 0;
+      for (std::size_t i = 0; i < ModelsCount; ++i)
+        normalizer += switching_[i][j]*probabilities_[i];
+      predictedProbabilities_[j] = normalizer;
+
+      std::array<value_t,ModelsCount> weights;
+      for (std::size_t i = 0; i < ModelsCount; ++i)
+        weights[i] = switching_[i][j]*probabilities_[i]/normalizer;
+
+      Vector mixed;
+      for (std::size_t i = 0; i < ModelsCount; ++i)
+        mixed += states_[i]*weights[i];
+
+      Matrix covariance;
+      for (std::size_t i = 0; i < ModelsCount; ++i)
+      {
+        const Vector spread = states_[i] - mixed;
+        covariance += (covariances_[i] + outer(spread))*weights[i];
+      }
+
+      mixedStates[j] = mixed;
+      mixedCovariances[j] = covariance;
+    }
+
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      predictedStates_[j] = transitions_[j]*mixedStates[j];
+      predictedCovariances_[j] = sandwich(transitions_[j],mixedCovariances[j])
+                                 + processNoises_[j];
+    }
+
+    return combine(predictedStates_,predictedCovariances_,
+                   predictedProbabilities_);
+  }
+
+  virtual std::pair<vector_t,vector_t> correct(const vector_t& z)
+  {
+    std::array<value_t,Axes> noise;
+    noise.fill(parameters_.measurementNoise);
+    return correctWith(z,noise);
+  }
+
+  // IMM doesn't cache gains, so noise class is not needed
+  virtual std::pair<vector_t,vector_t>
+    correct(const vector_t& z, const vector_t& measurementVariance,
+            int /*noiseClass*/)
+  {
+    std::array<value_t,Axes> noise;
+    for (std::size_t a = 0; a < Axes; ++a)
+      noise[a] = measurementVariance[a];
+    return correctWith(z,noise);
+  }
+
+  virtual std::pair<vector_t,vector_t>
+    initialize(vector_t state, vector_t varianceError)
+  {
+    Vector x;
+    Matrix P;
+    for (std::size_t i = 0; i < std::size_t(StateModel::Dimensions); ++i)
+    {
+      x[i] = state[i];
+      P(i,i) = varianceError[i];
+    }
+    // accelerations are unknown, but process noise makes them uncertain
+
+    states_.fill(x);
+    covariances_.fill(P);
+
+    // most of the time vehicles are cruising
+    const value_t other = value_t(0.3)/(ModelsCount - 1);
+    probabilities_.fill(other);
+    probabilities_[ConstantVelocity] = 1 - other*(ModelsCount - 1);
+
+    initialized_ = true;
+    return predict();
+  }
+
+  virtual std::pair<vector_t,vector_t>
+    constrainPrediction(const std::vector<vector_t>& D,
+                        const std::vector<value_t>& d)
+  {
+    assert(initialized_);
+    assert(D.size() == d.size());
+
+    // estimate projection of each model's prediction,
+    //  the same as in KalmanFilter (accelerations are not constrained)
+    for (std::size_t c = 0; c < D.size(); ++c)
+    {
+      Vector row;
+      for (std::size_t i = 0; i < std::size_t(StateModel::Dimensions); ++i)
+        row[i] = D[c][i];
+
+      for (std::size_t j = 0; j < ModelsCount; ++j)
+      {
+        Vector& x = predictedStates_[j];
+        Matrix& P = predictedCovariances_[j];
+
+        const Vector PDt = P*row;
+        value_t DPDt = 0;
+        value_t residual = -d[c];
+        for (std::size_t i = 0; i < States; ++i)
+        {
+          DPDt += row[i]*PDt[i];
+          residual += row[i]*x[i];
+        }
+        if (DPDt <= 0)
+          continue; // prediction is already certain in constrained direction
+
+        x -= PDt*(residual/DPDt);
+        P -= outer(PDt)*(1/DPDt);
+      }
+    }
+
+    return combine(predictedStates_,predictedCovariances_,
+                   predictedProbabilities_);
+  }
+
+  /**
+   * @return probabilities of models after the last correction
+   */
+  const std::array<value_t,ModelsCount>& getModelProbabilities() const
+  {
+    return probabilities_;
+  }
+
+  const Parameters& getParameters() const
+  {
+    return parameters_;
+  }
+
+  /*
+   * Layout: models count, then for each model:
+   *  mu, c, x(n), P(n*n), x'(n), P'(n*n) - matrices row by row;
+   *  where mu is corrected and c predicted probability of model.
+   */
+  virtual std::vector<value_t> exportState() const
+  {
+    assert(initialized_);
+    std::vector<value_t> result;
+    result.reserve(1 + ModelsCount*(2 + 2*States + 2*States*States));
+    result.push_back(ModelsCount);
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      result.push_back(probabilities_[j]);
+      result.push_back(predictedProbabilities_[j]);
+      exportValues(states_[j],result);
+      exportValues(covariances_[j],result);
+      exportValues(predictedStates_[j],result);
+      exportValues(predictedCovariances_[j],result);
+    }
+
+    return result;
+  }
+
+  virtual bool importState(const std::vector<value_t>& state)
+  {
+    if (state.empty() || std::size_t(state[0]) != ModelsCount
+        || state.size() != 1 + ModelsCount*(2 + 2*States + 2*States*States))
+      return false;
+
+    typename std::vector<value_t>::const_iterator iter = state.begin() + 1;
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      probabilities_[j] = *iter++;
+      predictedProbabilities_[j] = *iter++;
+      importValues(iter,states_[j]);
+      importValues(iter,covariances_[j]);
+      importValues(iter,predictedStates_[j]);
+      importValues(iter,predictedCovariances_[j]);
+    }
+
+    initialized_ = true;
+    return true;
+  }
+
+  virtual std::unique_ptr<EstimationFilter<StateModel> > clone() const
+  {
+    std::unique_ptr<EstimationFilter<StateModel> > result(
+          new IMMFilter<StateModel>(*this));
+    return result;
+  }
+
+private:
+  static std::size_t position(std::size_t axis)
+  {
+    return axis;
+  }
+
+  static std::size_t velocity(std::size_t axis)
+  {
+    return Axes + axis;
+  }
+
+  static std::size_t acceleration(std::size_t axis)
+  {
+    return 2*Axes + axis;
+  }
+
+  // transition and process noise of every model, for given time step
+  void buildModels(value_t T)
+  {
+    modelsTimeStep_ = T;
+    const value_t halfT2 = T*T/2;
+
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      Matrix& A = transitions_[j];
+      Matrix& Q = processNoises_[j];
+      A = Matrix();
+      Q = Matrix();
+
+      // gain of noise (acceleration or jerk) on position, velocity
+      //  and acceleration of one axis: Q = q * g * trans(g)
+      std::array<value_t,3> gain = {{ halfT2, T, 0 }};
+      value_t noise = parameters_.velocityNoise;
+      if (j == ConstantAcceleration)
+      {
+        gain[0] = T*T*T/6;
+        gain[1] = halfT2;
+        gain[2] = T;
+        noise = parameters_.accelerationNoise;
+      }
+      else if (j == TurnLeft || j == TurnRight)
+        noise = parameters_.turnNoise;
+
+      for (std::size_t axis = 0; axis < Axes; ++axis)
+      {
+        const std::size_t indices[3] = { position(axis), velocity(axis),
+                                         acceleration(axis) };
+        for (std::size_t r = 0; r < 3; ++r)
+          for (std::size_t c = 0; c < 3; ++c)
+            Q(indices[r],indices[c]) = noise*gain[r]*gain[c];
+
+        A(position(axis),position(axis)) = 1;
+        A(position(axis),velocity(axis)) = T;
+        A(velocity(axis),velocity(axis)) = 1;
+        if (j == ConstantAcceleration)
+        {
+          A(position(axis),acceleration(axis)) = halfT2;
+          A(velocity(axis),acceleration(axis)) = T;
+          A(acceleration(axis),acceleration(axis)) = 1;
+        } // other models drop acceleration
+      }
+
+      if (j == TurnLeft || j == TurnRight)
+      { // rotation of velocity in plane of the first two axes
+        const value_t omega = (j == TurnLeft ? 1 : -1)*parameters_.turnRate;
+        const value_t s = std::sin(omega*T);
+        const value_t c = std::cos(omega*T);
+        const value_t sOverOmega = (omega != 0 ? s/omega : T);
+        const value_t cOverOmega = (omega != 0 ? (1 - c)/omega : 0);
+
+        A(position(0),velocity(0)) = sOverOmega;
+        A(position(0),velocity(1)) = -cOverOmega;
+        A(position(1),velocity(0)) = cOverOmega;
+        A(position(1),velocity(1)) = sOverOmega;
+        A(velocity(0),velocity(0)) = c;
+        A(velocity(0),velocity(1)) = -s;
+        A(velocity(1),velocity(0)) = s;
+        A(velocity(1),velocity(1)) = c;
+      }
+    }
+  }
+
+  /*
+   * Corrects all models with measurement of given variance (per axis)
+   *  and updates probabilities of models by likelihoods of measurement.
+   */
+  std::pair<vector_t,vector_t>
+    correctWith(const vector_t& z, const std::array<value_t,Axes>& noise)
+  {
+    assert(initialized_);
+
+    std::array<value_t,ModelsCount> logLikelihoods;
+    value_t maximum = -std::numeric_limits<value_t>::infinity();
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+    {
+      logLikelihoods[j] = correctModel(j,z,noise);
+      maximum = std::max(maximum,logLikelihoods[j]);
+    }
+
+    if (maximum == -std::numeric_limits<value_t>::infinity())
+      probabilities_ = predictedProbabilities_; // measurement told nothing
+    else
+    {
+      // likelihoods are relative to the best one, so they never underflow
+      value_t sum = 0;
+      for (std::size_t j = 0; j < ModelsCount; ++j)
+      {
+        probabilities_[j] = predictedProbabilities_[j]
+                            * std::exp(logLikelihoods[j] - maximum);
+        sum += probabilities_[j];
+      }
+      for (std::size_t j = 0; j < ModelsCount; ++j)
+        probabilities_[j] /= sum;
+    }
+
+    return combine(states_,covariances_,probabilities_);
+  }
+
+  /*
+   * Kalman correction of one model with H = [I 0 0].
+   * Returns log-likelihood of z in this model (without constant part),
+   *  or -infinity when innovation covariance is singular.
+   */
+  value_t correctModel(std::size_t j, const vector_t& z,
+                       const std::array<value_t,Axes>& noise)
+  {
+    const Vector& predicted = predictedStates_[j];
+    const Matrix& P = predictedCovariances_[j];
+
+    // P'*trans(H) - the first Axes columns of P'
+    FixedMatrix<States,Axes,value_t> PHt;
+    for (std::size_t i = 0; i < States; ++i)
+      for (std::size_t a = 0; a < Axes; ++a)
+        PHt(i,a) = P(i,position(a));
+
+    // S = H*P'*trans(H) + R
+    FixedMatrix<Axes,Axes,value_t> S;
+    FixedVector<Axes,value_t> residual;
+    for (std::size_t a = 0; a < Axes; ++a)
+    {
+      for (std::size_t b = 0; b < Axes; ++b)
+        S(a,b) = PHt(position(a),b);
+      S(a,a) += noise[a];
+      residual[a] = z[a] - predicted[position(a)];
+    }
+
+    FixedMatrix<Axes,Axes,value_t> inverse;
+    value_t determinant = 0;
+    if (!invert(S,inverse,&determinant) || determinant <= 0)
+    {
+      states_[j] = predicted;
+      covariances_[j] = P;
+      return -std::numeric_limits<value_t>::infinity();
+    }
+
+    const FixedMatrix<States,Axes,value_t> K = PHt*inverse; // Kalman gain
+    states_[j] = predicted + K*residual;
+    // P = (I - K*H)*P' = P' - K*trans(P'*trans(H))
+    covariances_[j] = P - K*PHt.transposed();
+
+    const FixedVector<Axes,value_t> weighted = inverse*residual;
+    value_t distance = 0; // Mahalanobis
+    for (std::size_t a = 0; a < Axes; ++a)
+      distance += residual[a]*weighted[a];
+
+    return -(distance + std::log(determinant))/2;
+  }
+
+  // combined estimate (and it's variance) of all models
+  std::pair<vector_t,vector_t>
+    combine(const std::array<Vector,ModelsCount>& states,
+            const std::array<Matrix,ModelsCount>& covariances,
+            const std::array<value_t,ModelsCount>& probabilities) const
+  {
+    Vector x;
+    for (std::size_t j = 0; j < ModelsCount; ++j)
+      x += states[j]*probabilities[j];
+
+    vector_t state;
+    vector_t variance;
+    variance.fill(0);
+    for (std::size_t i = 0; i < std::size_t(StateModel::Dimensions); ++i)
+    {
+      state[i] = x[i];
+      for (std::size_t j = 0; j < ModelsCount; ++j)
+      {
+        const value_t spread = states[j][i] - x[i];
+        variance[i] += probabilities[j]*(covariances[j](i,i) + spread*spread);
+      }
+    }
+
+    return std::pair<vector_t,vector_t>(state,variance);
+  }
+
+  template <std::size_t Rows, std::size_t Cols>
+  static void exportValues(const FixedMatrix<Rows,Cols,value_t>& m,
+                           std::vector<value_t>& into)
+  {
+    for (std::size_t i = 0; i < Rows; ++i)
+      for (std::size_t j = 0; j < Cols; ++j)
+        into.push_back(m(i,j));
+  }
+
+  template <std::size_t Rows, std::size_t Cols>
+  static void importValues(typename std::vector<value_t>::const_iterator& from,
+                           FixedMatrix<Rows,Cols,value_t>& m)
+  {
+    for (std::size_t i = 0; i < Rows; ++i)
+      for (std::size_t j = 0; j < Cols; ++j)
+        m(i,j) = *from++;
+  }
+
+  bool initialized_;
+  Parameters parameters_;
+
+  value_t modelsTimeStep_; // for which models are built
+  std::array<Matrix,ModelsCount> transitions_; // A of each model
+  std::array<Matrix,ModelsCount> processNoises_; // Q of each model
+  // probability of switching from model i to model j
+  std::array<std::array<value_t,ModelsCount>,ModelsCount> switching_;
+
+  std::array<Vector,ModelsCount> states_; // X(k) (a posteriori)
+  std::array<Matrix,ModelsCount> covariances_; // P(k) (a posteriori)
+  std::array<Vector,ModelsCount> predictedStates_; // X'(k) (a priori)
+  std::array<Matrix,ModelsCount> predictedCovariances_; // P'(k) (a priori)
+  std::array<value_t,ModelsCount> probabilities_; // mu (a posteriori)
+  std::array<value_t,ModelsCount> predictedProbabilities_; // c (a priori)
+};
+
+} // namespace estimation
+
+#endif // IMMFILTER_HPP
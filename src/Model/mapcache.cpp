@@ -0,0 +1,165 @@
+#include "mapcache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream> // used for logging purpose
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Common/logger.h>
+
+namespace Model
+{
+
+const std::uint32_t MapCache::version;
+const char MapCache::magic_[8] = { 'T','0','M','M','A','P','\0','\0' };
+
+MapCache::MapCache(const std::string& path)
+  : path_(path)
+{}
+
+MapPtr MapCache::load(const MapFingerprint& fingerprint) const
+{
+  int fd = open(path_.c_str(),O_RDONLY);
+  if (fd < 0)
+    return MapPtr();
+
+  struct stat fileStat;
+  if (fstat(fd,&fileStat) != 0
+      || static_cast<std::size_t>(fileStat.st_size) < sizeof(Header))
+  {
+    close(fd);
+    return MapPtr();
+  }
+
+  const std::size_t fileSize = fileStat.st_size;
+  void* data = mmap(nullptr,fileSize,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd); // mapping stays valid after closing descriptor
+  if (data == MAP_FAILED)
+    return MapPtr();
+
+  MapPtr result;
+  const char* bytes = static_cast<const char*>(data);
+  const Header* header = reinterpret_cast<const Header*>(bytes);
+  const std::size_t expectedSize = sizeof(Header)
+      + header->nodesCount*sizeof(NodeRecord)
+      + header->edgesCount*sizeof(EdgeRecord);
+
+  const bool compatible = std::memcmp(header->magic,magic_,sizeof(magic_)) == 0
+      && header->version == version
+      && expectedSize == fileSize;
+  if (compatible && header->fingerprint != fingerprint)
+  { // TODO rewrite this, when logger will be more sophisticated
+    Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+    std::stringstream m;
+    m << "Map cache " << path_ << " is stale (map in DB changed)";
+    logger.log("MapCache",m.str());
+  }
+  else if (compatible)
+  {
+    const NodeRecord* nodeRecords
+        = reinterpret_cast<const NodeRecord*>(bytes + sizeof(Header));
+    const EdgeRecord* edgeRecords
+        = reinterpret_cast<const EdgeRecord*>(nodeRecords
+                                              + header->nodesCount);
+
+    try
+    {
+      StreetNodes vertexes;
+      vertexes.reserve(header->nodesCount);
+      for (std::size_t i = 0; i < header->nodesCount; ++i)
+      {
+        const NodeRecord& node = nodeRecords[i];
+        vertexes.push_back(std::make_shared<StreetNode>(node.nodeId,
+                                                        node.lon,
+                                                        node.lat,
+                                                        node.mos));
+      }
+
+      Streets edges;
+      edges.reserve(header->edgesCount);
+      for (std::size_t i = 0; i < header->edgesCount; ++i)
+      {
+        const EdgeRecord& edge = edgeRecords[i];
+        if (edge.first >= vertexes.size() || edge.second >= vertexes.size())
+          throw GeneralException("Street endpoint out of nodes range");
+
+        edges.push_back(std::make_shared<Street>(vertexes[edge.first],
+                                                 vertexes[edge.second]));
+      }
+
+      result = std::make_shared<Map>(vertexes,edges);
+    }
+    catch (std::exception& e)
+    { // corrupted cache - will be read from DB again
+      Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+      std::stringstream m;
+      m << "Map cache " << path_ << " is corrupted: " << e.what();
+      logger.log("MapCache",m.str());
+    }
+  }
+
+  munmap(data,fileSize);
+  return result;
+}
+
+bool MapCache::store(const MapPtr map, const MapFingerprint& fingerprint) const
+{
+  Header header;
+  std::memset(&header,0,sizeof(header)); // no garbage in padding
+  std::memcpy(header.magic,magic_,sizeof(magic_));
+  header.version = version;
+  header.reserved = 0;
+  header.nodesCount = map->vertexes.size();
+  header.edgesCount = map->edges.size();
+  header.fingerprint = fingerprint;
+
+  std::vector<NodeRecord> nodeRecords;
+  nodeRecords.reserve(map->vertexes.size());
+  for (const StreetNodePtr& node : map->vertexes)
+  {
+    NodeRecord record;
+    record.nodeId = node->nodeId;
+    record.reserved = 0;
+    record.lon = node->lon.get();
+    record.lat = node->lat.get();
+    record.mos = node->mos.get();
+    nodeRecords.push_back(record);
+  }
+
+  std::vector<EdgeRecord> edgeRecords;
+  edgeRecords.reserve(map->edges.size());
+  for (const StreetPtr& street : map->edges)
+  {
+    EdgeRecord record;
+    // Map keeps positions of its nodes, so no need to search for them
+    record.first = map->vertexIndex(street->first->nodeId);
+    record.second = map->vertexIndex(street->second->nodeId);
+    edgeRecords.push_back(record);
+  }
+
+  const std::string tmpPath = path_ + ".tmp";
+  {
+    std::ofstream file(tmpPath.c_str(),std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    file.write(reinterpret_cast<const char*>(nodeRecords.data()),
+               nodeRecords.size()*sizeof(NodeRecord));
+    file.write(reinterpret_cast<const char*>(edgeRecords.data()),
+               edgeRecords.size()*sizeof(EdgeRecord));
+    file.close();
+    if (!file)
+    {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+
+  return std::rename(tmpPath.c_str(),path_.c_str()) == 0;
+}
+
+} // namespace Model
@@ -0,0 +1,82 @@
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include <3rdparty/DBDataStructures.h>
+
+namespace Model
+{
+
+/**
+ * @brief Binary file with static Map, to not query static DB at each start.
+ *
+ * File layout (native endianness, cache is not meant to be portable):
+ *  Header
+ *  NodeRecord[nodesCount]
+ *  EdgeRecord[edgesCount] - endpoints as positions in NodeRecord array
+ *
+ * File is mapped into memory (mmap) while reading.
+ * Files with other magic or version are treated as not existing,
+ * so changing format requires only incrementing version.
+ * Header keeps fingerprint of map in static DB, so cache is rejected
+ * (and written again), when map in DB changed.
+ */
+class MapCache
+{
+public:
+  static const std::uint32_t version = 2;
+
+  explicit MapCache(const std::string& path);
+
+  /**
+   * @param fingerprint of map in static DB
+   * @return Map read from cache file or empty pointer,
+   *  when file does not exist, is incompatible (or corrupted),
+   *  or it was written for map of other fingerprint (stale).
+   */
+  MapPtr load(const MapFingerprint& fingerprint) const;
+
+  /**
+   * @brief Writes map to temporary file, and then replaces cache file with it,
+   *  so readers never see partially written cache.
+   * @param fingerprint of map in static DB, read before map
+   * @return true if cache was written successfully
+   */
+  bool store(const MapPtr map, const MapFingerprint& fingerprint) const;
+
+private:
+  struct Header
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nodesCount;
+    std::uint64_t edgesCount;
+    MapFingerprint fingerprint;
+  };
+
+  struct NodeRecord
+  {
+    std::int32_t nodeId;
+    std::int32_t reserved;
+    double lon;
+    double lat;
+    double mos;
+  };
+
+  struct EdgeRecord
+  {
+    std::uint32_t first;
+    std::uint32_t second;
+  };
+
+  static const char magic_[8];
+
+  const std::string path_;
+};
+
+} // namespace Model
+
+#endif // MAPCACHE_H
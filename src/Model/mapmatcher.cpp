@@ -0,0 +1,82 @@
+#include "mapmatcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <Model/track.h>
+
+namespace Model
+{
+
+MapMatcher::MapMatcher(MapPtr map, double maximumDistance)
+  : map_(map),
+    grid_(maximumDistance),
+    maximumDistance_(maximumDistance)
+{
+  segments_.reserve(map_->edges.size());
+  for (const StreetPtr& street : map_->edges)
+  {
+    Segment segment = { street->first->lon.get(), street->first->lat.get(),
+                        street->second->lon.get(), street->second->lat.get() };
+    grid_.insert(std::min(segment.lon1,segment.lon2),
+                 std::min(segment.lat1,segment.lat2),
+                 std::max(segment.lon1,segment.lon2),
+                 std::max(segment.lat1,segment.lat2),
+                 segments_.size());
+    segments_.push_back(segment);
+  }
+}
+
+bool MapMatcher::findNearestStreet(double lon, double lat,
+                                   Projection& result) const
+{
+  bool found = false;
+  result.distance = maximumDistance_;
+
+  grid_.query(lon-maximumDistance_,lat-maximumDistance_,
+              lon+maximumDistance_,lat+maximumDistance_,
+              [&](std::size_t edge)
+              {
+                const Segment& segment = segments_[edge];
+                const double dLon = segment.lon2 - segment.lon1;
+                const double dLat = segment.lat2 - segment.lat1;
+                const double length = std::sqrt(dLon*dLon + dLat*dLat);
+                if (length == 0)
+                  return; // there is no direction to snap to
+
+                // position of projection along the segment, clamped to it
+                double t = ((lon-segment.lon1)*dLon + (lat-segment.lat1)*dLat)
+                           / (length*length);
+                t = std::max(0.0,std::min(1.0,t));
+
+                const double pLon = segment.lon1 + t*dLon;
+                const double pLat = segment.lat1 + t*dLat;
+                const double distance = std::sqrt((lon-pLon)*(lon-pLon)
+                                                  + (lat-pLat)*(lat-pLat));
+                if (distance <= result.distance)
+                {
+                  found = true;
+                  result.edge = edge;
+                  result.lon = pLon;
+                  result.lat = pLat;
+                  result.directionLon = dLon/length;
+                  result.directionLat = dLat/length;
+                  result.distance = distance;
+                }
+              });
+
+  return found;
+}
+
+bool MapMatcher::matchTrack(Track& track) const
+{
+  Projection projection;
+  if (!findNearestStreet(track.getLongitude(),track.getLatitude(),projection))
+    return false;
+
+  track.snapTo(projection.lon,projection.lat,
+               projection.directionLon,projection.directionLat);
+  return true;
+}
+
+} // namespace Model
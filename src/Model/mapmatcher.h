@@ -0,0 +1,71 @@
+#ifndef MAPMATCHER_H
+#define MAPMATCHER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <Common/spatialgrid.hpp>
+
+#include <3rdparty/DBDataStructures.h>
+
+class Track;
+
+namespace Model
+{
+
+/**
+ * @brief Snaps Tracks onto the nearest street from static Map.
+ *  Streets (segments) are indexed in uniform grid, with cell size equal
+ *  to maximum snapping distance, so finding nearest street checks only
+ *  segments from cells around Track.
+ */
+class MapMatcher
+{
+public:
+  struct Projection
+  {
+    std::size_t edge; // position of street in Map::edges
+    double lon; // nearest point on street
+    double lat;
+    double directionLon; // normalized direction of street
+    double directionLat;
+    double distance; // from given point to nearest point on street
+  };
+
+  /**
+   * @param map with streets
+   * @param Tracks farther from any street than this distance are not snapped
+   */
+  MapMatcher(MapPtr map, double maximumDistance);
+
+  /**
+   * @brief Finds street nearest to given point, not farther than maximum
+   *  distance.
+   * @return true if street was found (and result was set)
+   */
+  bool findNearestStreet(double lon, double lat, Projection& result) const;
+
+  /**
+   * @brief Snaps Track position and prediction onto the nearest street.
+   * @return true if Track was snapped
+   */
+  bool matchTrack(Track& track) const;
+
+private:
+  struct Segment
+  {
+    double lon1;
+    double lat1;
+    double lon2;
+    double lat2;
+  };
+
+  MapPtr map_;
+  std::vector<Segment> segments_;
+  Common::SpatialGrid<std::size_t> grid_; // indices of segments
+  const double maximumDistance_;
+};
+
+} // namespace Model
+
+#endif // MAPMATCHER_H
@@ -23,6 +23,28 @@ public:
   virtual Snapshot computeState(time_types::ptime_t currentTime
                                   = time_types::ptime_t()) = 0;
 
+  /**
+   * @brief Processes next packet of DRs (only one), without taking snapshot.
+   *  Used by batch replay, which advances Model as fast as data allows.
+   * @return false, when no DRs were available.
+   */
+  virtual bool processNextPacket() = 0;
+
+  /**
+   * @brief Returns Model's clock - sensor time of the latest processed DR.
+   *  Default (not-a-date) value, until any DR was processed.
+   */
+  virtual time_types::ptime_t getModelTime() const = 0;
+
+  /**
+   * @brief Removes expired Tracks and takes snapshot of Model,
+   *  without processing any new data.
+   * @param Current time - the same as in computeState().
+   * @return Snapshot of Model.
+   */
+  virtual Snapshot takeSnapshot(time_types::ptime_t currentTime
+                                  = time_types::ptime_t()) = 0;
+
   /**
    * @brief Returns Model's snapshot after last computation.
    * @return Snapshot of Model after last computation.
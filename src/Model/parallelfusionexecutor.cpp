@@ -0,0 +1,64 @@
+#include "parallelfusionexecutor.h"
+
+#include <algorithm>
+#include <exception>
+
+ParallelFusionExecutor::ParallelFusionExecutor(
+    std::shared_ptr<Common::TaskScheduler> scheduler,
+    std::size_t chunkSize,
+    bool combineDRs)
+  : FusionExecutor(combineDRs),
+    scheduler_(scheduler),
+    chunkSize_(std::max<std::size_t>(chunkSize,1))
+{}
+
+ParallelFusionExecutor::~ParallelFusionExecutor()
+{}
+
+void ParallelFusionExecutor::fuseDRs(
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& collection)
+{
+  if (!scheduler_ || collection.size() <= chunkSize_)
+  {
+    FusionExecutor::fuseDRs(collection);
+    return;
+  }
+
+  tracks_.clear();
+  for (auto& item : collection)
+  {
+    tracks_.push_back(std::make_pair(item.first.get(),&item.second));
+  }
+
+  scheduler_->parallelFor(0,tracks_.size(),chunkSize_,
+                          [this](std::size_t begin, std::size_t end)
+  {
+    fuseChunk(begin,end);
+  });
+}
+
+unsigned ParallelFusionExecutor::getThreadsCount() const
+{
+  return (scheduler_ ? scheduler_->getThreadsCount() : 1);
+}
+
+void ParallelFusionExecutor::fuseChunk(std::size_t begin,
+                                       std::size_t end) const
+{
+  std::exception_ptr error;
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    try
+    {
+      fuseTrack(*tracks_[i].first,*tracks_[i].second);
+    }
+    catch (...)
+    {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
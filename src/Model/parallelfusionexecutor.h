@@ -0,0 +1,65 @@
+#ifndef PARALLELFUSIONEXECUTOR_H
+#define PARALLELFUSIONEXECUTOR_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Common/taskscheduler.h>
+
+#include "fusionexecutor.h"
+
+/**
+ * @brief FusionExecutor fusing DRs into Tracks in parallel.
+ *
+ * Update of each Track is independent, so Tracks are split into chunks
+ * of neighbouring Tracks, which are fused by threads of TaskScheduler
+ * (and by thread calling fuseDRs()). fuseDRs() returns, when all Tracks
+ * are fused. Small collections (up to one chunk) are fused serially.
+ */
+class ParallelFusionExecutor : public FusionExecutor
+{
+public:
+  enum { DefaultChunkSize = 32 };
+
+  /**
+   * @param scheduler - threads fusing Tracks (may be shared
+   *  with other stages of tracking)
+   * @param chunkSize - how many Tracks thread takes at once
+   * @param combineDRs - see FusionExecutor
+   */
+  explicit ParallelFusionExecutor(
+      std::shared_ptr<Common::TaskScheduler> scheduler,
+      std::size_t chunkSize = DefaultChunkSize,
+      bool combineDRs = false);
+  virtual ~ParallelFusionExecutor();
+
+  /**
+   * @brief The same as FusionExecutor::fuseDRs(), but in parallel.
+   *  Rethrows exception thrown while fusing any Track
+   *  (other Tracks are fused anyway).
+   */
+  virtual void fuseDRs(std::map<std::shared_ptr<Track>,
+                       std::set<DetectionReport> >&);
+
+  /**
+   * @return number of threads of scheduler fusing Tracks
+   */
+  unsigned getThreadsCount() const;
+
+private:
+  /**
+   * @brief Fuses Tracks [begin,end) of the current fuseDRs() call.
+   */
+  void fuseChunk(std::size_t begin, std::size_t end) const;
+
+  std::shared_ptr<Common::TaskScheduler> scheduler_;
+  const std::size_t chunkSize_;
+
+  // Tracks of the current fuseDRs() call, kept to avoid allocations
+  std::vector<
+        std::pair<Track*,const std::set<DetectionReport>*>
+      > tracks_;
+};
+
+#endif // PARALLELFUSIONEXECUTOR_H
@@ -0,0 +1,203 @@
+#include "platematcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+
+namespace
+{
+
+/**
+ * @brief Classic dynamic programming, for plates longer than 64 characters.
+ */
+std::size_t dynamicDistance(const std::string& a, const std::string& b,
+                            std::size_t bound)
+{
+  std::vector<std::size_t> row(b.size() + 1);
+  for (std::size_t j = 0; j <= b.size(); ++j)
+    row[j] = j;
+
+  for (std::size_t i = 1; i <= a.size(); ++i)
+  {
+    std::size_t diagonal = row[0];
+    row[0] = i;
+    std::size_t rowMin = row[0];
+    for (std::size_t j = 1; j <= b.size(); ++j)
+    {
+      const std::size_t up = row[j];
+      row[j] = std::min(std::min(row[j] + 1,row[j-1] + 1),
+                        diagonal + (a[i-1] == b[j-1] ? 0 : 1));
+      diagonal = up;
+      rowMin = std::min(rowMin,row[j]);
+    }
+    if (rowMin > bound)
+      return bound + 1;
+  }
+
+  return std::min(row[b.size()],bound + 1);
+}
+
+} // anonymous namespace
+
+std::string canonicalPlate(const std::string& plate)
+{
+  std::string result;
+  result.reserve(plate.size());
+  for (char c : plate)
+  {
+    if (!std::isalnum(static_cast<unsigned char>(c)))
+      continue; // separators are skipped
+
+    c = std::toupper(static_cast<unsigned char>(c));
+    switch (c)
+    {
+      case 'O': c = '0'; break;
+      case 'B': c = '8'; break;
+      case 'I': c = '1'; break;
+      case 'S': c = '5'; break;
+      case 'Z': c = '2'; break;
+      default: break;
+    }
+    result.push_back(c);
+  }
+
+  return result;
+}
+
+std::size_t plateDistance(const std::string& a, const std::string& b,
+                          std::size_t bound)
+{
+  const std::string& pattern = (a.size() <= b.size()) ? a : b;
+  const std::string& text = (a.size() <= b.size()) ? b : a;
+  const std::size_t m = pattern.size();
+  const std::size_t n = text.size();
+
+  if (n - m > bound)
+    return bound + 1;
+  if (m == 0)
+    return n;
+  if (m > 64)
+    return dynamicDistance(pattern,text,bound);
+
+  // Myers' algorithm, in Hyyrö's formulation for global distance;
+  //  column of DP matrix is kept as bit vectors of vertical deltas
+  std::array<std::uint64_t,256> peq;
+  peq.fill(0);
+  for (std::size_t i = 0; i < m; ++i)
+    peq[static_cast<unsigned char>(pattern[i])] |= std::uint64_t(1) << i;
+
+  const std::uint64_t last = std::uint64_t(1) << (m - 1);
+  std::uint64_t pv = (m == 64) ? ~std::uint64_t(0)
+                               : ((std::uint64_t(1) << m) - 1);
+  std::uint64_t mv = 0;
+  std::size_t score = m;
+
+  for (std::size_t j = 0; j < n; ++j)
+  {
+    const std::uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+    const std::uint64_t xv = eq | mv;
+    const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    std::uint64_t ph = mv | ~(xh | pv);
+    std::uint64_t mh = pv & xh;
+
+    if (ph & last)
+      ++score;
+    else if (mh & last)
+      --score;
+
+    ph = (ph << 1) | 1; // first row of DP matrix grows by one
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+
+    // score can decrease by at most one per remaining character
+    if (score > bound + (n - j - 1))
+      return bound + 1;
+  }
+
+  return std::min(score,bound + 1);
+}
+
+double plateSimilarity(const std::string& a, const std::string& b)
+{
+  const std::size_t distance = plateDistance(a,b,maxPlateDistance);
+  return 1 - double(distance)/(maxPlateDistance + 1);
+}
+
+/******************************************************************************/
+
+PlateIndex::PlateIndex(std::size_t maxDistance)
+  : maxDistance_(maxDistance)
+{}
+
+void PlateIndex::add(const std::string& plate, const Track* track)
+{
+  Entry entry;
+  entry.plate = plate;
+  entry.track = track;
+  entries_.push_back(entry);
+
+  for (const std::string& variant : deletions(plate))
+  {
+    variants_[variant].push_back(entries_.size() - 1);
+  }
+}
+
+void PlateIndex::find(const std::string& plate,
+                      std::vector<const Track*>& candidates) const
+{
+  std::vector<std::size_t> found;
+  for (const std::string& variant : deletions(plate))
+  {
+    auto it = variants_.find(variant);
+    if (it != variants_.end())
+      found.insert(found.end(),it->second.begin(),it->second.end());
+  }
+  std::sort(found.begin(),found.end());
+  found.erase(std::unique(found.begin(),found.end()),found.end());
+
+  // shared variant doesn't guarantee distance - it's verified
+  for (std::size_t index : found)
+  {
+    const Entry& entry = entries_[index];
+    if (plateDistance(plate,entry.plate,maxDistance_) <= maxDistance_)
+      candidates.push_back(entry.track);
+  }
+}
+
+void PlateIndex::clear()
+{
+  entries_.clear();
+  variants_.clear();
+}
+
+std::size_t PlateIndex::size() const
+{
+  return entries_.size();
+}
+
+std::vector<std::string> PlateIndex::deletions(const std::string& plate) const
+{
+  std::vector<std::string> result(1,plate);
+  std::size_t begin = 0; // variants with the most deletions so far
+  for (std::size_t d = 0; d < maxDistance_; ++d)
+  {
+    const std::size_t end = result.size();
+    for (std::size_t v = begin; v < end; ++v)
+    {
+      const std::string variant = result[v];
+      for (std::size_t i = 0; i < variant.size(); ++i)
+      {
+        std::string shorter = variant;
+        shorter.erase(i,1);
+        result.push_back(shorter);
+      }
+    }
+    begin = end;
+  }
+
+  std::sort(result.begin(),result.end());
+  result.erase(std::unique(result.begin(),result.end()),result.end());
+  return result;
+}
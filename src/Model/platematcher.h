@@ -0,0 +1,92 @@
+#ifndef PLATEMATCHER_H
+#define PLATEMATCHER_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Track;
+
+/**
+ * @brief The biggest edit distance between plates, which are still
+ *  considered to be the same (OCR of plates is noisy).
+ */
+const std::size_t maxPlateDistance = 2;
+
+/**
+ * @brief Returns plate in canonical form: upper case, without separators
+ *  (spaces, dashes etc.), with characters often confused by OCR replaced
+ *  by one of them (O -> 0, B -> 8, I -> 1, S -> 5, Z -> 2).
+ *  Plates are compared only in this form.
+ */
+std::string canonicalPlate(const std::string& plate);
+
+/**
+ * @brief Computes edit (Levenshtein) distance between two plates,
+ *  with bit-parallel algorithm of Myers (one pass of bit operations
+ *  per character, for plates up to 64 characters).
+ * @param a, b - plates in canonical form
+ * @param bound - distance is computed exactly only up to this value
+ * @return distance, or bound + 1 when it's bigger than bound
+ */
+std::size_t plateDistance(const std::string& a, const std::string& b,
+                          std::size_t bound = maxPlateDistance);
+
+/**
+ * @return 0-1 similarity of plates in canonical form
+ *  (1 - the same, 0 - more than maxPlateDistance edits)
+ */
+double plateSimilarity(const std::string& a, const std::string& b);
+
+/**
+ * @brief Inverted index: plate -> Tracks, built once per cycle.
+ *
+ * It's symmetric deletion index - each plate is stored under all of it's
+ * variants with up to maxDistance characters deleted, so plates in edit
+ * distance up to maxDistance share at least one variant. Finding candidates
+ * is a few hash lookups, instead of comparing plate with every Track.
+ */
+class PlateIndex
+{
+public:
+  explicit PlateIndex(std::size_t maxDistance = maxPlateDistance);
+
+  /**
+   * @brief Adds Track having given plate.
+   * @param canonical plate
+   * @param track - not owned
+   */
+  void add(const std::string& plate, const Track* track);
+
+  /**
+   * @brief Finds Tracks having plate in edit distance up to maxDistance
+   *  from given one.
+   * @param canonical plate
+   * @param candidates - output, found Tracks are appended
+   */
+  void find(const std::string& plate,
+            std::vector<const Track*>& candidates) const;
+
+  void clear();
+  std::size_t size() const;
+
+private:
+  /**
+   * @brief Returns all distinct variants of plate with up to maxDistance_
+   *  characters deleted (including plate itself).
+   */
+  std::vector<std::string> deletions(const std::string& plate) const;
+
+  struct Entry
+  {
+    std::string plate;
+    const Track* track;
+  };
+
+  std::size_t maxDistance_;
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string,std::vector<std::size_t> > variants_;
+};
+
+#endif // PLATEMATCHER_H
@@ -1,5 +1,9 @@
 #include "reportmanager.h"
 
+#include <map>
+#include <sstream> // used for logging purpose
+#include <utility>
+
 #include <Common/logger.h>
 #include <Common/time.h>
 
@@ -9,20 +13,34 @@ ReportManager::ReportManager(std::shared_ptr<DB::DynDBDriver> dbdriver,
     drCursor_(dbdriver_->getDRCursor(0,packetSize)), // TODO add parametrization for this
     packetSize_(packetSize),
     lastDR_(-1,-1,-1,-1,-1,0,0) // dummy DR
-{}
+{
+  typedef std::map<int,DB::DynDBDriver::FeatureDefinition_row> definitions_t;
+  const definitions_t& definitions = dbdriver_->getFeatureDefinitions();
+  for (const definitions_t::value_type& definition : definitions)
+  {
+    const Feature::Type type = Feature::typeOfName(definition.second.name);
+    if (type == Feature::TypesCount)
+    { // TODO rewrite this, when logger will be more sophisticated
+      std::stringstream msg;
+      msg << "Unknown feature: " << definition.second.name
+          << " - it's values are ignored";
+      Common::GlobalLogger::getInstance().log("ReportManager",msg.str());
+      continue;
+    }
+    featureTypes_[definition.first] = type;
+  }
+}
 
 std::set<DetectionReport> ReportManager::getDRs()
 {
-  std::set<DetectionReport> result;
+  std::vector<DB::DynDBDriver::DR_row> rows;
+  rows.reserve(packetSize_);
+  featureTable_.clear(); // previous packet is already processed
   for (std::size_t i = 0; i<packetSize_; ++i)
   {
     try
     {
-      DB::DynDBDriver::DR_row row = drCursor_.fetchRow();
-      // TODO get features for DR
-      DetectionReport dr(row);
-      lastDR_ = dr;
-      result.insert(dr);
+      rows.push_back(drCursor_.fetchRow());
     }
     catch (const DB::exceptions::NoResultAvailable& /*ex*/)
     { // if no more results available, prepare new Cursor and end loop
@@ -34,6 +52,84 @@ std::set<DetectionReport> ReportManager::getDRs()
     }
   }
 
+  const std::vector<const FeatureTable::row_t*> features = loadFeatures(rows);
+
+  std::set<DetectionReport> result;
+  for (std::size_t i = 0; i < rows.size(); ++i)
+  {
+    DetectionReport dr(rows[i],features[i]);
+    lastDR_ = dr;
+    result.insert(dr);
+  }
+
+  return result;
+}
+
+ReportManager::Cursor ReportManager::getCursor() const
+{
+  Cursor cursor;
+  cursor.sensorTime = lastDR_.getRawSensorTime();
+  cursor.drId = lastDR_.getDrId();
+  return cursor;
+}
+
+void ReportManager::restoreCursor(const Cursor& cursor)
+{
+  lastDR_ = DetectionReport(-1,cursor.drId,-1,-1,-1,0,cursor.sensorTime);
+  setupNextCursor();
+}
+
+std::vector<const FeatureTable::row_t*>
+  ReportManager::loadFeatures(const std::vector<DB::DynDBDriver::DR_row>& rows)
+{
+  std::vector<const FeatureTable::row_t*> result(rows.size(),nullptr);
+  if (rows.empty() || featureTypes_.empty())
+    return result;
+
+  std::vector<std::pair<int,int> > keys;
+  keys.reserve(rows.size());
+  for (const DB::DynDBDriver::DR_row& row : rows)
+  {
+    keys.push_back(std::make_pair(row.sensor_id,row.dr_id));
+  }
+
+  // one query for whole packet
+  const std::vector<DB::DynDBDriver::FeatureValue_row> values
+      = dbdriver_->getFeatureValues(keys);
+
+  std::map<std::pair<int,int>,FeatureTable::row_t> features;
+  for (const DB::DynDBDriver::FeatureValue_row& value : values)
+  {
+    std::unordered_map<int,Feature::Type>::const_iterator typeIt
+        = featureTypes_.find(value.feature_definition_id);
+    if (typeIt == featureTypes_.end())
+      continue; // unknown feature
+
+    const Feature* feature = featureTable_.decode(typeIt->second,value.value);
+    if (!feature)
+    { // TODO rewrite this, when logger will be more sophisticated
+      std::stringstream msg;
+      msg << "Malformed feature value: " << value.value << " of DR ("
+          << value.sensor_id << ", " << value.dr_id << ")";
+      Common::GlobalLogger::getInstance().log("ReportManager",msg.str());
+      continue;
+    }
+
+    std::pair<std::map<std::pair<int,int>,FeatureTable::row_t>::iterator,bool>
+        inserted = features.insert(
+          std::make_pair(std::make_pair(value.sensor_id,value.dr_id),
+                         FeatureTable::emptyRow()));
+    inserted.first->second[typeIt->second] = feature;
+  }
+
+  for (std::size_t i = 0; i < rows.size(); ++i)
+  {
+    std::map<std::pair<int,int>,FeatureTable::row_t>::const_iterator it
+        = features.find(keys[i]);
+    if (it != features.end())
+      result[i] = featureTable_.addRow(it->second);
+  }
+
   return result;
 }
 
@@ -1,26 +1,55 @@
 #ifndef REPORTMANAGER_H
 #define REPORTMANAGER_H
 
+#include <ctime>
 #include <memory>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "DB/dyndbdriver.h"
 #include "detectionreport.h"
+#include "featuretable.h"
 
 class ReportManager
 {
 public:
+  /**
+   * @brief Position in stream of DRs - the last DR returned by getDRs().
+   */
+  struct Cursor
+  {
+    std::time_t sensorTime;
+    int drId; // -1 - nothing was read yet
+  };
+
   ReportManager(std::shared_ptr<DB::DynDBDriver> dbdriver,
                 std::size_t packetSize = 20);
 
   /**
    * @brief Method returns collection of detection reports.
    *  Each invokation gives another part of DRs.
+   *  Features of DRs returned previously are freed.
    * @return Collection of detection reports, ordered by time.
    */
   std::set<DetectionReport> getDRs();
 
+  Cursor getCursor() const;
+
+  /**
+   * @brief Resumes reading DRs right after given position
+   *  (e.g. read from checkpoint).
+   */
+  void restoreCursor(const Cursor& cursor);
+
 private:
+  /**
+   * @brief Loads features of whole packet of DRs at once, into featureTable_.
+   * @return rows of features for each of given DRs (nullptr - no features)
+   */
+  std::vector<const FeatureTable::row_t*>
+    loadFeatures(const std::vector<DB::DynDBDriver::DR_row>& rows);
+
   void setupNextCursor();
 
   std::shared_ptr<DB::DynDBDriver> dbdriver_;
@@ -28,6 +57,10 @@ private:
   std::size_t packetSize_; // how many DRs to obtain at once
 
   DetectionReport lastDR_;
+
+  FeatureTable featureTable_; // features of the current packet of DRs
+  // types of features by feature_definition_id, cached on construction
+  std::unordered_map<int,Feature::Type> featureTypes_;
 };
 
 #endif // REPORTMANAGER_H
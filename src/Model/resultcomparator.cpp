@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
@@ -9,23 +10,52 @@
 #include "resultcomparator.h"
 
 ResultComparator::ResultComparator(const feature_grade_map_t& gradeRates)
-  : gradeRates_(gradeRates)
+  : gradeRates_(gradeRates),
+    maximumPositionRate_(Common::Configuration::ConfigurationManager
+                           ::getCastedValue<double>(
+                             "Model",
+                             "ResultComparator.MaximumPositionRate",
+                             5000)) // 5000 rate is ~200m distance overall
 {}
 
-AndComparator::AndComparator(const feature_grade_map_t& gradeRates)
-  : ResultComparator(gradeRates)
+ResultComparator::~ResultComparator()
 {}
 
-double AndComparator::operator()(const feature_grade_map_t& featureGrades,
-                                 const DetectionReport& dr,
-                                 const Track& t)
+double ResultComparator::operator()(const feature_grade_map_t& featureGrades,
+                                    const DetectionReport& dr,
+                                    const Track& t)
+{
+  return combine(featureGrades,positionRate(dr,t));
+}
+
+double ResultComparator::positionRate(const DetectionReport& dr,
+                                      const Track& t) const
 {
-  return evaluateGrades(featureGrades,dr,t);
+  double positionResult = 1/sqrt(
+          pow((dr.getLongitude() - t.getLongitude()),2)
+          +
+          pow((dr.getLatitude() - t.getLatitude()),2)
+          +
+          pow((dr.getMetersOverSea() - t.getMetersOverSea()),2)
+        );
+
+  if (positionResult > maximumPositionRate_)
+    positionResult = maximumPositionRate_;
+
+  return positionResult/maximumPositionRate_;
 }
 
-double AndComparator::evaluateGrades(const feature_grade_map_t& featureGrades,
-                                     const DetectionReport& dr,
-                                     const Track& t) const
+double ResultComparator::getMaximumPositionRate() const
+{
+  return maximumPositionRate_;
+}
+
+AndComparator::AndComparator(const feature_grade_map_t& gradeRates)
+  : ResultComparator(gradeRates)
+{}
+
+double AndComparator::combine(const feature_grade_map_t& featureGrades,
+                              double positionRate) const
 {
   double featuresResult = 1;
   for (auto& feature : featureGrades)
@@ -42,42 +72,27 @@ double AndComparator::evaluateGrades(const feature_grade_map_t& featureGrades,
     featuresResult *= (gradeRate*feature.second);
   }
 
+  return featuresResult * positionRate;
+}
 
-  double positionResult = 1/sqrt(
-          pow((dr.getLongitude() - t.getLongitude()),2)
-          +
-          pow((dr.getLatitude() - t.getLatitude()),2)
-          +
-          pow((dr.getMetersOverSea() - t.getMetersOverSea()),2)
-        );
-
-    double maximumPositionRate
-        = Common::Configuration::ConfigurationManager
-            ::getCastedValue<double>("Model",
-                                     "ResultComparator.MaximumPositionRate",
-                                     5000); // 5000 rate is ~200m distance overall
-
-  if (positionResult > maximumPositionRate)
-    positionResult = maximumPositionRate;
+double AndComparator::gate(double threshold) const
+{
+  for (auto& gradeRate : gradeRates_)
+  {
+    if (gradeRate.second > 1)
+      return 0; // features could raise rate - no gate
+  }
 
-  return featuresResult * positionResult/maximumPositionRate;
+  // features only lower the rate
+  return threshold;
 }
 
-
 OrComparator::OrComparator(const feature_grade_map_t& gradeRates)
   : ResultComparator(gradeRates)
 {}
 
-double OrComparator::operator()(const feature_grade_map_t& featureGrades,
-                                const DetectionReport& dr,
-                                const Track& t)
-{
-  return evaluateGrades(featureGrades,dr,t);
-}
-
-double OrComparator::evaluateGrades(const feature_grade_map_t& featureGrades,
-                                    const DetectionReport& dr,
-                                    const Track& t) const
+double OrComparator::combine(const feature_grade_map_t& featureGrades,
+                             double positionRate) const
 {
   int i = 0;
   double featuresResult = 0;
@@ -96,34 +111,29 @@ double OrComparator::evaluateGrades(const feature_grade_map_t& featureGrades,
     ++i;
   }
 
-  double positionResult = 1/sqrt(
-          pow((dr.getLongitude() - t.getLongitude()),2)
-          +
-          pow((dr.getLatitude() - t.getLatitude()),2)
-          +
-          pow((dr.getMetersOverSea() - t.getMetersOverSea()),2)
-        );
-
-    double maximumPositionRate
-        = Common::Configuration::ConfigurationManager
-            ::getCastedValue<double>("Model",
-                                     "ResultComparator.MaximumPositionRate",
-                                     5000); // 5000 rate is ~200m distance overall
-
-  if (positionResult > maximumPositionRate)
-    positionResult = maximumPositionRate;
-
-  double positionNormalized = positionResult/maximumPositionRate;
-
   double featuresNormalized = 0; // rate normalized to number of features
   if (i > 0)
   {
     featuresNormalized = featuresResult/i;
     return (featuresNormalized
-            + positionNormalized)/2; // take into consideration difference in position
+            + positionRate)/2; // take into consideration difference in position
   }
   else // if no features given
-    return positionNormalized; // only position is included
+    return positionRate; // only position is included
+}
+
+double OrComparator::gate(double threshold) const
+{
+  // the best normalized rate of features, when each grade is 1
+  double bestFeatures = 0;
+  for (auto& gradeRate : gradeRates_)
+  {
+    bestFeatures = std::max(bestFeatures,gradeRate.second);
+  }
+
+  // without features position alone has to reach threshold,
+  //  with them - mean of position and features
+  return std::max(0.0,std::min(threshold,2*threshold - bestFeatures));
 }
 
 double AndListComparator::operator()(const rates_collection_t& c)
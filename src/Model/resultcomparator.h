@@ -13,41 +13,65 @@ class ResultComparator
 public:
   typedef std::map<std::string,double> feature_grade_map_t;
 
+  virtual ~ResultComparator();
+
   virtual double operator()(const feature_grade_map_t&,
                             const DetectionReport&,
-                            const Track&) = 0;
+                            const Track&);
+
+  /**
+   * @brief Combines grades of features with already computed position rate.
+   * @param grades of features (0-1)
+   * @param rate of position, e.g. computed by Model::rateCandidatePositions()
+   * @return 0-1 rate of DR
+   */
+  virtual double combine(const feature_grade_map_t& featureGrades,
+                         double positionRate) const = 0;
+
+  /**
+   * @brief Minimal position rate, with which DR still could reach
+   *  given threshold (for any grades of features), so features of DRs
+   *  with lower position rate don't have to be compared at all.
+   */
+  virtual double gate(double threshold) const = 0;
+
+  /**
+   * @return 0-1 rate of distance between DR and Track
+   */
+  double positionRate(const DetectionReport&, const Track&) const;
+
+  /**
+   * @return inverse of distance, with which position rate is 1
+   */
+  double getMaximumPositionRate() const;
 
 protected:
   ResultComparator(const feature_grade_map_t& gradeRates);
+
   feature_grade_map_t gradeRates_;
+  double maximumPositionRate_;
 };
 
 class AndComparator : public ResultComparator
 {
 public:
   AndComparator(const feature_grade_map_t& gradeRates);
-  virtual double operator()(const feature_grade_map_t&,
-                            const DetectionReport&,
-                            const Track&);
 
-private:
-  double evaluateGrades(const feature_grade_map_t& featureGrades,
-                        const DetectionReport& dr,
-                        const Track& t) const;
+  virtual double combine(const feature_grade_map_t& featureGrades,
+                         double positionRate) const;
+
+  virtual double gate(double threshold) const;
 };
 
 class OrComparator : public ResultComparator
 {
 public:
   OrComparator(const feature_grade_map_t& gradeRates);
-  virtual double operator()(const feature_grade_map_t&,
-                            const DetectionReport&,
-                            const Track&);
 
-private:
-  double evaluateGrades(const feature_grade_map_t& featureGrades,
-                        const DetectionReport& dr,
-                        const Track& t) const;
+  virtual double combine(const feature_grade_map_t& featureGrades,
+                         double positionRate) const;
+
+  virtual double gate(double threshold) const;
 };
 
 class ListResultComparator
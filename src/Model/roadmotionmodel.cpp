@@ -0,0 +1,166 @@
+#include "roadmotionmodel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Model
+{
+
+RoadMotionModel::RoadMotionModel(MapPtr map, double maximumDistance,
+                                 double minimumProbability)
+  : map_(map),
+    matcher_(map,maximumDistance),
+    minimumProbability_(minimumProbability)
+{
+  directedEdges_.reserve(2*map_->edges.size());
+  for (const StreetPtr& street : map_->edges)
+  {
+    const double lon1 = street->first->lon.get();
+    const double lat1 = street->first->lat.get();
+    const double lon2 = street->second->lon.get();
+    const double lat2 = street->second->lat.get();
+    const double length = std::sqrt((lon2-lon1)*(lon2-lon1)
+                                    + (lat2-lat1)*(lat2-lat1));
+    const double dirLon = length > 0 ? (lon2-lon1)/length : 0;
+    const double dirLat = length > 0 ? (lat2-lat1)/length : 0;
+
+    DirectedEdge forward = { lon1, lat1, dirLon, dirLat, length };
+    DirectedEdge backward = { lon2, lat2, -dirLon, -dirLat, length };
+    directedEdges_.push_back(forward);
+    directedEdges_.push_back(backward);
+  }
+
+  buildTransitions();
+}
+
+bool RoadMotionModel::locate(double lon, double lat,
+                             double lonVelocity, double latVelocity,
+                             Location& result) const
+{
+  MapMatcher::Projection projection;
+  if (!matcher_.findNearestStreet(lon,lat,projection))
+    return false;
+
+  // direction of travel along the street is taken from velocity
+  const bool backward = lonVelocity*projection.directionLon
+                        + latVelocity*projection.directionLat < 0;
+  result.directedEdge = 2*projection.edge + (backward ? 1 : 0);
+
+  const DirectedEdge& edge = directedEdges_[result.directedEdge];
+  result.offset = std::sqrt((projection.lon-edge.startLon)
+                              *(projection.lon-edge.startLon)
+                            + (projection.lat-edge.startLat)
+                              *(projection.lat-edge.startLat));
+  return true;
+}
+
+void RoadMotionModel::propagate(const Location& from, double distance,
+                                std::vector<Hypothesis>& result) const
+{
+  struct Step
+  {
+    std::size_t directedEdge;
+    double offset;
+    double remaining;
+    double probability;
+    unsigned hops;
+  };
+  const unsigned maximumHops = 64; // guards cycles of zero-length streets
+
+  std::vector<Step> stack;
+  Step start = { from.directedEdge, from.offset, distance, 1.0, 0 };
+  stack.push_back(start);
+
+  while (!stack.empty())
+  {
+    Step step = stack.back();
+    stack.pop_back();
+
+    const DirectedEdge& edge = directedEdges_[step.directedEdge];
+    const std::size_t first = transitionOffsets_[step.directedEdge];
+    const std::size_t last = transitionOffsets_[step.directedEdge+1];
+    const double left = edge.length - step.offset;
+
+    if (step.remaining <= left || first == last
+        || step.hops == maximumHops)
+    { // stops on this edge (or at it's end, when there is no way further)
+      const double offset = step.offset + std::min(step.remaining,left);
+      Hypothesis hypothesis = { edge.startLon + offset*edge.directionLon,
+                                edge.startLat + offset*edge.directionLat,
+                                step.probability };
+      result.push_back(hypothesis);
+      continue;
+    }
+
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const double probability = step.probability*transitions_[i].probability;
+      if (probability < minimumProbability_)
+        continue; // too unlikely, to follow it
+
+      Step next = { transitions_[i].directedEdge, 0,
+                    step.remaining - left, probability, step.hops+1 };
+      stack.push_back(next);
+    }
+  }
+}
+
+void RoadMotionModel::buildTransitions()
+{
+  transitionOffsets_.assign(directedEdges_.size()+1,0);
+  transitions_.clear();
+
+  for (std::size_t directed = 0; directed < directedEdges_.size(); ++directed)
+  {
+    transitionOffsets_[directed] = transitions_.size();
+
+    const std::size_t edge = directed/2;
+    const StreetPtr& street = map_->edges[edge];
+    const StreetNodePtr& end = directed%2 == 0 ? street->second
+                                               : street->first;
+    const DirectedEdge& incoming = directedEdges_[directed];
+
+    double weightsSum = 0;
+    Map::EdgesRange range
+        = map_->edgesInVertex(map_->vertexIndex(end->nodeId));
+    for (const std::size_t* next = range.first; next != range.second; ++next)
+    {
+      if (*next == edge)
+        continue; // turning back is not considered (except dead ends)
+
+      const StreetPtr& nextStreet = map_->edges[*next];
+      const std::size_t nextDirected
+          = 2*(*next) + (nextStreet->first->nodeId == end->nodeId ? 0 : 1);
+      const DirectedEdge& outgoing = directedEdges_[nextDirected];
+
+      // 1.1 for going straight, 0.6 for perpendicular turn, 0.1 for
+      //  the sharpest turn (floor keeps even such turns possible),
+      //  normalized to probabilities below
+      const double cosine = incoming.directionLon*outgoing.directionLon
+                            + incoming.directionLat*outgoing.directionLat;
+      const double weight = 0.1 + (1+cosine)/2;
+
+      Transition transition = { static_cast<std::uint32_t>(nextDirected),
+                                static_cast<float>(weight) };
+      transitions_.push_back(transition);
+      weightsSum += weight;
+    }
+
+    if (transitions_.size() == transitionOffsets_[directed])
+    { // dead end - the only way is to turn back
+      Transition transition = { static_cast<std::uint32_t>(directed^1), 1 };
+      transitions_.push_back(transition);
+    }
+    else
+    {
+      for (std::size_t i = transitionOffsets_[directed];
+           i < transitions_.size(); ++i)
+      {
+        transitions_[i].probability /= weightsSum;
+      }
+    }
+  }
+  transitionOffsets_[directedEdges_.size()] = transitions_.size();
+}
+
+} // namespace Model
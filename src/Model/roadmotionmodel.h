@@ -0,0 +1,96 @@
+#ifndef ROADMOTIONMODEL_H
+#define ROADMOTIONMODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <3rdparty/DBDataStructures.h>
+
+#include "mapmatcher.h"
+
+namespace Model
+{
+
+/**
+ * @brief Propagates position of object along the street graph,
+ *  instead of extrapolating it in straight line.
+ *
+ * Each street is used in both directions (directed edge = 2*edge + direction,
+ *  direction 0 - from first to second node, 1 - from second to first).
+ * For each directed edge, probabilities of turning into the next ones are
+ *  precomputed once (in c-tor) and kept in CSR form.
+ *  Going straight is more probable than turning;
+ *  turning back is possible only at dead ends.
+ */
+class RoadMotionModel
+{
+public:
+  // position on street graph
+  struct Location
+  {
+    std::size_t directedEdge;
+    double offset; // distance travelled from the beginning of directed edge
+  };
+
+  // possible position after propagation
+  struct Hypothesis
+  {
+    double lon;
+    double lat;
+    double probability;
+  };
+
+  /**
+   * @param map with streets
+   * @param maximum distance from street, to consider object being on it
+   * @param hypotheses less probable than this are not followed
+   */
+  RoadMotionModel(MapPtr map, double maximumDistance,
+                  double minimumProbability = 0.05);
+
+  /**
+   * @brief Places object moving with given velocity on the nearest street.
+   * @return true if there is street near enough (and result was set)
+   */
+  bool locate(double lon, double lat, double lonVelocity, double latVelocity,
+              Location& result) const;
+
+  /**
+   * @brief Appends to result possible positions of object,
+   *  after travelling given distance along the streets.
+   *  Probabilities of appended hypotheses sum up to at most 1.
+   */
+  void propagate(const Location& from, double distance,
+                 std::vector<Hypothesis>& result) const;
+
+private:
+  struct Transition
+  {
+    std::uint32_t directedEdge;
+    float probability;
+  };
+
+  struct DirectedEdge
+  {
+    double startLon;
+    double startLat;
+    double directionLon; // normalized
+    double directionLat;
+    double length;
+  };
+
+  void buildTransitions();
+
+  MapPtr map_;
+  MapMatcher matcher_;
+  const double minimumProbability_;
+
+  std::vector<DirectedEdge> directedEdges_;
+  std::vector<std::size_t> transitionOffsets_; // directedEdges_.size()+1
+  std::vector<Transition> transitions_;
+};
+
+} // namespace Model
+
+#endif // ROADMOTIONMODEL_H
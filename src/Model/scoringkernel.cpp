@@ -0,0 +1,94 @@
+#include "scoringkernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
+#include "detectionreport.h"
+
+void CandidatePositions::reserve(std::size_t size)
+{
+  lon_.reserve(size);
+  lat_.reserve(size);
+  mos_.reserve(size);
+}
+
+void CandidatePositions::add(const DetectionReport& dr)
+{
+  lon_.push_back(dr.getLongitude());
+  lat_.push_back(dr.getLatitude());
+  mos_.push_back(dr.getMetersOverSea());
+}
+
+void CandidatePositions::clear()
+{
+  lon_.clear();
+  lat_.clear();
+  mos_.clear();
+}
+
+std::size_t CandidatePositions::size() const
+{
+  return lon_.size();
+}
+
+const double* CandidatePositions::getLongitudes() const
+{
+  return lon_.data();
+}
+
+const double* CandidatePositions::getLatitudes() const
+{
+  return lat_.data();
+}
+
+const double* CandidatePositions::getMetersOverSea() const
+{
+  return mos_.data();
+}
+
+void rateCandidatePositions(const CandidatePositions& candidates,
+                            double lon, double lat, double mos,
+                            double maximumPositionRate,
+                            double* rates)
+{
+  const std::size_t size = candidates.size();
+  const double* lons = candidates.getLongitudes();
+  const double* lats = candidates.getLatitudes();
+  const double* moss = candidates.getMetersOverSea();
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128d trackLon = _mm_set1_pd(lon);
+  const __m128d trackLat = _mm_set1_pd(lat);
+  const __m128d trackMos = _mm_set1_pd(mos);
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d maximum = _mm_set1_pd(maximumPositionRate);
+
+  for (; i + 2 <= size; i += 2)
+  {
+    const __m128d dLon = _mm_sub_pd(_mm_loadu_pd(lons + i),trackLon);
+    const __m128d dLat = _mm_sub_pd(_mm_loadu_pd(lats + i),trackLat);
+    const __m128d dMos = _mm_sub_pd(_mm_loadu_pd(moss + i),trackMos);
+    const __m128d squared = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dLon,dLon),
+                                                  _mm_mul_pd(dLat,dLat)),
+                                       _mm_mul_pd(dMos,dMos));
+    // zero distance gives infinity, which is clipped to maximum
+    __m128d rate = _mm_div_pd(one,_mm_sqrt_pd(squared));
+    rate = _mm_min_pd(rate,maximum);
+    _mm_storeu_pd(rates + i,_mm_div_pd(rate,maximum));
+  }
+#endif
+
+  for (; i < size; ++i)
+  {
+    const double dLon = lons[i] - lon;
+    const double dLat = lats[i] - lat;
+    const double dMos = moss[i] - mos;
+    const double rate = 1/std::sqrt(dLon*dLon + dLat*dLat + dMos*dMos);
+    rates[i] = std::min(rate,maximumPositionRate)/maximumPositionRate;
+  }
+}
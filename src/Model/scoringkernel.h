@@ -0,0 +1,55 @@
+#ifndef SCORINGKERNEL_H
+#define SCORINGKERNEL_H
+
+#include <cstddef>
+#include <vector>
+
+#include <Common/arena.hpp>
+
+class DetectionReport;
+
+/**
+ * @brief Positions of candidate DRs, stored as structure of arrays,
+ *  so position rates of all of them can be computed in one pass.
+ *
+ * Coordinates are allocated from arena of current cycle (if any).
+ */
+class CandidatePositions
+{
+public:
+  typedef std::vector<double,Common::ArenaAllocator<double> > coordinates_t;
+
+  CandidatePositions() = default;
+
+  void reserve(std::size_t size);
+  void add(const DetectionReport&);
+  void clear();
+  std::size_t size() const;
+
+  const double* getLongitudes() const;
+  const double* getLatitudes() const;
+  const double* getMetersOverSea() const;
+
+private:
+  coordinates_t lon_;
+  coordinates_t lat_;
+  coordinates_t mos_;
+};
+
+/**
+ * @brief Computes position rates of all candidates against one position
+ *  (of Track), in the same way as ResultComparator::positionRate() does:
+ *  inverse of distance, clipped at maximumPositionRate and normalized to 0-1.
+ *
+ *  Vectorized with SSE2 (two candidates at once), when available.
+ * @param candidates
+ * @param lon, lat, mos - position of Track
+ * @param maximumPositionRate
+ * @param rates - output, candidates.size() values
+ */
+void rateCandidatePositions(const CandidatePositions& candidates,
+                            double lon, double lat, double mos,
+                            double maximumPositionRate,
+                            double* rates);
+
+#endif // SCORINGKERNEL_H
@@ -0,0 +1,45 @@
+#include "sensornoisetable.h"
+
+void SensorNoiseTable::set(int sensorId,
+                           double positionVariance, double mosVariance)
+{
+  if (sensorId < 0)
+    return;
+
+  int noiseClass = 0;
+  for (std::size_t i = 0; i < classes_.size(); ++i)
+  {
+    if (classes_[i].positionVariance == positionVariance
+        && classes_[i].mosVariance == mosVariance)
+    {
+      noiseClass = classes_[i].noiseClass;
+      break;
+    }
+  }
+  if (noiseClass == 0)
+  {
+    noiseClass = classes_.size() + 1;
+    classes_.push_back(SensorNoise{ positionVariance,mosVariance,noiseClass });
+  }
+
+  const std::size_t index = sensorId;
+  if (index >= noises_.size())
+    noises_.resize(index + 1,SensorNoise{ 0,0,0 });
+  if (noises_[index].noiseClass == 0)
+    ++size_;
+  noises_[index] = SensorNoise{ positionVariance,mosVariance,noiseClass };
+}
+
+const SensorNoise* SensorNoiseTable::find(int sensorId) const
+{
+  if (sensorId < 0 || std::size_t(sensorId) >= noises_.size())
+    return nullptr;
+
+  const SensorNoise& noise = noises_[sensorId];
+  return (noise.noiseClass == 0 ? nullptr : &noise);
+}
+
+std::size_t SensorNoiseTable::size() const
+{
+  return size_;
+}
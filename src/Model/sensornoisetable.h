@@ -0,0 +1,54 @@
+#ifndef SENSORNOISETABLE_H
+#define SENSORNOISETABLE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Measurement noise of sensor - variances of position it reports.
+ */
+struct SensorNoise
+{
+  double positionVariance; // of longitude and latitude
+  double mosVariance; // of meters over sea
+  // sensors with equal variances share class (> 0),
+  //  negative - unique noise (e.g. of measurement combined from many DRs)
+  int noiseClass;
+};
+
+/**
+ * @brief Measurement noises of all sensors, loaded once (e.g. from DB).
+ *
+ * Noises are stored densely, indexed by sensor id (ids are serial),
+ *  so finding noise of DR's sensor is O(1) and doesn't allocate.
+ *  Table is not modified during tracking, so it may be shared by threads.
+ */
+class SensorNoiseTable
+{
+public:
+  SensorNoiseTable() = default;
+
+  /**
+   * @brief Sets noise of given sensor (replaces previous one).
+   *  Sensors with the same variances get the same noise class.
+   * @param sensorId - ignored when negative
+   */
+  void set(int sensorId, double positionVariance, double mosVariance);
+
+  /**
+   * @return noise of sensor, nullptr when it's unknown
+   */
+  const SensorNoise* find(int sensorId) const;
+
+  /**
+   * @return number of sensors with known noise
+   */
+  std::size_t size() const;
+
+private:
+  std::vector<SensorNoise> noises_; // noiseClass 0 - unknown sensor
+  std::vector<SensorNoise> classes_; // distinct noises, class = index + 1
+  std::size_t size_ = 0;
+};
+
+#endif // SENSORNOISETABLE_H
@@ -0,0 +1,602 @@
+#include "shardedtracker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <sstream> // used for logging purpose
+
+#include <pthread.h>
+
+#include <Common/logger.h>
+
+namespace Model
+{
+
+namespace
+{
+
+std::pair<double,double> getCentroid(const std::set<DetectionReport>& DRs)
+{
+  double lon = 0;
+  double lat = 0;
+  for (const DetectionReport& dr : DRs)
+  {
+    lon += dr.getLongitude();
+    lat += dr.getLatitude();
+  }
+  if (!DRs.empty())
+  {
+    lon /= DRs.size();
+    lat /= DRs.size();
+  }
+
+  return std::make_pair(lon,lat);
+}
+
+void merge(std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& into,
+           const std::map<std::shared_ptr<Track>,
+                          std::set<DetectionReport> >& from)
+{
+  for (const auto& trackDRs : from)
+  {
+    std::set<DetectionReport>& DRs = into[trackDRs.first];
+    DRs.insert(trackDRs.second.begin(),trackDRs.second.end());
+  }
+}
+
+} // anonymous namespace
+
+bool Bounds::contains(double lon, double lat) const
+{
+  return lon >= minLon && lon <= maxLon && lat >= minLat && lat <= maxLat;
+}
+
+Bounds Bounds::expanded(double margin) const
+{
+  Bounds result = { minLon-margin, minLat-margin,
+                    maxLon+margin, maxLat+margin };
+  return result;
+}
+
+Bounds Bounds::ofMap(const MapPtr map)
+{
+  Bounds result = { map->normalizationVector[0], map->normalizationVector[1],
+                    map->normalizationVector[0], map->normalizationVector[1] };
+  for (const StreetNodePtr& node : map->vertexes)
+  {
+    result.maxLon = std::max(result.maxLon,node->lon.get());
+    result.maxLat = std::max(result.maxLat,node->lat.get());
+  }
+
+  return result;
+}
+
+/******************************************************************************/
+
+Shard::Shard(const Bounds& tile, int cpu)
+  : tile_(tile),
+    busy_(false),
+    stopping_(false),
+    thread_(&Shard::work,this)
+{
+  if (cpu >= 0)
+  { // pinning is only a hint - shard works correctly without it
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu,&cpus);
+    pthread_setaffinity_np(thread_.native_handle(),sizeof(cpus),&cpus);
+  }
+}
+
+Shard::~Shard()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+const Bounds& Shard::getTile() const
+{
+  return tile_;
+}
+
+void Shard::post(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(!busy_ && "Previous task is not finished yet!");
+    task_ = std::move(task);
+    busy_ = true;
+  }
+  condition_.notify_all();
+}
+
+void Shard::wait()
+{
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock,[this]{ return !busy_; });
+    std::swap(error,error_);
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void Shard::work()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    condition_.wait(lock,[this]{ return stopping_ || task_; });
+    if (stopping_)
+      return;
+
+    std::function<void()> task;
+    std::swap(task,task_);
+    lock.unlock();
+    std::exception_ptr error;
+    try
+    {
+      // temporaries of task are freed at once, when it finishes
+      Common::ArenaScope scope(arena_);
+      task();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+    lock.lock();
+
+    error_ = error;
+    busy_ = false;
+    condition_.notify_all();
+  }
+}
+
+/******************************************************************************/
+
+TrackerShard::TrackerShard(const Bounds& tile,
+                           std::shared_ptr<TrackManager> trackManager,
+                           std::unique_ptr<DataAssociator> dataAssociator,
+                           std::unique_ptr<FusionExecutor> fusionExecutor,
+                           int cpu)
+  : Shard(tile,cpu),
+    trackManager_(trackManager),
+    dataAssociator_(std::move(dataAssociator)),
+    fusionExecutor_(std::move(fusionExecutor))
+{}
+
+TrackManager& TrackerShard::getTrackManager()
+{
+  return *trackManager_;
+}
+
+void TrackerShard::associate(
+    std::vector<std::set<DetectionReport> >& groups,
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& associated,
+    std::vector<std::set<DetectionReport> >& notAssociated,
+    std::vector<std::size_t>& sources)
+{
+  if (groups.empty())
+    return;
+
+  dataAssociator_->setInput(groups);
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > result
+      = dataAssociator_->getDRsForTracks();
+  fusionExecutor_->fuseDRs(result);
+  merge(associated,result);
+
+  // rest of each group stays at index of the group
+  std::vector<std::set<DetectionReport> > rest
+      = dataAssociator_->getNotAssociated();
+  for (std::size_t i = 0; i < rest.size(); ++i)
+  {
+    if (rest[i].empty())
+      continue;
+    notAssociated.push_back(std::move(rest[i]));
+    sources.push_back(i);
+  }
+}
+
+void TrackerShard::initialize(
+    const std::vector<std::set<DetectionReport> >& groups,
+    const estimation::EstimationFilter<>& filter,
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> >& initialized)
+{
+  if (groups.empty())
+    return;
+
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > result
+      = trackManager_->initializeTracks(groups,filter.clone());
+  fusionExecutor_->fuseDRs(result);
+  merge(initialized,result);
+}
+
+void TrackerShard::takeLeavingTracks(
+    std::vector<std::shared_ptr<Track> >& leaving)
+{
+  const std::size_t sizeBefore = leaving.size();
+  for (const std::shared_ptr<Track>& track : trackManager_->getTracksRef())
+  {
+    if (!getTile().contains(track->getLongitude(),track->getLatitude()))
+      leaving.push_back(track);
+  }
+
+  for (std::size_t i = sizeBefore; i < leaving.size(); ++i)
+  {
+    trackManager_->removeTrack(leaving[i]);
+  }
+}
+
+void TrackerShard::addTracks(const std::vector<std::shared_ptr<Track> >& tracks)
+{
+  for (const std::shared_ptr<Track>& track : tracks)
+  {
+    trackManager_->addTrack(track);
+  }
+}
+
+std::set<std::shared_ptr<Track> > TrackerShard::getTracks()
+{
+  return trackManager_->getTracks();
+}
+
+void TrackerShard::restoreTracks(const std::set<std::shared_ptr<Track> >& tracks)
+{
+  trackManager_->restoreTracks(tracks);
+}
+
+std::size_t TrackerShard::removeExpiredTracks(time_types::ptime_t currentTime,
+                                              time_types::duration_t TTL)
+{
+  return trackManager_->removeExpiredTracks(currentTime,TTL);
+}
+
+void TrackerShard::setRoadMotionModel(
+    std::shared_ptr<const RoadMotionModel> model,
+    time_types::duration_t dormantTTL,
+    double reacquisitionDistance)
+{
+  trackManager_->setRoadMotionModel(model,dormantTTL,reacquisitionDistance);
+}
+
+/******************************************************************************/
+
+ShardedTracker::ShardedTracker(const Bounds& area,
+                               unsigned columns, unsigned rows,
+                               double overlap,
+                               const ShardFactory& factory,
+                               bool pinThreads)
+  : area_(area),
+    columns_(std::max(columns,1u)),
+    rows_(std::max(rows,1u)),
+    overlap_(overlap)
+{
+  const unsigned cpus = std::max(std::thread::hardware_concurrency(),1u);
+  createShards([&factory,pinThreads,cpus](const Bounds& tile,
+                                          std::size_t index)
+               {
+                 std::shared_ptr<TrackManager> trackManager
+                     = factory.trackManager();
+                 const int cpu = pinThreads ? int(index % cpus) : -1;
+                 return std::unique_ptr<Shard>(
+                       new TrackerShard(tile,trackManager,
+                                        factory.dataAssociator(trackManager),
+                                        factory.fusionExecutor(),
+                                        cpu));
+               });
+}
+
+ShardedTracker::ShardedTracker(const Bounds& area,
+                               unsigned columns, unsigned rows,
+                               double overlap,
+                               const shard_creator_t& creator)
+  : area_(area),
+    columns_(std::max(columns,1u)),
+    rows_(std::max(rows,1u)),
+    overlap_(overlap)
+{
+  createShards(creator);
+}
+
+std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
+  ShardedTracker::process(const std::vector<std::set<DetectionReport> >& groups,
+                          const estimation::EstimationFilter<>& filter)
+{
+  struct ShardWork
+  {
+    std::vector<std::set<DetectionReport> > owned;
+    std::vector<std::set<DetectionReport> > secondChance;
+    std::vector<std::size_t> secondChanceOwners;
+    std::vector<std::set<DetectionReport> > toInitialize;
+
+    tracks_drs_t updated;
+    std::vector<std::set<DetectionReport> > notAssociated;
+  };
+  std::vector<ShardWork> work(shards_.size());
+
+  for (const std::set<DetectionReport>& group : groups)
+  {
+    if (group.empty())
+      continue;
+    const std::pair<double,double> centroid = getCentroid(group);
+    work[shardIndex(centroid.first,centroid.second)].owned.push_back(group);
+  }
+
+  // 1. owners associate their groups
+  runOnShards([this,&work](std::size_t i)
+              {
+                std::vector<std::size_t> sources; // owner is known
+                shards_[i]->associate(work[i].owned,work[i].updated,
+                                      work[i].notAssociated,sources);
+              });
+
+  // 2. groups from overlap strips get second chance in neighbouring shard
+  for (std::size_t owner = 0; owner < shards_.size(); ++owner)
+  {
+    for (std::set<DetectionReport>& group : work[owner].notAssociated)
+    {
+      const std::pair<double,double> centroid = getCentroid(group);
+      std::size_t neighbour = owner;
+      for (std::size_t i = 0; i < shards_.size() && neighbour == owner; ++i)
+      {
+        if (i != owner && shards_[i]->getTile().expanded(overlap_)
+                            .contains(centroid.first,centroid.second))
+          neighbour = i;
+      }
+
+      if (neighbour != owner)
+      {
+        work[neighbour].secondChance.push_back(std::move(group));
+        work[neighbour].secondChanceOwners.push_back(owner);
+      }
+      else
+        work[owner].toInitialize.push_back(std::move(group));
+    }
+    work[owner].notAssociated.clear();
+  }
+
+  // groups rejected by neighbour go back to their owners
+  std::vector<
+      std::vector<std::pair<std::size_t,std::set<DetectionReport> > >
+    > rejected(shards_.size());
+  runOnShards([this,&work,&rejected](std::size_t i)
+              {
+                // all groups at once (one request to remote shard),
+                //  owner of rejected group is found by it's source
+                std::vector<std::set<DetectionReport> > rest;
+                std::vector<std::size_t> sources;
+                shards_[i]->associate(work[i].secondChance,work[i].updated,
+                                      rest,sources);
+                for (std::size_t g = 0; g < rest.size(); ++g)
+                  rejected[i].push_back(
+                        std::make_pair(work[i].secondChanceOwners[sources[g]],
+                                       std::move(rest[g])));
+              });
+
+  for (auto& shardRejected : rejected)
+  {
+    for (auto& ownerGroup : shardRejected)
+      work[ownerGroup.first].toInitialize.push_back(
+            std::move(ownerGroup.second));
+  }
+
+  // 3. owners initialize Tracks for the rest
+  runOnShards([this,&work,&filter](std::size_t i)
+              {
+                shards_[i]->initialize(work[i].toInitialize,filter,
+                                       work[i].updated);
+              });
+
+  tracks_drs_t result;
+  for (ShardWork& w : work)
+  {
+    merge(result,w.updated);
+  }
+
+  // 4. move Tracks to shards owning their new positions
+  std::size_t handedOff = handOffTracks();
+  if (handedOff > 0)
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Handed off " << handedOff << " track(s).";
+    Common::GlobalLogger::getInstance().log("ShardedTracker",msg.str());
+  }
+
+  return result;
+}
+
+std::set<std::shared_ptr<Track> > ShardedTracker::getTracks()
+{
+  std::vector<std::set<std::shared_ptr<Track> > > tracks(shards_.size());
+  runOnShards([this,&tracks](std::size_t i)
+              {
+                tracks[i] = shards_[i]->getTracks();
+              });
+
+  std::set<std::shared_ptr<Track> > result;
+  for (const std::set<std::shared_ptr<Track> >& shardTracks : tracks)
+  {
+    result.insert(shardTracks.begin(),shardTracks.end());
+  }
+
+  return result;
+}
+
+void ShardedTracker::restoreTracks(
+    const std::set<std::shared_ptr<Track> >& tracks)
+{
+  std::vector<std::set<std::shared_ptr<Track> > > distributed(shards_.size());
+  for (const std::shared_ptr<Track>& track : tracks)
+  {
+    distributed[shardIndex(track->getLongitude(),track->getLatitude())]
+        .insert(track);
+  }
+
+  runOnShards([this,&distributed](std::size_t i)
+              {
+                shards_[i]->restoreTracks(distributed[i]);
+              });
+}
+
+std::size_t ShardedTracker::removeExpiredTracks(time_types::ptime_t currentTime,
+                                                time_types::duration_t TTL)
+{
+  std::vector<std::size_t> removed(shards_.size(),0);
+  runOnShards([this,&removed,currentTime,TTL](std::size_t i)
+              {
+                removed[i] = shards_[i]->removeExpiredTracks(currentTime,TTL);
+              });
+
+  std::size_t count = 0;
+  for (std::size_t r : removed)
+    count += r;
+
+  return count;
+}
+
+std::size_t ShardedTracker::removeExpiredTracks(time_types::duration_t TTL)
+{
+  time_types::ptime_t latestRefreshTime;
+  for (const std::shared_ptr<Track>& track : getTracks())
+  {
+    if (track->getRefreshTime() > latestRefreshTime)
+      latestRefreshTime = track->getRefreshTime();
+  }
+
+  return removeExpiredTracks(latestRefreshTime,TTL);
+}
+
+void ShardedTracker::setRoadMotionModel(
+    std::shared_ptr<const RoadMotionModel> model,
+    time_types::duration_t dormantTTL,
+    double reacquisitionDistance)
+{
+  for (const std::unique_ptr<Shard>& shard : shards_)
+  {
+    shard->setRoadMotionModel(model,dormantTTL,reacquisitionDistance);
+  }
+}
+
+std::size_t ShardedTracker::getShardsCount() const
+{
+  return shards_.size();
+}
+
+Shard& ShardedTracker::getShard(std::size_t index)
+{
+  return *shards_.at(index);
+}
+
+std::size_t ShardedTracker::shardIndex(double lon, double lat) const
+{
+  long column = 0;
+  if (tileWidth_ > 0)
+    column = static_cast<long>(std::floor((lon - area_.minLon)/tileWidth_));
+  long row = 0;
+  if (tileHeight_ > 0)
+    row = static_cast<long>(std::floor((lat - area_.minLat)/tileHeight_));
+
+  column = std::min(std::max(column,0L),long(columns_)-1);
+  row = std::min(std::max(row,0L),long(rows_)-1);
+
+  return std::size_t(row)*columns_ + std::size_t(column);
+}
+
+void ShardedTracker::runOnShards(const std::function<void(std::size_t)>& task)
+{
+  for (std::size_t i = 0; i < shards_.size(); ++i)
+  {
+    shards_[i]->post([&task,i]{ task(i); });
+  }
+
+  std::exception_ptr error;
+  for (const std::unique_ptr<Shard>& shard : shards_)
+  {
+    try
+    {
+      shard->wait();
+    }
+    catch (...)
+    { // wait for all shards anyway - they use data from this stack frame
+      error = std::current_exception();
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void ShardedTracker::createShards(const shard_creator_t& creator)
+{
+  tileWidth_ = (area_.maxLon - area_.minLon) / columns_;
+  tileHeight_ = (area_.maxLat - area_.minLat) / rows_;
+
+  for (unsigned row = 0; row < rows_; ++row)
+  {
+    for (unsigned column = 0; column < columns_; ++column)
+    {
+      Bounds tile = { area_.minLon + column*tileWidth_,
+                      area_.minLat + row*tileHeight_,
+                      area_.minLon + (column+1)*tileWidth_,
+                      area_.minLat + (row+1)*tileHeight_ };
+      // border tiles own everything outside of area
+      const double infinity = std::numeric_limits<double>::infinity();
+      if (column == 0)
+        tile.minLon = -infinity;
+      if (column == columns_-1)
+        tile.maxLon = infinity;
+      if (row == 0)
+        tile.minLat = -infinity;
+      if (row == rows_-1)
+        tile.maxLat = infinity;
+
+      shards_.push_back(creator(tile,shards_.size()));
+    }
+  }
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Created " << columns_ << "x" << rows_ << " shards, "
+        << "tile size: " << tileWidth_ << "x" << tileHeight_ << ".";
+    Common::GlobalLogger::getInstance().log("ShardedTracker",msg.str());
+  }
+}
+
+std::size_t ShardedTracker::handOffTracks()
+{
+  std::vector<std::vector<std::shared_ptr<Track> > > leaving(shards_.size());
+  runOnShards([this,&leaving](std::size_t i)
+              {
+                shards_[i]->takeLeavingTracks(leaving[i]);
+              });
+
+  std::size_t count = 0;
+  std::vector<std::vector<std::shared_ptr<Track> > > incoming(shards_.size());
+  for (const std::vector<std::shared_ptr<Track> >& tracks : leaving)
+  {
+    for (const std::shared_ptr<Track>& track : tracks)
+    {
+      incoming[shardIndex(track->getLongitude(),track->getLatitude())]
+          .push_back(track);
+      ++count;
+    }
+  }
+
+  if (count > 0)
+    runOnShards([this,&incoming](std::size_t i)
+                {
+                  if (!incoming[i].empty())
+                    shards_[i]->addTracks(incoming[i]);
+                });
+
+  return count;
+}
+
+} // namespace Model
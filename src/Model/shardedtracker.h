@@ -0,0 +1,344 @@
+#ifndef SHARDEDTRACKER_H
+#define SHARDEDTRACKER_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <3rdparty/DBDataStructures.h>
+
+#include <Common/arena.hpp>
+
+#include <Model/dataassociator.h>
+#include <Model/detectionreport.h>
+#include <Model/fusionexecutor.h>
+#include <Model/roadmotionmodel.h>
+#include <Model/track.h>
+#include <Model/trackmanager.h>
+
+namespace Model
+{
+
+/**
+ * @brief Rectangular area (in degrees).
+ */
+struct Bounds
+{
+  double minLon;
+  double minLat;
+  double maxLon;
+  double maxLat;
+
+  bool contains(double lon, double lat) const;
+
+  /**
+   * @return bounds enlarged by given margin, on each side
+   */
+  Bounds expanded(double margin) const;
+
+  /**
+   * @return bounds of all nodes of given map
+   *  (lower corner is map's normalization vector)
+   */
+  static Bounds ofMap(const MapPtr map);
+};
+
+/**
+ * @brief Part of tracker responsible for one tile of the whole area,
+ *  with it's own worker thread.
+ *
+ * Shard owns Tracks, which are inside it's tile. Worker runs one task
+ * at once - tasks are posted by ShardedTracker, which waits for all shards
+ * between steps, so shard's components are never used concurrently.
+ * Shard can track locally (TrackerShard) or be a proxy of shard working
+ * in other process (Distributed::RemoteShard).
+ */
+class Shard
+{
+public:
+  /**
+   * @param tile - area owned by shard
+   * @param cpu which worker thread is pinned to (negative - not pinned)
+   */
+  explicit Shard(const Bounds& tile, int cpu = -1);
+  virtual ~Shard();
+
+  const Bounds& getTile() const;
+
+  /**
+   * @brief Associates given groups of DRs with Tracks of this shard,
+   *  and fuses associated DRs into these Tracks.
+   * @param groups of DRs - moved out
+   * @param associated (and already fused) Tracks are added here
+   * @param not associated groups (or their not associated parts)
+   *  are appended here
+   * @param sources - index (in groups) of each group appended
+   *  to notAssociated is appended here, so caller knows where
+   *  rejected groups came from
+   */
+  virtual void associate(std::vector<std::set<DetectionReport> >& groups,
+                         std::map<std::shared_ptr<Track>,
+                                  std::set<DetectionReport> >& associated,
+                         std::vector<std::set<DetectionReport> >& notAssociated,
+                         std::vector<std::size_t>& sources)
+    = 0;
+
+  /**
+   * @brief Initializes (or reacquires) Tracks for given groups of DRs
+   *  and fuses DRs into them.
+   * @param initialized Tracks are added here
+   */
+  virtual void initialize(const std::vector<std::set<DetectionReport> >& groups,
+                          const estimation::EstimationFilter<>& filter,
+                          std::map<std::shared_ptr<Track>,
+                                   std::set<DetectionReport> >& initialized)
+    = 0;
+
+  /**
+   * @brief Removes Tracks which are outside of tile from shard.
+   * @param removed Tracks are appended here
+   */
+  virtual void
+    takeLeavingTracks(std::vector<std::shared_ptr<Track> >& leaving) = 0;
+
+  /**
+   * @brief Takes over Tracks handed off by other shards.
+   */
+  virtual void addTracks(const std::vector<std::shared_ptr<Track> >& tracks)
+    = 0;
+
+  virtual std::set<std::shared_ptr<Track> > getTracks() = 0;
+
+  /**
+   * @brief Replaces all Tracks of shard with given ones.
+   */
+  virtual void restoreTracks(const std::set<std::shared_ptr<Track> >& tracks)
+    = 0;
+
+  virtual std::size_t removeExpiredTracks(time_types::ptime_t currentTime,
+                                          time_types::duration_t TTL) = 0;
+
+  virtual void setRoadMotionModel(std::shared_ptr<const RoadMotionModel> model,
+                                  time_types::duration_t dormantTTL,
+                                  double reacquisitionDistance) = 0;
+
+  /**
+   * @brief Runs task on worker thread. Previous task has to be finished.
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * @brief Waits until posted task finishes.
+   *  Rethrows exception thrown by task, if any.
+   */
+  void wait();
+
+private:
+  Shard(const Shard&) = delete;
+  Shard& operator=(const Shard&) = delete;
+
+  void work();
+
+  const Bounds tile_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::function<void()> task_; // empty - no task pending
+  bool busy_;
+  bool stopping_;
+  std::exception_ptr error_;
+
+  Common::Arena arena_; // used by worker only
+
+  std::thread thread_; // last - started after everything is initialized
+};
+
+/**
+ * @brief Shard running tracking pipeline (TrackManager, DataAssociator,
+ *  FusionExecutor) in this process.
+ */
+class TrackerShard : public Shard
+{
+public:
+  /**
+   * @param tile - area owned by shard
+   * @param trackManager - shared with dataAssociator
+   * @param dataAssociator - associates DRs with Tracks of this shard only
+   * @param fusionExecutor
+   * @param cpu which worker thread is pinned to (negative - not pinned)
+   */
+  TrackerShard(const Bounds& tile,
+               std::shared_ptr<TrackManager> trackManager,
+               std::unique_ptr<DataAssociator> dataAssociator,
+               std::unique_ptr<FusionExecutor> fusionExecutor,
+               int cpu = -1);
+
+  TrackManager& getTrackManager();
+
+  virtual void associate(std::vector<std::set<DetectionReport> >& groups,
+                         std::map<std::shared_ptr<Track>,
+                                  std::set<DetectionReport> >& associated,
+                         std::vector<std::set<DetectionReport> >& notAssociated,
+                         std::vector<std::size_t>& sources);
+
+  virtual void initialize(const std::vector<std::set<DetectionReport> >& groups,
+                          const estimation::EstimationFilter<>& filter,
+                          std::map<std::shared_ptr<Track>,
+                                   std::set<DetectionReport> >& initialized);
+
+  virtual void takeLeavingTracks(std::vector<std::shared_ptr<Track> >& leaving);
+
+  virtual void addTracks(const std::vector<std::shared_ptr<Track> >& tracks);
+
+  virtual std::set<std::shared_ptr<Track> > getTracks();
+
+  virtual void restoreTracks(const std::set<std::shared_ptr<Track> >& tracks);
+
+  virtual std::size_t removeExpiredTracks(time_types::ptime_t currentTime,
+                                          time_types::duration_t TTL);
+
+  virtual void setRoadMotionModel(std::shared_ptr<const RoadMotionModel> model,
+                                  time_types::duration_t dormantTTL,
+                                  double reacquisitionDistance);
+
+private:
+  std::shared_ptr<TrackManager> trackManager_;
+  std::unique_ptr<DataAssociator> dataAssociator_;
+  std::unique_ptr<FusionExecutor> fusionExecutor_;
+};
+
+/**
+ * @brief Splits area into grid of tiles, each tracked by TrackerShard
+ *  in parallel.
+ *
+ * Groups of DRs are routed to shards by their centroid. Each step:
+ *  1. shards associate (and fuse) groups they own,
+ *  2. not associated groups lying in overlap strip of neighbouring tile
+ *   get second chance in that shard (Track may still be on the other side
+ *   of border, when it's DR already crossed it),
+ *  3. owners initialize Tracks for groups still not associated,
+ *  4. Tracks which moved out of their shard's tile are handed off
+ *   to shard owning their new position.
+ */
+class ShardedTracker
+{
+public:
+  /**
+   * @brief Creates components of each (local) shard.
+   */
+  struct ShardFactory
+  {
+    std::function<std::shared_ptr<TrackManager>()> trackManager;
+    std::function<
+        std::unique_ptr<DataAssociator>(std::shared_ptr<TrackManager>)
+      > dataAssociator;
+    std::function<std::unique_ptr<FusionExecutor>()> fusionExecutor;
+  };
+
+  /**
+   * @brief Creates shard for given tile (index is row*columns + column).
+   */
+  typedef std::function<
+      std::unique_ptr<Shard>(const Bounds& tile, std::size_t index)
+    > shard_creator_t;
+
+  /**
+   * @param area to split into tiles (positions outside of it belong
+   *  to the nearest tile)
+   * @param columns of tiles (along longitude)
+   * @param rows of tiles (along latitude)
+   * @param width of overlap strip (in degrees) on each side of border
+   * @param factory of shards' components
+   * @param pin workers to subsequent CPUs
+   */
+  ShardedTracker(const Bounds& area, unsigned columns, unsigned rows,
+                 double overlap, const ShardFactory& factory,
+                 bool pinThreads = true);
+
+  /**
+   * @overload
+   * @param creator of shards (e.g. of remote ones)
+   */
+  ShardedTracker(const Bounds& area, unsigned columns, unsigned rows,
+                 double overlap, const shard_creator_t& creator);
+
+  /**
+   * @brief Runs one tracking step for given groups of DRs
+   *  (groups created by CandidateSelector from one aligned group).
+   * @param filter cloned for initialized Tracks
+   * @return Tracks updated in this step, with DRs fused into them
+   */
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
+    process(const std::vector<std::set<DetectionReport> >& groups,
+            const estimation::EstimationFilter<>& filter);
+
+  /**
+   * @return Tracks of all shards
+   */
+  std::set<std::shared_ptr<Track> > getTracks();
+
+  /**
+   * @brief Distributes given Tracks to shards owning their positions,
+   *  replacing all current Tracks.
+   */
+  void restoreTracks(const std::set<std::shared_ptr<Track> >& tracks);
+
+  std::size_t removeExpiredTracks(time_types::ptime_t currentTime,
+                                  time_types::duration_t TTL);
+
+  /**
+   * @brief Removes expired Tracks, assuming refresh time of the latest
+   *  Track (of all shards) as current.
+   */
+  std::size_t removeExpiredTracks(time_types::duration_t TTL);
+
+  void setRoadMotionModel(std::shared_ptr<const RoadMotionModel> model,
+                          time_types::duration_t dormantTTL,
+                          double reacquisitionDistance);
+
+  std::size_t getShardsCount() const;
+  Shard& getShard(std::size_t index);
+
+  /**
+   * @return index of shard owning given position
+   */
+  std::size_t shardIndex(double lon, double lat) const;
+
+private:
+  typedef std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
+    tracks_drs_t;
+
+  /**
+   * @brief Runs task(shardIndex) on every shard in parallel
+   *  and waits for all of them.
+   */
+  void runOnShards(const std::function<void(std::size_t)>& task);
+
+  /**
+   * @brief Moves Tracks, which are outside tiles of their shards,
+   *  to shards owning their positions.
+   * @return number of handed off Tracks
+   */
+  std::size_t handOffTracks();
+
+  void createShards(const shard_creator_t& creator);
+
+  const Bounds area_;
+  const unsigned columns_;
+  const unsigned rows_;
+  const double overlap_;
+  double tileWidth_;
+  double tileHeight_;
+
+  std::vector<std::unique_ptr<Shard> > shards_;
+};
+
+} // namespace Model
+
+#endif // SHARDEDTRACKER_H
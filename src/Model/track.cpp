@@ -1,18 +1,19 @@
 #include "track.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp> // for logging purpose
 
 #include "detectionreport.h"
-
-#include <Common/logger.h>
+#include "featureextractor.h"
+#include "sensornoisetable.h"
 
 Track::Track(std::unique_ptr<estimation::EstimationFilter<> > filter,
              double longitude, double latitude, double metersOverSea,
              double lonVar, double latVar, double mosVar,
              time_types::ptime_t creationTime)
-  : estimationFilter_(std::move(filter)),
-    lon_(longitude), lat_(latitude), mos_(metersOverSea),
+  : lon_(longitude), lat_(latitude), mos_(metersOverSea),
     lonVel_(0), // because sensors don't provide information about velocity
     latVel_(0), // we assume that starting velocity is 0
     mosVel_(0), // TODO conside changing it,
@@ -20,7 +21,11 @@ Track::Track(std::unique_ptr<estimation::EstimationFilter<> > filter,
     predictedLat_(0),
     predictedMos_(0),
     lonPredictionVar_(0), latPredictionVar_(0), mosPredictionVar_(0),
+    estimationFilter_(std::move(filter)),
     refreshTime_(creationTime),
+    measurementTime_(creationTime),
+    snapped_(false),
+    streetNormalLon_(0), streetNormalLat_(0), streetOffset_(0),
     uuid_(boost::uuids::random_generator()()) // generate random uuid
 {
   std::pair<
@@ -31,19 +36,69 @@ Track::Track(std::unique_ptr<estimation::EstimationFilter<> > filter,
   storePredictions(prediction);
 }
 
-void Track::refresh(time_types::ptime_t refreshTime)
+Track::Track(std::unique_ptr<estimation::EstimationFilter<> > filter,
+             const State& state)
+  : lon_(state.lon), lat_(state.lat), mos_(state.mos),
+    lonVel_(state.lonVel), latVel_(state.latVel), mosVel_(state.mosVel),
+    predictedLon_(state.predictedLon),
+    predictedLat_(state.predictedLat),
+    predictedMos_(state.predictedMos),
+    lonPredictionVar_(state.lonPredictionVar),
+    latPredictionVar_(state.latPredictionVar),
+    mosPredictionVar_(state.mosPredictionVar),
+    estimationFilter_(std::move(filter)),
+    refreshTime_(time_types::clock_t::duration(state.refreshTime)),
+    measurementTime_(time_types::clock_t::duration(state.measurementTime)),
+    snapped_(false),
+    streetNormalLon_(0), streetNormalLat_(0), streetOffset_(0),
+    uuid_(state.uuid)
 {
+  if (!estimationFilter_->importState(state.filterState))
+    throw std::invalid_argument("Track: filter state doesn't fit filter");
+
+  for (const std::shared_ptr<const Feature>& feature : state.features)
   {
-    std::stringstream msg;
-    msg << "[" << uuid_ << "] Refreshing track; time = " << refreshTime;
-    Common::GlobalLogger::getInstance().log("Track",msg.str());
+    if (feature)
+      setFeature(std::unique_ptr<Feature>(feature->clone()));
   }
-  if (refreshTime <= refreshTime_)
+}
+
+Track::State Track::getState() const
+{
+  State state;
+  state.uuid = uuid_;
+  state.lon = lon_;
+  state.lat = lat_;
+  state.mos = mos_;
+  state.lonVel = lonVel_;
+  state.latVel = latVel_;
+  state.mosVel = mosVel_;
+  state.predictedLon = predictedLon_;
+  state.predictedLat = predictedLat_;
+  state.predictedMos = predictedMos_;
+  state.lonPredictionVar = lonPredictionVar_;
+  state.latPredictionVar = latPredictionVar_;
+  state.mosPredictionVar = mosPredictionVar_;
+  state.refreshTime = refreshTime_.time_since_epoch().count();
+  state.measurementTime = measurementTime_.time_since_epoch().count();
+  state.filterState = estimationFilter_->exportState();
+  for (const std::unique_ptr<Feature>& feature : features_)
   {
-    Common::GlobalLogger::getInstance()
-        .log("Track","Refresh time earlier than already set, skipping.");
-    return;
+    if (feature)
+      state.features.push_back(
+            std::shared_ptr<const Feature>(feature->clone()));
   }
+  return state;
+}
+
+/*
+ * Called for each fused DR, in parallel (by ParallelFusionExecutor),
+ *  so nothing is logged here - logger would serialize fusion threads.
+ */
+void Track::refresh(time_types::ptime_t refreshTime)
+{
+  if (refreshTime <= refreshTime_)
+    return; // e.g. already refreshed by association
   refreshTime_ = refreshTime;
 }
 
@@ -52,14 +107,42 @@ void Track::setEstimationFilter(std::unique_ptr<estimation::EstimationFilter<> >
   estimationFilter_ = std::move(filter);
 }
 
-Track::features_set_t Track::getFeatures() const
+const Track::features_t& Track::getFeatures() const
 {
   return features_;
 }
 
-const Track::features_set_t& Track::getFeaturesRef() const
+const Feature* Track::getFeature(Feature::Type type) const
 {
-  return features_;
+  return features_[type].get();
+}
+
+void Track::setFeature(std::unique_ptr<Feature> feature)
+{
+  if (!feature)
+    return;
+
+  const Feature::Type type = feature->getType();
+  features_[type] = std::move(feature);
+}
+
+void Track::updateFeatures(const DetectionReport& dr,
+                           const FeatureExtractor* extractor)
+{
+  for (const Feature* feature : dr.getFeatures())
+  {
+    if (!feature)
+      continue;
+
+    const Feature* current = getFeature(feature->getType());
+    std::unique_ptr<Feature> fused;
+    if (current && extractor)
+      fused.reset(extractor->fuse(*current,*feature));
+
+    // features of DR are valid only in current cycle - copied
+    setFeature(fused ? std::move(fused)
+                     : std::unique_ptr<Feature>(feature->clone()));
+  }
 }
 
 double Track::getLongitude() const
@@ -132,58 +215,77 @@ time_types::ptime_t Track::getRefreshTime() const
   return refreshTime_;
 }
 
+time_types::ptime_t Track::getMeasurementTime() const
+{
+  return measurementTime_;
+}
+
 boost::uuids::uuid Track::getUuid() const
 {
   return uuid_;
 }
 
-void Track::applyMeasurement(const DetectionReport& dr)
+// runs in parallel (see refresh()) - nothing is logged here
+void Track::applyMeasurement(const DetectionReport& dr,
+                             const SensorNoise* noise)
 {
-  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
-  {
-    std::stringstream msg;
-    msg << "[" << uuid_ << "] Applying measurement from DR: " << dr;
-    logger.log("Track",msg.str());
-  }
   time_types::ptime_t newRefreshTime = dr.getSensorTime();
-  {
-    std::stringstream msg;
-    msg << "Current refresh time = " << refreshTime_;
-    logger.log("Track",msg.str());
-  }
-  time_types::duration_t timePassed = newRefreshTime - refreshTime_;
+  // Track could be refreshed already (by association),
+  //  so time is counted from the latest measurement
+  time_types::duration_t timePassed = newRefreshTime - measurementTime_;
+  if (newRefreshTime > measurementTime_)
+    measurementTime_ = newRefreshTime;
   refresh(newRefreshTime); // refresh track
   return applyMeasurement(dr.getLongitude(),
                           dr.getLatitude(),
                           dr.getMetersOverSea(),
-                          timePassed);
+                          timePassed,
+                          noise);
 }
 
 void Track::applyMeasurement(double longitude, double latitude, double mos,
-                             time_types::duration_t timePassed)
+                             time_types::duration_t timePassed,
+                             const SensorNoise* noise)
 {
+  // measurement older than the latest one is fused as if it was simultaneous
+  const double timeStep
+      = std::max(timePassed,time_types::duration_t::zero()).count();
+  estimationFilter_->predictFor(timeStep);
+  if (snapped_)
+  {
+    constrainToStreet();
+    snapped_ = false; // map matcher snaps Track again, after this update
+  }
+
   estimation::EstimationFilter<>::vector_t vec
       = coordsToStateVector(longitude,latitude,mos, // DRs don't provide information about velocity
-                            lonVel_,latVel_,mosVel_); // so we take last calculated velocity
+                            0,0,0); // so it's not measured (estimated by filter)
 
   std::pair<
         estimation::EstimationFilter<>::vector_t,
         estimation::EstimationFilter<>::vector_t
-      > correctedState = estimationFilter_->correct(vec);
+      > correctedState;
+  if (noise)
+  {
+    estimation::EstimationFilter<>::vector_t variance
+        = coordsToStateVector(noise->positionVariance,
+                              noise->positionVariance,
+                              noise->mosVariance,
+                              0,0,0);
+    correctedState
+        = estimationFilter_->correct(vec,variance,noise->noiseClass);
+  }
+  else
+    correctedState = estimationFilter_->correct(vec);
   estimation::EstimationFilter<>::vector_t trackCorrectedState
       = correctedState.first;
 
-  double newLon = trackCorrectedState[0];
-  double newLat = trackCorrectedState[1];
-
-  if (timePassed != time_types::duration_t::zero())
-  {
-    lonVel_ = (newLon-lon_)/timePassed.count();
-    latVel_ = (newLat-lat_)/timePassed.count();
-  } // don't change velocity, when received next measurement with the same time as last one
-
-  lon_ = newLon;
-  lat_ = newLat;
+  lon_ = trackCorrectedState[0];
+  lat_ = trackCorrectedState[1];
+  mos_ = trackCorrectedState[2];
+  lonVel_ = trackCorrectedState[3];
+  latVel_ = trackCorrectedState[4];
+  mosVel_ = trackCorrectedState[5];
 
   std::pair<
         estimation::EstimationFilter<>::vector_t,
@@ -193,6 +295,34 @@ void Track::applyMeasurement(double longitude, double latitude, double mos,
   storePredictions(predictedState);
 }
 
+void Track::snapTo(double longitude, double latitude,
+                   double directionLon, double directionLat)
+{
+  lon_ = longitude;
+  lat_ = latitude;
+
+  // normal to street
+  snapped_ = true;
+  streetNormalLon_ = -directionLat;
+  streetNormalLat_ = directionLon;
+  streetOffset_ = streetNormalLon_*longitude + streetNormalLat_*latitude;
+
+  storePredictions(constrainToStreet());
+}
+
+void Track::relocate(double longitude, double latitude,
+                     double lonVar, double latVar)
+{
+  lon_ = longitude;
+  lat_ = latitude;
+  lonVel_ = 0;
+  latVel_ = 0;
+  mosVel_ = 0;
+  snapped_ = false;
+
+  storePredictions(initializeFilter(lon_,lat_,mos_,lonVar,latVar,0));
+}
+
 bool Track::isTrackValid(time_types::ptime_t currentTime,
                          time_types::duration_t TTL) const
 {
@@ -209,8 +339,7 @@ std::unique_ptr<Track> Track::clone() const
 }
 
 Track::Track(const Track& other)
-  : estimationFilter_(std::move(other.estimationFilter_->clone())),
-    lon_(other.lon_),
+  : lon_(other.lon_),
     lat_(other.lat_),
     mos_(other.mos_),
     lonVel_(other.lonVel_),
@@ -222,26 +351,32 @@ Track::Track(const Track& other)
     lonPredictionVar_(other.lonPredictionVar_),
     latPredictionVar_(other.latPredictionVar_),
     mosPredictionVar_(other.mosPredictionVar_),
+    estimationFilter_(std::move(other.estimationFilter_->clone())),
     refreshTime_(other.refreshTime_),
+    measurementTime_(other.measurementTime_),
+    snapped_(other.snapped_),
+    streetNormalLon_(other.streetNormalLon_),
+    streetNormalLat_(other.streetNormalLat_),
+    streetOffset_(other.streetOffset_),
     uuid_(other.uuid_)
 {}
 
 estimation::EstimationFilter<>::vector_t
   Track::coordsToStateVector(double longitude,
                              double latitude,
-                             double /*metersoversea*/,
+                             double metersoversea,
                              double longitudeVelocity,
                              double latitudeVelocity,
-                             double /*metersoverseaVelocity*/)
+                             double metersoverseaVelocity)
 {
-  // Metersoversea not yet implemented, because of too narrow state model
-  // Expand model to include meters over sea value.
-
+  // layout of PositionAndVelocity3DModel
   estimation::EstimationFilter<>::vector_t state;
   state[0] = longitude;
   state[1] = latitude;
-  state[2] = longitudeVelocity;
-  state[3] = latitudeVelocity;
+  state[2] = metersoversea;
+  state[3] = longitudeVelocity;
+  state[4] = latitudeVelocity;
+  state[5] = metersoverseaVelocity;
 
   return state;
 }
@@ -264,11 +399,26 @@ std::pair<
       = coordsToStateVector(varLon, // because output vector has the same layout
                             varLat,
                             varMos,
-                            0,0,0); // we don't want putting anything in 3rd and 4th row
+                            0,0,0); // we don't want putting anything in velocity rows
 
   return estimationFilter_->initialize(state,covErr);
 }
 
+std::pair<
+          estimation::EstimationFilter<>::vector_t,
+          estimation::EstimationFilter<>::vector_t
+         > Track::constrainToStreet()
+{
+  // meters over sea are not constrained
+  std::vector<estimation::EstimationFilter<>::vector_t> D(2);
+  D[0] = coordsToStateVector(streetNormalLon_,streetNormalLat_,0,0,0,0); // on the street
+  D[1] = coordsToStateVector(0,0,0,streetNormalLon_,streetNormalLat_,0); // along the street
+
+  std::vector<double> d = { streetOffset_, 0 };
+
+  return estimationFilter_->constrainPrediction(D,d);
+}
+
 void Track::storePredictions(std::pair<
                               estimation::EstimationFilter<>::vector_t,
                               estimation::EstimationFilter<>::vector_t
@@ -279,10 +429,12 @@ void Track::storePredictions(std::pair<
 
   predictedLon_ = trackPredictedState[0];
   predictedLat_ = trackPredictedState[1];
+  predictedMos_ = trackPredictedState[2];
 
   estimation::EstimationFilter<>::vector_t trackPredictionVariance
       = prediction.second;
 
   lonPredictionVar_ = trackPredictionVariance[0];
   latPredictionVar_ = trackPredictionVariance[1];
+  mosPredictionVar_ = trackPredictionVariance[2];
 }
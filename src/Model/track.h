@@ -1,21 +1,57 @@
 #ifndef TRACK_H
 #define TRACK_H
 
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <unordered_set>
+#include <vector>
 
 #include <boost/uuid/uuid.hpp>
 
 #include <Common/time.h>
 
 #include "estimationfilter.hpp"
+#include "feature.h"
 
 class DetectionReport;
+class FeatureExtractor;
+struct SensorNoise;
 
 class Track
 {
 public:
-  typedef std::unordered_set<class Feature*> features_set_t;
+  // features indexed by Feature::Type (nullptr - Track has no such feature)
+  typedef std::array<std::unique_ptr<Feature>,Feature::TypesCount> features_t;
+
+  /**
+   * @brief Complete (serializable) state of Track, used in checkpoints
+   *  and in handoff between shards.
+   */
+  struct State
+  {
+    boost::uuids::uuid uuid;
+
+    double lon;
+    double lat;
+    double mos;
+
+    double lonVel;
+    double latVel;
+    double mosVel;
+
+    double predictedLon;
+    double predictedLat;
+    double predictedMos;
+
+    double lonPredictionVar;
+    double latPredictionVar;
+    double mosPredictionVar;
+
+    std::int64_t refreshTime; // clock ticks since epoch
+    std::int64_t measurementTime; // clock ticks since epoch
+    std::vector<double> filterState; // EstimationFilter::exportState()
+    std::vector<std::shared_ptr<const Feature> > features; // copies
+  };
 
   /**
    * @brief c-tor. Creates track based on given creation time.
@@ -40,6 +76,17 @@ public:
         double lonVar, double latVar, double mosVar,
         time_types::ptime_t = time_types::clock_t::now());
 
+  /**
+   * @brief Restores Track from it's state (e.g. read from checkpoint).
+   *  Throws std::invalid_argument, when filter state doesn't fit given filter.
+   * @param Estimation filter with the same models as filter of stored Track
+   * @param State returned by getState()
+   */
+  Track(std::unique_ptr<estimation::EstimationFilter<> > filter,
+        const State& state);
+
+  State getState() const;
+
   /**
    * @brief Refreshes Track (sets it's last update time to given)
    * @param Time of refresh
@@ -52,8 +99,29 @@ public:
    */
   void setEstimationFilter(std::unique_ptr<estimation::EstimationFilter<> > filter);
 
-  features_set_t getFeatures() const;
-  const features_set_t& getFeaturesRef() const;
+  const features_t& getFeatures() const;
+
+  /**
+   * @return feature of given type or nullptr, in O(1)
+   */
+  const Feature* getFeature(Feature::Type type) const;
+
+  /**
+   * @brief Sets feature of Track - replaces previous one of the same type.
+   * @param feature - Track takes ownership
+   */
+  void setFeature(std::unique_ptr<Feature> feature);
+
+  /**
+   * @brief Takes features observed in given DR - each of them is fused
+   *  with feature of the same type, which Track had before
+   *  (e.g. colors - running weighted mean), or replaces it,
+   *  when they cannot be fused.
+   * @param DetectionReport
+   * @param FeatureExtractor used to fuse features (nullptr - only replacing)
+   */
+  void updateFeatures(const DetectionReport&,
+                      const FeatureExtractor* extractor = nullptr);
 
   double getLongitude() const;
   double getLatitude() const;
@@ -75,15 +143,25 @@ public:
 
   time_types::ptime_t getRefreshTime() const;
 
+  /**
+   * @return sensor time of the latest measurement applied to Track
+   *  (or time of creation) - refresh time can be later,
+   *  e.g. when Track was associated with DRs, which aren't fused yet
+   */
+  time_types::ptime_t getMeasurementTime() const;
+
   boost::uuids::uuid getUuid() const;
 
   /**
    * @brief Puts model state of given DR to Track's estimation filter
    *  It's invoking correct() method on EstimationFilter assigned to Track,
-   *  with values corresponding to the measured.
+   *  with values corresponding to the measured, after predicting state
+   *  for time passed since the latest measurement.
    * @param DetectionReport representing measurement
+   * @param noise of DR's sensor, nullptr - filter's own noise is used
    */
-  void applyMeasurement(const DetectionReport&);
+  void applyMeasurement(const DetectionReport&,
+                        const SensorNoise* noise = nullptr);
 
   /**
    * @brief Puts appropriate data into model state in EstimationFilter.
@@ -91,10 +169,37 @@ public:
    * @param latitude
    * @param meters over sea
    * @param how much time passed from last measurement
-   * @overload applyMeasurement(const DetectionReport&);
+   *  (filter predicts state for this time, before correction)
+   * @param noise of measurement, nullptr - filter's own noise is used
+   * @overload applyMeasurement(const DetectionReport&,const SensorNoise*);
    */
   void applyMeasurement(double longitude, double latitude, double mos,
-                        time_types::duration_t timePassed);
+                        time_types::duration_t timePassed,
+                        const SensorNoise* noise = nullptr);
+
+  /**
+   * @brief Moves Track onto street (map matching).
+   *  Position is set to given point, and prediction is constrained
+   *  to lie (and move) along the line through this point - also
+   *  prediction made for the next measurement.
+   * @param longitude of point on street
+   * @param latitude of point on street
+   * @param longitude component of street direction (normalized)
+   * @param latitude component of street direction (normalized)
+   */
+  void snapTo(double longitude, double latitude,
+              double directionLon, double directionLat);
+
+  /**
+   * @brief Moves Track to given position and restarts it's estimation
+   *  (velocity is zeroed), e.g. when Track is reacquired after long gap.
+   * @param longitude
+   * @param latitude
+   * @param variance of longitude
+   * @param variance of latitude
+   */
+  void relocate(double longitude, double latitude,
+                double lonVar, double latVar);
 
   bool isTrackValid(time_types::ptime_t currentTime,
                     time_types::duration_t TTL) const;
@@ -122,6 +227,12 @@ private:
                               double varLat,
                               double varMos);
 
+  // constrains prediction of filter to the street set by snapTo()
+  std::pair<
+              estimation::EstimationFilter<>::vector_t,
+              estimation::EstimationFilter<>::vector_t
+           > constrainToStreet();
+
   void storePredictions(std::pair<
                           estimation::EstimationFilter<>::vector_t,
                           estimation::EstimationFilter<>::vector_t
@@ -137,15 +248,22 @@ private:
 
   double predictedLon_;
   double predictedLat_;
-  double predictedMos_; // not yet implemented
+  double predictedMos_;
 
   double lonPredictionVar_;
   double latPredictionVar_;
-  double mosPredictionVar_; // not yet implemented
+  double mosPredictionVar_;
 
-  features_set_t features_;
+  features_t features_;
   std::unique_ptr<estimation::EstimationFilter<> > estimationFilter_;
   time_types::ptime_t refreshTime_;
+  time_types::ptime_t measurementTime_;
+
+  // street set by snapTo(): normal . position = offset (till next measurement)
+  bool snapped_;
+  double streetNormalLon_;
+  double streetNormalLat_;
+  double streetOffset_;
 
   const boost::uuids::uuid uuid_;
 };
@@ -1,14 +1,19 @@
 #include "trackmanager.h"
 
 #include <algorithm>
+#include <cmath>
 
+#include <boost/functional/hash.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
 #include <Common/logger.h>
 #include <Common/time.h>
 
 TrackManager::TrackManager(double initializationThreshold)
-  : initializationDRThreshold_(initializationThreshold)
+  : initializationDRThreshold_(initializationThreshold),
+    dormantTTL_(time_types::duration_t::zero()),
+    reacquisitionDistance_(0),
+    nextDormantId_(0)
 {}
 
 std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
@@ -42,8 +47,9 @@ std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
 
     for (auto group : groups)
     {
-      std::shared_ptr<Track> track
-          = initializeTrack(group,filter->clone());
+      std::shared_ptr<Track> track = reacquireTrack(group);
+      if (!track)
+        track = initializeTrack(group,filter->clone());
       tracks_.insert(track);
       result[track] = group;
     }
@@ -62,11 +68,58 @@ std::set<std::shared_ptr<Track> > TrackManager::getTracks() const
   return tracks_;
 }
 
+void TrackManager::restoreTracks(const std::set<std::shared_ptr<Track> >& tracks)
+{
+  tracks_ = tracks;
+  dormantTracks_.clear();
+  dormantIndex_.clear();
+}
+
+void TrackManager::addTrack(const std::shared_ptr<Track>& track)
+{
+  tracks_.insert(track);
+}
+
+bool TrackManager::removeTrack(const std::shared_ptr<Track>& track)
+{
+  return tracks_.erase(track) > 0;
+}
+
 void TrackManager::setFeatureExtractor(std::unique_ptr<FeatureExtractor> extractor)
 {
   featureExtractor_ = std::move(extractor);
 }
 
+void TrackManager::setSensorNoiseTable(
+    std::shared_ptr<const SensorNoiseTable> noises)
+{
+  sensorNoises_ = noises;
+}
+
+void TrackManager::setRoadMotionModel(
+    std::shared_ptr<const Model::RoadMotionModel> model,
+    time_types::duration_t dormantTTL,
+    double reacquisitionDistance)
+{
+  // dormant Tracks are indexed by cells of reacquisition distance,
+  //  so they are disabled without it
+  const bool enabled = dormantTTL > time_types::duration_t::zero()
+      && reacquisitionDistance > 0;
+  roadMotionModel_ = enabled ? model : nullptr;
+  dormantTTL_ = dormantTTL;
+  reacquisitionDistance_ = reacquisitionDistance;
+  if (!roadMotionModel_)
+  {
+    dormantTracks_.clear();
+    dormantIndex_.clear();
+  }
+}
+
+std::size_t TrackManager::getDormantTracksCount() const
+{
+  return dormantTracks_.size();
+}
+
 std::size_t TrackManager::removeExpiredTracks(time_types::ptime_t currentTime,
                                               time_types::duration_t TTL)
 {
@@ -88,6 +141,8 @@ std::size_t TrackManager::removeExpiredTracks(time_types::ptime_t currentTime,
           // it's only shortcut, for fasten writing
     if (!currentTrack->isTrackValid(currentTime,TTL))
     {
+      if (roadMotionModel_)
+        makeDormant(currentTrack,TTL);
       iter = tracks_.erase(iter);
       ++count;
     }
@@ -102,6 +157,8 @@ std::size_t TrackManager::removeExpiredTracks(time_types::ptime_t currentTime,
     logger.log("TrackManager",msg.str());
   }
 
+  removeExpiredDormantTracks(currentTime);
+
   return count;
 }
 
@@ -115,8 +172,54 @@ std::shared_ptr<Track>
   TrackManager::initializeTrack(const std::set<DetectionReport>& DRs,
                                 std::unique_ptr<estimation::EstimationFilter<> > filter)
 {
-  // TODO implement merging features from DRs for Track (based on FeatureExtractor's fuse() method).
+  double lon = 0;
+  double lat = 0;
+  double mos = 0;
+  time_types::ptime_t maxTime;
+  std::tie(lon,lat,mos,maxTime) = getCentroid(DRs);
+
+  // variance of mean of independent measurements: sum(var)/n^2,
+  //  coordinates from sensors of unknown noise are assumed to be 100% sure
+  double varLon = 0;
+  double varLat = 0;
+  double varMos = 0;
+  if (sensorNoises_)
+  {
+    for (const DetectionReport& DR : DRs)
+    {
+      const SensorNoise* noise = sensorNoises_->find(DR.getSensorId());
+      if (noise)
+      {
+        varLon += noise->positionVariance;
+        varLat += noise->positionVariance;
+        varMos += noise->mosVariance;
+      }
+    }
+    const double squaredCount = double(DRs.size())*DRs.size();
+    varLon /= squaredCount;
+    varLat /= squaredCount;
+    varMos /= squaredCount;
+  }
+
+  std::shared_ptr<Track> track(
+          new Track(filter->clone(),
+                    lon,lat,mos,
+                    varLon,varLat,varMos,
+                    maxTime)
+        );
+
+  // features of DRs are fused (when FeatureExtractor is set)
+  for (const DetectionReport& DR : DRs)
+  {
+    track->updateFeatures(DR,featureExtractor_.get());
+  }
+
+  return track;
+}
 
+std::tuple<double,double,double,time_types::ptime_t>
+  TrackManager::getCentroid(const std::set<DetectionReport>& DRs) const
+{
   double lons = 0;
   double lats = 0;
   double moses = 0;
@@ -133,26 +236,185 @@ std::shared_ptr<Track>
     ++cnt;
   }
 
-  double lon = lons/cnt;
-  double lat = lats/cnt;
-  double mos = moses/cnt;
+  return std::make_tuple(lons/cnt,lats/cnt,moses/cnt,maxTime);
+}
 
-  // TODO evaluate proper values of variances (certainty) of coordinates
-  // now we assume coordinates to be 100% sure
-  double varLon = 0;
-  double varLat = 0;
-  double varMos = 0;
+void TrackManager::makeDormant(const std::shared_ptr<Track>& track,
+                               time_types::duration_t TTL)
+{
+  Model::RoadMotionModel::Location location;
+  if (!roadMotionModel_->locate(track->getLongitude(),track->getLatitude(),
+                                track->getLongitudeVelocity(),
+                                track->getLatitudeVelocity(),
+                                location))
+    return; // not on the street - there is no way to follow it
+
+  const time_types::duration_t lifetime = TTL + dormantTTL_;
+  const std::uint64_t id = nextDormantId_++;
+  DormantTrack& dormant = dormantTracks_[id];
+  dormant.track = track;
+  dormant.expiration = track->getRefreshTime()
+      + boost::chrono::duration_cast<time_types::clock_t::duration>(lifetime);
+
+  const double speed = std::sqrt(std::pow(track->getLongitudeVelocity(),2)
+                                 + std::pow(track->getLatitudeVelocity(),2));
+  const double refreshTime // seconds since epoch
+      = boost::chrono::duration_cast<time_types::duration_t>(
+          track->getRefreshTime().time_since_epoch()).count();
+  const long long firstSecond
+      = static_cast<long long>(std::floor(refreshTime)) + 1;
+  const long long lastSecond
+      = static_cast<long long>(std::floor(refreshTime + lifetime.count()));
+
+  // precomputed here, so reacquisition is only a lookup
+  std::vector<Model::RoadMotionModel::Hypothesis> hypotheses;
+  for (long long second = firstSecond; second <= lastSecond; ++second)
+  {
+    hypotheses.clear();
+    roadMotionModel_->propagate(location,speed*(second-refreshTime),
+                                hypotheses);
+    for (const Model::RoadMotionModel::Hypothesis& hypothesis : hypotheses)
+    {
+      DormantKey key = getDormantKey(hypothesis.lon,hypothesis.lat,second);
+      DormantCandidate candidate = { id, hypothesis.lon, hypothesis.lat,
+                                     hypothesis.probability };
+      dormantIndex_[key].push_back(candidate);
+      dormant.keys.push_back(key);
+    }
+  }
 
-  std::shared_ptr<Track> track(
-          new Track(filter->clone(),
-                    lon,lat,mos,
-                    varLon,varLat,varMos,
-                    maxTime)
-        );
+  { // TODO rewrite this, when logger will be more sophisticated
+    Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+    std::stringstream msg;
+    msg << "[" << track->getUuid() << "] Track is dormant, "
+        << dormant.keys.size() << " propagated positions.";
+    logger.log("TrackManager",msg.str());
+  }
+}
+
+std::shared_ptr<Track>
+  TrackManager::reacquireTrack(const std::set<DetectionReport>& DRs)
+{
+  if (dormantTracks_.empty() || DRs.empty())
+    return std::shared_ptr<Track>();
+
+  double lon = 0;
+  double lat = 0;
+  double mos = 0;
+  time_types::ptime_t time;
+  std::tie(lon,lat,mos,time) = getCentroid(DRs);
+
+  const long long second = static_cast<long long>(
+        boost::chrono::duration_cast<time_types::seconds_t>(
+          time.time_since_epoch()).count());
+
+  const DormantCandidate* best = nullptr;
+  const DormantKey center = getDormantKey(lon,lat,second);
+  // DR is between two precomputed seconds, and near to cells' border maybe
+  for (long long s = second; s <= second+1; ++s)
+  {
+    for (long dx = -1; dx <= 1; ++dx)
+    {
+      for (long dy = -1; dy <= 1; ++dy)
+      {
+        DormantKey key = { center.cellX+dx, center.cellY+dy, s };
+        dormant_index_t::const_iterator iter = dormantIndex_.find(key);
+        if (iter == dormantIndex_.end())
+          continue;
+
+        for (const DormantCandidate& candidate : iter->second)
+        {
+          const double distance = std::sqrt(std::pow(candidate.lon-lon,2)
+                                            + std::pow(candidate.lat-lat,2));
+          if (distance <= reacquisitionDistance_
+              && (!best || candidate.probability > best->probability))
+            best = &candidate;
+        }
+      }
+    }
+  }
+
+  if (!best)
+    return std::shared_ptr<Track>();
+
+  dormant_tracks_t::iterator dormant = dormantTracks_.find(best->id);
+  std::shared_ptr<Track> track = dormant->second.track;
+  // DRs will be fused into Track, so start from propagated position
+  const double variance = reacquisitionDistance_*reacquisitionDistance_;
+  track->relocate(best->lon,best->lat,variance,variance);
+  removeDormantTrack(dormant); // invalidates best
+  tracks_.insert(track);
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+    std::stringstream msg;
+    msg << "[" << track->getUuid() << "] Dormant track reacquired.";
+    logger.log("TrackManager",msg.str());
+  }
 
   return track;
 }
 
+void TrackManager::removeDormantTrack(dormant_tracks_t::iterator dormant)
+{
+  const std::uint64_t id = dormant->first;
+  for (const DormantKey& key : dormant->second.keys)
+  {
+    dormant_index_t::iterator iter = dormantIndex_.find(key);
+    if (iter == dormantIndex_.end())
+      continue; // the same key can be stored more than once
+
+    std::vector<DormantCandidate>& candidates = iter->second;
+    candidates.erase(std::remove_if(candidates.begin(),candidates.end(),
+                                    [id](const DormantCandidate& candidate)
+                                    {
+                                      return candidate.id == id;
+                                    }),
+                     candidates.end());
+    if (candidates.empty())
+      dormantIndex_.erase(iter);
+  }
+  dormantTracks_.erase(dormant);
+}
+
+std::size_t
+  TrackManager::removeExpiredDormantTracks(time_types::ptime_t currentTime)
+{
+  std::size_t count = 0;
+  dormant_tracks_t::iterator iter = dormantTracks_.begin();
+  while (iter != dormantTracks_.end())
+  {
+    if (iter->second.expiration < currentTime)
+    {
+      removeDormantTrack(iter++);
+      ++count;
+    }
+    else
+      ++iter;
+  }
+
+  return count;
+}
+
+TrackManager::DormantKey
+  TrackManager::getDormantKey(double lon, double lat, long long second) const
+{
+  DormantKey key = { static_cast<long>(std::floor(lon/reacquisitionDistance_)),
+                     static_cast<long>(std::floor(lat/reacquisitionDistance_)),
+                     second };
+  return key;
+}
+
+std::size_t
+  TrackManager::DormantKeyHash::operator()(const DormantKey& key) const
+{
+  std::size_t seed = 0;
+  boost::hash_combine(seed,key.cellX);
+  boost::hash_combine(seed,key.cellY);
+  boost::hash_combine(seed,key.second);
+  return seed;
+}
+
 std::pair<
 TrackManager::DR_pair_rates_t, // rates
 std::set<DetectionReport> // notAssigned
@@ -165,7 +427,7 @@ TrackManager::getRatedPairs(const std::set<DetectionReport>& DRs) const
 
   DR_pair_rates_t rates;
 
-  std::set<DetectionReport> used;
+  scratch_DRs_t used;
 
   for (;it != endIt; ++it)
   { // for each DR
@@ -208,10 +470,10 @@ TrackManager::chooseFromRated(std::pair<
 
   std::vector<std::set<DetectionReport> > result;
   DR_pair_rates_t& tuples = rated.first;
-  std::set<DetectionReport> tuplesOriginally = getDRsFromTuples(tuples);
+  scratch_DRs_t tuplesOriginally = getDRsFromTuples(tuples);
 
   std::set<DetectionReport>& notAssigned = rated.second;
-  std::set<DetectionReport> used;
+  scratch_DRs_t used;
 
   while (!tuples.empty())
   { // iterate over tuples of DR,DR,rate
@@ -222,10 +484,10 @@ TrackManager::chooseFromRated(std::pair<
     used.insert(std::get<1>(*it));
 
     // firstSet contains these DRs which are paired with first DR in tuple
-    std::set<DetectionReport> firstSet
+    scratch_DRs_t firstSet
         = getSetOfPairedDRs(std::get<0>(*it),it,tuples.end());
     // secondSet contains these DRs which are paired with second DR in tuple
-    std::set<DetectionReport> secondSet
+    scratch_DRs_t secondSet
         = getSetOfPairedDRs(std::get<1>(*it),it,tuples.end());
 
     auto i = firstSet.begin();
@@ -268,9 +530,10 @@ TrackManager::chooseFromRated(std::pair<
   return result;
 }
 
-std::set<DetectionReport> TrackManager::getDRsFromTuples(const DR_pair_rates_t& tuples) const
+TrackManager::scratch_DRs_t
+  TrackManager::getDRsFromTuples(const DR_pair_rates_t& tuples) const
 {
-  std::set<DetectionReport> result;
+  scratch_DRs_t result;
   for (auto& tuple : tuples)
   {
     result.insert(std::get<0>(tuple)); //there won't be duplications because it's std::set
@@ -280,12 +543,12 @@ std::set<DetectionReport> TrackManager::getDRsFromTuples(const DR_pair_rates_t&
   return result;
 }
 
-std::set<DetectionReport>
+TrackManager::scratch_DRs_t
 TrackManager::getSetOfPairedDRs(const DetectionReport& DR,
                                 DR_pair_rates_t::const_iterator begin,
                                 DR_pair_rates_t::const_iterator end) const
 {
-  std::set<DetectionReport> result;
+  scratch_DRs_t result;
   for (; begin != end; ++begin)
   {
     if (std::get<0>(*begin) == DR)
@@ -1,14 +1,20 @@
 #ifndef TRACKMANAGER_H
 #define TRACKMANAGER_H
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
+#include <Common/arena.hpp>
+
 #include "detectionreport.h"
 #include "featureextractor.h"
+#include "roadmotionmodel.h"
+#include "sensornoisetable.h"
 #include "track.h"
 
 struct tuple_less
@@ -78,12 +84,53 @@ public:
    */
   std::set<std::shared_ptr<Track> > getTracks() const;
 
+  /**
+   * @brief Replaces all Tracks with given ones (e.g. read from checkpoint).
+   *  Dormant Tracks are dropped.
+   * @param Tracks to be maintained from now
+   */
+  void restoreTracks(const std::set<std::shared_ptr<Track> >& tracks);
+
+  /**
+   * @brief Takes over Track maintained so far by other TrackManager
+   *  (e.g. when Track crossed border of area of this one).
+   */
+  void addTrack(const std::shared_ptr<Track>& track);
+
+  /**
+   * @return true if Track was maintained by this TrackManager
+   */
+  bool removeTrack(const std::shared_ptr<Track>& track);
+
   /**
    * @brief Sets FeatureExtractor, used to merge (fuse) DRs' features
    * @param FeatureExtractor - TrackManager takes ownership of this!
    */
   void setFeatureExtractor(std::unique_ptr<FeatureExtractor> extractor);
 
+  /**
+   * @brief Sets noises of sensors. Initial variances of new Tracks
+   *  are then variances of centroid of their DRs, instead of 0.
+   */
+  void setSensorNoiseTable(std::shared_ptr<const SensorNoiseTable> noises);
+
+  /**
+   * @brief Enables dormant Tracks. Expired Tracks, which are on the street,
+   *  are not forgotten, but their positions are propagated along streets
+   *  (for each second of dormancy) and indexed by (cell, second).
+   *  When DRs not associated to any Track appear near propagated position,
+   *  dormant Track is reacquired (in O(1)), instead of initializing new one.
+   * @param motion model used to propagate positions
+   * @param how long after expiration Track can be reacquired
+   * @param maximum distance between DRs and propagated position
+   *  (dormant Tracks are disabled, when it or TTL isn't positive)
+   */
+  void setRoadMotionModel(std::shared_ptr<const Model::RoadMotionModel> model,
+                          time_types::duration_t dormantTTL,
+                          double reacquisitionDistance);
+
+  std::size_t getDormantTracksCount() const;
+
   /**
    * @brief Removes tracks which were not confirmed (refreshed)
    *  for time longer than given threshold
@@ -108,12 +155,60 @@ public:
   std::size_t removeExpiredTracks(time_types::duration_t TTL);
 
 private:
+  // cell of propagated position and second (since epoch) of propagation
+  struct DormantKey
+  {
+    long cellX;
+    long cellY;
+    long long second;
+
+    bool operator==(const DormantKey& other) const
+    {
+      return cellX == other.cellX && cellY == other.cellY
+          && second == other.second;
+    }
+  };
+
+  struct DormantKeyHash
+  {
+    std::size_t operator()(const DormantKey& key) const;
+  };
+
+  struct DormantCandidate
+  {
+    std::uint64_t id; // of dormant Track
+    double lon; // propagated position
+    double lat;
+    double probability;
+  };
+
+  struct DormantTrack
+  {
+    std::shared_ptr<Track> track;
+    std::vector<DormantKey> keys; // where candidates are in index
+    time_types::ptime_t expiration;
+  };
+
+  typedef std::unordered_map<std::uint64_t,DormantTrack> dormant_tracks_t;
+  typedef std::unordered_map<DormantKey,
+                             std::vector<DormantCandidate>,
+                             DormantKeyHash> dormant_index_t;
+
   // mapping two DRs on rate (grade which implices their quality (based on distance etc.))
+  // allocated from arena of current cycle (if any), as temporaries only
   typedef std::set<
     std::tuple<DetectionReport,DetectionReport,double>,
-    tuple_less
+    tuple_less,
+    Common::ArenaAllocator<std::tuple<DetectionReport,DetectionReport,double> >
     >DR_pair_rates_t;
 
+  // temporary set of DRs, allocated from arena of current cycle (if any)
+  typedef std::set<
+    DetectionReport,
+    std::less<DetectionReport>,
+    Common::ArenaAllocator<DetectionReport>
+    > scratch_DRs_t;
+
   /**
    * @brief Create Track based on given Detection Reports.
    *  All given DRs has to be proper for Track, it is - TrackManager is not checking them for consistency,
@@ -125,6 +220,31 @@ private:
   std::shared_ptr<Track> initializeTrack(const std::set<DetectionReport>&,
                                          std::unique_ptr<estimation::EstimationFilter<> >);
 
+  /**
+   * @brief Computes mean position and the latest time of given DRs.
+   * @return longitude, latitude, meters over sea and time
+   */
+  std::tuple<double,double,double,time_types::ptime_t>
+    getCentroid(const std::set<DetectionReport>&) const;
+
+  /**
+   * @brief Stores expired Track as dormant, if it's on the street.
+   * @param TTL, after which Track expired
+   */
+  void makeDormant(const std::shared_ptr<Track>&, time_types::duration_t TTL);
+
+  /**
+   * @brief Looks for dormant Track propagated near given DRs.
+   * @return reacquired Track (already moved to DRs) or empty pointer
+   */
+  std::shared_ptr<Track> reacquireTrack(const std::set<DetectionReport>&);
+
+  void removeDormantTrack(dormant_tracks_t::iterator);
+
+  std::size_t removeExpiredDormantTracks(time_types::ptime_t currentTime);
+
+  DormantKey getDormantKey(double lon, double lat, long long second) const;
+
   std::pair<
   DR_pair_rates_t, // rates
   std::set<DetectionReport> // notAssigned
@@ -137,14 +257,14 @@ private:
                             std::set<DetectionReport> // notAssigned
                            >) const;
 
-  std::set<DetectionReport> getDRsFromTuples(const DR_pair_rates_t&) const;
+  scratch_DRs_t getDRsFromTuples(const DR_pair_rates_t&) const;
 
   /**
    * @brief iterates over collection of tuples containing two DRs and their rating,
    *  buliding set of DRs, which has only these DRs which exist in pairs with given DR.
    * @return set of DRs connected with given one.
    */
-  std::set<DetectionReport> getSetOfPairedDRs(const DetectionReport&,
+  scratch_DRs_t getSetOfPairedDRs(const DetectionReport&,
                                               DR_pair_rates_t::const_iterator,
                                               DR_pair_rates_t::const_iterator) const;
 
@@ -177,9 +297,16 @@ private:
 
   std::set<std::shared_ptr<Track> > tracks_;
   std::unique_ptr<FeatureExtractor> featureExtractor_;
+  std::shared_ptr<const SensorNoiseTable> sensorNoises_;
 
   const double initializationDRThreshold_;
 
+  std::shared_ptr<const Model::RoadMotionModel> roadMotionModel_;
+  time_types::duration_t dormantTTL_;
+  double reacquisitionDistance_; // also size of index cell
+  dormant_tracks_t dormantTracks_;
+  dormant_index_t dormantIndex_;
+  std::uint64_t nextDormantId_;
 };
 
 #endif // TRACKMANAGER_H
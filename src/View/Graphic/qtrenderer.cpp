@@ -1,6 +1,8 @@
 #include "qtrenderer.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include <boost/random/uniform_int_distribution.hpp>
 
@@ -8,10 +10,16 @@
 #include <QMenuBar>
 
 #include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
+#include <QGraphicsRectItem>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QScrollBar>
+#include <QTimer>
 
 #include <QColor>
+#include <QLineF>
+#include <QMetaType>
 #include <QPen>
 
 #include <View/qtview.h>
@@ -36,7 +44,9 @@ GraphicalTrack::GraphicalTrack(boost::uuids::uuid uuid,
                                          predictionY-heightFactor*height/2.0,
                                          widthFactor*width,
                                          heightFactor*height)),
-    uuid_(uuid)
+    uuid_(uuid),
+    width_(width),
+    height_(height)
 {
   prediction_->setParentItem(this);
 }
@@ -46,6 +56,25 @@ boost::uuids::uuid GraphicalTrack::getUuid() const
   return uuid_;
 }
 
+void GraphicalTrack::setState(const TrackState& state)
+{
+  setRect(state.x-width_/2.0,state.y-height_/2.0,width_,height_);
+  prediction_->setRect(state.predictionX-state.widthFactor*width_/2.0,
+                       state.predictionY-state.heightFactor*height_/2.0,
+                       state.widthFactor*width_,
+                       state.heightFactor*height_);
+}
+
+QRectF GraphicalTrack::getPredictionRect() const
+{
+  return prediction_->rect();
+}
+
+void GraphicalTrack::setPredictionVisible(bool visible)
+{
+  prediction_->setVisible(visible);
+}
+
 /******************************************************************************/
 
 GraphicalStreet::GraphicalStreet(
@@ -56,20 +85,58 @@ GraphicalStreet::GraphicalStreet(
 /******************************************************************************/
 
 QtRenderer::QtRenderer(QtView* parent)
-  : parent_(parent),
+  : tracksGrid_(Common::Configuration::ConfigurationManager
+                  ::getCastedValue<double>("View",
+                                           "Renderer.GridCellSize",
+                                           0.001)),
+    updateNumber_(0),
+    streetsGrid_(tracksGrid_.getCellSize()),
+    visibleNumber_(0),
+    frameTimer_(new QTimer(this)),
+    varianceFactor_(Common::Configuration::ConfigurationManager
+                      ::getCastedValue<double>("View",
+                                               "Renderer.VarianceFactor",
+                                               500)),
+    frameInterval_(1000
+                   / std::max(1,Common::Configuration::ConfigurationManager
+                                  ::getCastedValue<int>("View",
+                                                        "Renderer.RefreshRate",
+                                                        60))),
+    heatMapThreshold_(Common::Configuration::ConfigurationManager
+                        ::getCastedValue<double>("View",
+                                                 "Renderer.HeatMapThreshold",
+                                                 2)),
+    heatCellPixels_(std::max(1.0,
+                             Common::Configuration::ConfigurationManager
+                               ::getCastedValue<double>("View",
+                                                        "Renderer.HeatCellSize",
+                                                        16))),
+    predictionThreshold_(Common::Configuration::ConfigurationManager
+                           ::getCastedValue<double>(
+                             "View",
+                             "Renderer.PredictionThreshold",
+                             3)),
+    parent_(parent),
     mainWindow_(new QMainWindow()),
     scene_(new QGraphicsScene()),
     view_(new QGraphicsView(scene_))
 {
+  // signals are emitted from Controller's thread, so are queued
+  qRegisterMetaType<GraphicalStreet*>("GraphicalStreet*");
+
+  // items are culled by our own grids, BSP index would only slow down
+  // adding and removing them
+  scene_->setItemIndexMethod(QGraphicsScene::NoIndex);
+
+  frameTimer_->setSingleShot(true);
+  connect(frameTimer_,SIGNAL(timeout()),SLOT(performUpdateTracks()));
+
   mainWindow_->setAttribute(Qt::WA_QuitOnClose,false);
-  connect(this,SIGNAL(addTrackSignal(GraphicalTrack*)),
-          SLOT(performAddTrack(GraphicalTrack*)));
+  connect(this,SIGNAL(updateTracksSignal()),SLOT(performUpdateTracks()));
 
   connect(this,SIGNAL(addStreetSignal(GraphicalStreet*)),
           SLOT(performAddStreet(GraphicalStreet*)));
 
-  connect(this,SIGNAL(clearSceneSignal()),SLOT(performClearScene()));
-
   connect(this,SIGNAL(exitRequestedSignal()),SLOT(quitRequested()));
 
   connect(this,SIGNAL(showSignal()),mainWindow_,SLOT(show()));
@@ -79,6 +146,11 @@ QtRenderer::QtRenderer(QtView* parent)
   setupMenu();
   view_->scale(80000.0,80000.0);
   mainWindow_->setCentralWidget(view_);
+
+  connect(view_->horizontalScrollBar(),SIGNAL(valueChanged(int)),
+          SLOT(refreshVisibleItems()));
+  connect(view_->verticalScrollBar(),SIGNAL(valueChanged(int)),
+          SLOT(refreshVisibleItems()));
 }
 
 QtRenderer::~QtRenderer()
@@ -93,10 +165,24 @@ void QtRenderer::show()
   emit showSignal();
 }
 
-void QtRenderer::addTrack(const Track* track)
+void QtRenderer::updateTracks(const std::set<std::unique_ptr<Track> >& tracks)
 {
-  GraphicalTrack* graphicalTrack = transformTrackFromSnapshot(track);
-  emit addTrackSignal(graphicalTrack); // invokeLater (put into Qt msg queue)
+  std::unique_ptr<TracksUpdate> update(new TracksUpdate());
+  update->tracks.reserve(tracks.size());
+  for (const std::unique_ptr<Track>& track : tracks)
+  {
+    update->tracks.push_back(transformTrackFromSnapshot(&*track));
+  }
+
+  bool alreadyPending = false;
+  {
+    std::lock_guard<std::mutex> lock(pendingUpdateMutex_);
+    alreadyPending = (bool)pendingUpdate_;
+    pendingUpdate_ = std::move(update); // older (not drawn) one is dropped
+  }
+
+  if (!alreadyPending)
+    emit updateTracksSignal(); // invokeLater (put into Qt msg queue)
 }
 
 void QtRenderer::addStreet(
@@ -106,11 +192,6 @@ void QtRenderer::addStreet(
   emit addStreetSignal(graphicalStreet); // invokeLater
 }
 
-void QtRenderer::clearScene()
-{
-  emit clearSceneSignal(); // invokeLater
-}
-
 void QtRenderer::requestExit()
 {
   emit exitRequestedSignal(); // invokeLater
@@ -121,10 +202,27 @@ void QtRenderer::close()
   emit quitSignal(); // invokeLater
 }
 
-void QtRenderer::performAddTrack(GraphicalTrack* graphicalTrack)
+void QtRenderer::performUpdateTracks()
 {
-  colorManager_.setColorForTrack(graphicalTrack);
-  scene_->addItem(graphicalTrack);
+  if (lastFrame_.isValid() && lastFrame_.elapsed() < frameInterval_)
+  { // too early - pending update will be applied with next frame
+    if (!frameTimer_->isActive())
+      frameTimer_->start(frameInterval_ - lastFrame_.elapsed());
+    return;
+  }
+
+  std::unique_ptr<TracksUpdate> update;
+  {
+    std::lock_guard<std::mutex> lock(pendingUpdateMutex_);
+    update = std::move(pendingUpdate_);
+  }
+
+  if (!update)
+    return;
+
+  lastFrame_.start();
+  applyTracksUpdate(*update);
+  refreshVisibleItems();
 }
 
 void QtRenderer::performAddStreet(GraphicalStreet* graphicalStreet)
@@ -132,43 +230,311 @@ void QtRenderer::performAddStreet(GraphicalStreet* graphicalStreet)
   const std::shared_ptr<Model::WorldSnapshot::StreetSnapshot> street
       = graphicalStreet->street;
 
-  scene_->addLine(street->first->lon,street->first->lat,
-                  street->second->lon,street->second->lat);
+  // static layer - drawn once, below tracks
+  QGraphicsLineItem* line
+      = scene_->addLine(street->first->lon,street->first->lat,
+                        street->second->lon,street->second->lat);
+  line->setZValue(0);
+
+  const QLineF segment = line->line();
+  const qreal minX = std::min(segment.x1(),segment.x2());
+  const qreal maxX = std::max(segment.x1(),segment.x2());
+  const qreal minY = std::min(segment.y1(),segment.y2());
+  const qreal maxY = std::max(segment.y1(),segment.y2());
+
+  streets_.push_back(StreetEntry{line,visibleNumber_});
+  StreetEntry* entry = &streets_.back();
+  streetsGrid_.insert(minX,minY,maxX,maxY,entry);
+
+  const QRectF visibleRect = getVisibleRect();
+  if (maxX >= visibleRect.left() && minX <= visibleRect.right()
+      && maxY >= visibleRect.top() && minY <= visibleRect.bottom())
+    visibleStreets_.push_back(entry);
+  else
+    line->setVisible(false);
 
   delete graphicalStreet;
 }
 
-void QtRenderer::performClearScene()
+void QtRenderer::quitRequested()
 {
-  scene_->clear();
-  drawStaticGraphics();
+  assert(parent_);
+  parent_->quitRequested();
 }
 
-void QtRenderer::quitRequested()
+void QtRenderer::batchModeRequested()
 {
   assert(parent_);
-  parent_->quitRequested();
+  parent_->workModeChangeRequested(true);
+}
+
+void QtRenderer::onlineModeRequested()
+{
+  assert(parent_);
+  parent_->workModeChangeRequested(false);
+}
+
+void QtRenderer::refreshVisibleItems()
+{
+  ++visibleNumber_;
+  const QRectF visibleRect = getVisibleRect();
+  refreshStreets(visibleRect);
+  refreshTracks(visibleRect,getScale());
+}
+
+void QtRenderer::zoomIn()
+{
+  view_->scale(2.0,2.0);
+  refreshVisibleItems();
+}
+
+void QtRenderer::zoomOut()
+{
+  view_->scale(0.5,0.5);
+  refreshVisibleItems();
+}
+
+TrackState QtRenderer::transformTrackFromSnapshot(const Track* track) const
+{
+  TrackState state;
+  state.uuid = track->getUuid();
+  state.x = track->getLongitude();
+  state.y = track->getLatitude();
+  state.predictionX = track->getPredictedLongitude();
+  state.predictionY = track->getPredictedLatitude();
+  state.widthFactor
+      = varianceFactor_*track->getLongitudePredictionVariance();
+  state.heightFactor
+      = varianceFactor_*track->getLatitudePredictionVariance();
+
+  return state;
+}
+
+void QtRenderer::applyTracksUpdate(const TracksUpdate& update)
+{
+  ++updateNumber_;
+  for (const TrackState& state : update.tracks)
+  {
+    tracks_map_t::iterator iter = tracks_.find(state.uuid);
+    if (iter == tracks_.end()) // track birth; drawn when found in view
+    {
+      iter = tracks_.insert(
+               std::make_pair(state.uuid,
+                              TrackEntry{state,nullptr,0,0})).first;
+    }
+    iter->second.state = state;
+    iter->second.lastUpdate = updateNumber_;
+  }
+
+  // tracks not refreshed by this update are dead
+  for (tracks_map_t::value_type& track : tracks_)
+  {
+    if (track.second.lastUpdate != updateNumber_)
+      cullTrack(track.second);
+  }
+  materializedTracks_.erase(
+        std::remove_if(materializedTracks_.begin(),materializedTracks_.end(),
+                       [](const TrackEntry* entry)
+                       {
+                         return entry->item == nullptr;
+                       }),
+        materializedTracks_.end());
+
+  tracksGrid_.clear();
+  tracks_map_t::iterator iter = tracks_.begin();
+  while (iter != tracks_.end())
+  {
+    if (iter->second.lastUpdate != updateNumber_)
+    {
+      colorManager_.releaseColorForTrack(iter->first);
+      tracks_.erase(iter++);
+    }
+    else
+    {
+      tracksGrid_.insert(iter->second.state.x,iter->second.state.y,
+                         &iter->second);
+      ++iter;
+    }
+  }
+}
+
+void QtRenderer::materializeTrack(TrackEntry& entry, qreal scale)
+{
+  if (entry.item == nullptr)
+  {
+    const TrackState& state = entry.state;
+    entry.item = new GraphicalTrack(state.uuid,
+                                    state.x,state.y,
+                                    state.predictionX,state.predictionY,
+                                    state.widthFactor,state.heightFactor);
+    colorManager_.setColorForTrack(entry.item);
+    entry.item->setZValue(1); // above static layer
+    scene_->addItem(entry.item);
+  }
+  else
+  {
+    entry.item->setState(entry.state);
+  }
+
+  const QRectF prediction = entry.item->getPredictionRect();
+  entry.item->setPredictionVisible(
+        std::max(prediction.width(),prediction.height())*scale
+        >= predictionThreshold_);
+}
+
+void QtRenderer::cullTrack(TrackEntry& entry)
+{
+  if (entry.item == nullptr)
+    return;
+
+  scene_->removeItem(entry.item);
+  delete entry.item; // deletes prediction (child item) too
+  entry.item = nullptr;
+}
+
+void QtRenderer::refreshStreets(const QRectF& visibleRect)
+{
+  std::vector<StreetEntry*> nowVisible;
+  streetsGrid_.query(visibleRect.left(),visibleRect.top(),
+                     visibleRect.right(),visibleRect.bottom(),
+                     [this,&nowVisible](StreetEntry* entry)
+                     {
+                       if (entry->lastVisible != visibleNumber_)
+                       { // streets spanning many cells are visited many times
+                         entry->lastVisible = visibleNumber_;
+                         nowVisible.push_back(entry);
+                       }
+                     });
+
+  for (StreetEntry* entry : visibleStreets_)
+  {
+    if (entry->lastVisible != visibleNumber_)
+      entry->item->setVisible(false);
+  }
+  for (StreetEntry* entry : nowVisible)
+  {
+    entry->item->setVisible(true);
+  }
+  visibleStreets_.swap(nowVisible);
 }
 
-GraphicalTrack* QtRenderer::transformTrackFromSnapshot(const Track* track)
+void QtRenderer::refreshTracks(const QRectF& visibleRect, qreal scale)
 {
-  qreal x = track->getLongitude();
-  qreal y = track->getLatitude();
-  qreal predictedX = track->getPredictedLongitude();
-  qreal predictedY = track->getPredictedLatitude();
-  qreal varX = track->getLongitudePredictionVariance();
-  qreal varY = track->getLatitudePredictionVariance();
+  // tracks are drawn as GraphicalTrack's default size (in degrees)
+  const qreal trackSize = 0.0001*scale;
+  if (trackSize < heatMapThreshold_)
+  { // zoomed out so much, that single tracks are unreadable - aggregate them
+    for (TrackEntry* entry : materializedTracks_)
+    {
+      cullTrack(*entry);
+    }
+    materializedTracks_.clear();
+    refreshHeatCells(visibleRect,scale);
+    return;
+  }
+
+  hideHeatCells();
+
+  std::vector<TrackEntry*> nowVisible;
+  tracksGrid_.query(visibleRect.left(),visibleRect.top(),
+                    visibleRect.right(),visibleRect.bottom(),
+                    [&](TrackEntry* entry)
+                    {
+                      entry->lastVisible = visibleNumber_;
+                      materializeTrack(*entry,scale);
+                      nowVisible.push_back(entry);
+                    });
+
+  for (TrackEntry* entry : materializedTracks_)
+  {
+    if (entry->lastVisible != visibleNumber_)
+      cullTrack(*entry);
+  }
+  materializedTracks_.swap(nowVisible);
+}
 
-  double varianceFactor
-      = Common::Configuration::ConfigurationManager
-          ::getCastedValue<double>("View","Renderer.VarianceFactor",500);
+void QtRenderer::refreshHeatCells(const QRectF& visibleRect, qreal scale)
+{
+  // heat cell is multiple of grid cell, about heatCellPixels_ on screen,
+  //  so number of heat cells is bounded by viewport size (in pixels)
+  const double gridCellSize = tracksGrid_.getCellSize();
+  const double factor
+      = std::max(1.0,std::ceil(heatCellPixels_/(scale*gridCellSize)));
+  const double cellSize = factor*gridCellSize;
+  const long minCX = static_cast<long>(std::floor(visibleRect.left()/cellSize));
+  const long minCY = static_cast<long>(std::floor(visibleRect.top()/cellSize));
+  const long columns
+      = static_cast<long>(std::floor(visibleRect.right()/cellSize)) - minCX + 1;
+  const long rows
+      = static_cast<long>(std::floor(visibleRect.bottom()/cellSize)) - minCY + 1;
+  heatCounts_.assign(columns*rows,0);
+
+  tracksGrid_.forEachCell(visibleRect.left(),visibleRect.top(),
+                          visibleRect.right(),visibleRect.bottom(),
+                          [&](double cellX, double cellY,
+                              const std::vector<TrackEntry*>& items)
+                          {
+                            // by center of grid cell - no rounding issues
+                            const long cx = static_cast<long>(std::floor(
+                                  (cellX + gridCellSize/2)/cellSize)) - minCX;
+                            const long cy = static_cast<long>(std::floor(
+                                  (cellY + gridCellSize/2)/cellSize)) - minCY;
+                            if (cx >= 0 && cx < columns && cy >= 0 && cy < rows)
+                              heatCounts_[cy*columns + cx] += items.size();
+                          });
+
+  std::size_t maxCount = 1;
+  for (std::size_t count : heatCounts_)
+  {
+    maxCount = std::max(maxCount,count);
+  }
 
-  GraphicalTrack* graphicalTrack = new GraphicalTrack(track->getUuid(),
-                                                      x,y,
-                                                      predictedX,predictedY,
-                                                      varianceFactor*varX,
-                                                      varianceFactor*varY);
-  return graphicalTrack;
+  std::size_t used = 0;
+  for (long cy = 0; cy < rows; ++cy)
+  {
+    for (long cx = 0; cx < columns; ++cx)
+    {
+      const std::size_t count = heatCounts_[cy*columns + cx];
+      if (count == 0)
+        continue;
+
+      if (used == heatCells_.size())
+      {
+        QGraphicsRectItem* cell = new QGraphicsRectItem();
+        cell->setPen(Qt::NoPen);
+        cell->setZValue(1); // above static layer
+        scene_->addItem(cell);
+        heatCells_.push_back(cell);
+      }
+      QGraphicsRectItem* cell = heatCells_[used++];
+      QColor color(Qt::red);
+      // more tracks in cell - less transparent
+      color.setAlpha(55 + 200*count/maxCount);
+      cell->setBrush(color);
+      cell->setRect((minCX + cx)*cellSize,(minCY + cy)*cellSize,
+                    cellSize,cellSize);
+      cell->setVisible(true);
+    }
+  }
+  hideHeatCells(used);
+}
+
+void QtRenderer::hideHeatCells(std::size_t from)
+{
+  for (std::size_t i = from; i < heatCells_.size(); ++i)
+  {
+    heatCells_[i]->setVisible(false);
+  }
+}
+
+QRectF QtRenderer::getVisibleRect() const
+{
+  return view_->mapToScene(view_->viewport()->rect()).boundingRect();
+}
+
+qreal QtRenderer::getScale() const
+{
+  return view_->transform().m11(); // pixels per scene unit
 }
 
 void QtRenderer::drawStaticGraphics()
@@ -183,6 +549,12 @@ void QtRenderer::drawBackground()
 
 void QtRenderer::setupMenu()
 {
+  mainWindow_->menuBar()->addAction(tr("Zoom in"), this, SLOT(zoomIn()));
+  mainWindow_->menuBar()->addAction(tr("Zoom out"), this, SLOT(zoomOut()));
+  mainWindow_->menuBar()->addAction(tr("Batch"), this,
+                                    SLOT(batchModeRequested()));
+  mainWindow_->menuBar()->addAction(tr("Online"), this,
+                                    SLOT(onlineModeRequested()));
   mainWindow_->menuBar()->addAction(tr("Quit"), this, SLOT(quitRequested()));
 }
 
@@ -231,6 +603,12 @@ QtRenderer::ColorManager::chooseColorForTrack(const GraphicalTrack* track)
   }
 }
 
+void QtRenderer::ColorManager
+  ::releaseColorForTrack(const boost::uuids::uuid& uuid)
+{
+  trackColors_.remove(uuid);
+}
+
 std::pair<QColor,QColor> QtRenderer::ColorManager
   ::generateNewColorForTrack(const GraphicalTrack* /*track*/) const
 {
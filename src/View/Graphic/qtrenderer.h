@@ -1,20 +1,33 @@
 #ifndef VIEW_GRAPHIC_QTRENDERER_H
 #define VIEW_GRAPHIC_QTRENDERER_H
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/uuid/uuid.hpp>
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QObject>
 #include <QGraphicsEllipseItem>
+#include <QRectF>
+
+#include <Common/spatialgrid.hpp>
 
 #include <Model/modelsnapshot.h>
 
+class QGraphicsLineItem;
+class QGraphicsRectItem;
 class QGraphicsScene;
 class QGraphicsView;
 class QMainWindow;
+class QTimer;
 class Track;
 
 namespace View
@@ -25,6 +38,24 @@ namespace Graphic
 
 class QtView;
 
+// plain copy of Track's data needed to draw it; cheap to pass between threads
+struct TrackState
+{
+  boost::uuids::uuid uuid;
+  qreal x;
+  qreal y;
+  qreal predictionX;
+  qreal predictionY;
+  qreal widthFactor;
+  qreal heightFactor;
+};
+
+// whole set of tracks from one Model's snapshot, passed to Qt's thread at once
+struct TracksUpdate
+{
+  std::vector<TrackState> tracks;
+};
+
 class GraphicalTrack : public QGraphicsEllipseItem
 {
 public:
@@ -36,9 +67,21 @@ public:
 
   boost::uuids::uuid getUuid() const;
 
+  /**
+   * @brief Moves already drawn track (and it's prediction) to given position.
+   *  Item stays in scene, so nothing is reallocated.
+   * @param TrackState - new position, prediction and it's variance factors
+   */
+  void setState(const TrackState&);
+
+  QRectF getPredictionRect() const;
+  void setPredictionVisible(bool visible);
+
 private:
   QGraphicsEllipseItem* prediction_;
   const boost::uuids::uuid uuid_;
+  const qreal width_;
+  const qreal height_;
 };
 
 // holds street snapshot, as long as Qt needs it.
@@ -59,26 +102,44 @@ public:
   virtual ~QtRenderer();
 
   void show();
-  void addTrack(const Track*); // TODO there should be TrackSnapshot,
-                               // instead of Track
+
+  /**
+   * @brief Puts tracks from Model's snapshot into scene.
+   *  Tracks already drawn (matched by UUID) are only moved,
+   *  new ones are added and these which disappeared - removed from scene.
+   *  Streets (static map layer) are not touched.
+   * @param Tracks from snapshot; copied, so may be released after return.
+   */
+  void updateTracks(const std::set<std::unique_ptr<Track> >&);
   void addStreet(const std::shared_ptr<Model::WorldSnapshot::StreetSnapshot>);
-  void clearScene();
   void requestExit();
   void close();
 
 signals:
-  void addTrackSignal(GraphicalTrack*);
+  // emitted only when there was no pending update (at most one is queued)
+  void updateTracksSignal();
   void addStreetSignal(GraphicalStreet*);
-  void clearSceneSignal();
   void exitRequestedSignal();
   void showSignal();
   void quitSignal();
 
 protected slots:
-  void performAddTrack(GraphicalTrack*);
+  // applies pending update, but not more often than display refresh rate
+  void performUpdateTracks();
   void performAddStreet(GraphicalStreet*);
-  void performClearScene();
   void quitRequested();
+  void batchModeRequested();
+  void onlineModeRequested();
+
+  /**
+   * @brief Puts into scene only these items, which are in viewport.
+   *  Applies level of detail rules:
+   *  when zoomed out, tracks are aggregated into heat cells,
+   *  predictions too small to be seen are hidden.
+   */
+  void refreshVisibleItems();
+  void zoomIn();
+  void zoomOut();
 
 private:
   class ColorManager
@@ -94,6 +155,9 @@ private:
     //      have the same color assigned)
     std::pair<QColor,QColor> chooseColorForTrack(const GraphicalTrack*);
 
+    // forgets color of track, which does not exist anymore
+    void releaseColorForTrack(const boost::uuids::uuid&);
+
   private:
     std::pair<QColor,QColor>
       generateNewColorForTrack(const GraphicalTrack*) const;
@@ -104,13 +168,67 @@ private:
     mutable boost::random::mt19937 randomGenerator_;
   };
 
-  static GraphicalTrack* transformTrackFromSnapshot(const Track*);
+  struct TrackEntry
+  {
+    TrackState state;
+    GraphicalTrack* item; // nullptr when culled (out of view or aggregated)
+    unsigned lastUpdate; // number of update which refreshed track lastly
+    unsigned lastVisible; // number of refresh which found track in view
+  };
+
+  struct StreetEntry
+  {
+    QGraphicsLineItem* item;
+    unsigned lastVisible;
+  };
+
+  typedef std::unordered_map<boost::uuids::uuid,
+                             TrackEntry,
+                             boost::hash<boost::uuids::uuid> > tracks_map_t;
+
+  TrackState transformTrackFromSnapshot(const Track*) const;
+  void applyTracksUpdate(const TracksUpdate&);
+  void materializeTrack(TrackEntry&, qreal scale);
+  void cullTrack(TrackEntry&);
+  void refreshStreets(const QRectF& visibleRect);
+  void refreshTracks(const QRectF& visibleRect, qreal scale);
+  void refreshHeatCells(const QRectF& visibleRect, qreal scale);
+  void hideHeatCells(std::size_t from = 0);
+  QRectF getVisibleRect() const;
+  qreal getScale() const;
   void drawStaticGraphics();
   void drawBackground();
   void setupMenu();
 
   ColorManager colorManager_;
 
+  // all tracks from last applied snapshot, by UUID;
+  // pointers to entries are stable (unordered_map does not move elements)
+  tracks_map_t tracks_;
+  Common::SpatialGrid<TrackEntry*> tracksGrid_; // rebuilt with each update
+  std::vector<TrackEntry*> materializedTracks_; // these with item in scene
+  unsigned updateNumber_; // incremented with each applied update
+
+  std::deque<StreetEntry> streets_; // deque - stable addresses for grid
+  Common::SpatialGrid<StreetEntry*> streetsGrid_;
+  std::vector<StreetEntry*> visibleStreets_;
+  unsigned visibleNumber_; // incremented with each refreshVisibleItems()
+
+  std::vector<QGraphicsRectItem*> heatCells_; // reused between refreshes
+  std::vector<std::size_t> heatCounts_; // tracks per visible heat cell
+
+  // written by Controller's thread, read by Qt's one
+  std::unique_ptr<TracksUpdate> pendingUpdate_;
+  std::mutex pendingUpdateMutex_;
+  QTimer* frameTimer_;
+  QElapsedTimer lastFrame_;
+
+  const double varianceFactor_;
+  const int frameInterval_; // milliseconds between applied updates
+  const double heatMapThreshold_; // track size (px) to aggregate below
+  const double heatCellPixels_; // heat cell size (px), whatever the zoom
+  const double predictionThreshold_; // prediction size (px) to hide below
+
   QtView* parent_;
 
   QMainWindow* mainWindow_;
@@ -13,8 +13,8 @@ namespace Graphic
 {
 
 QtView
-::QtView(std::shared_ptr<Common::BlockingQueue<Controller::MessagePtr> >bq)
-  : blockingQueue_(bq),
+::QtView(std::shared_ptr<Controller::MessageQueue> mq)
+  : messageQueue_(mq),
     renderer_(new QtRenderer(this))
 {
   renderer_->show();
@@ -35,18 +35,11 @@ void QtView::showState(Model::Snapshot snapshot)
     msg << "Received snapshot, containing " << tracks->size() << " track(s).";
     Common::GlobalLogger::getInstance().log("QtView",msg.str());
   }
-  renderer_->clearScene(); // TODO consider not clearing scene (background)
-
-  for (const std::unique_ptr<Track>& track : *tracks)
-  {
-    renderer_->addTrack(&*track); // ugly &*,
-                // but std::unique_ptr::release() not allowed in const object,
-                // std::set implices const
-
-    // This is safe (no race conditions),
-    //  because QtRenderer transforms this into it's own object, than returns,
-    //  so needed object is hold as long as needed.
-  }
+  // Scene is not cleared - static map stays, tracks are updated in place.
+  // This is safe (no race conditions),
+  //  because QtRenderer copies needed data into it's own objects, than returns,
+  //  so needed objects are hold as long as needed.
+  renderer_->updateTracks(*tracks);
 }
 
 void QtView::worldStateChange(std::unique_ptr<Model::WorldSnapshot> snapshot)
@@ -68,13 +61,21 @@ void QtView::worldStateChange(std::unique_ptr<Model::WorldSnapshot> snapshot)
 void QtView::quitRequested()
 {
   Controller::MessagePtr msg(new Controller::QuitRequestedMessage());
-  blockingQueue_->push(msg);
+  messageQueue_->push(msg);
 }
 
 void QtView::requestMapData()
 {
   Controller::MessagePtr msg(new Controller::MapSnapshotRequestedMessage());
-  blockingQueue_->push(msg);
+  messageQueue_->push(msg);
+}
+
+void QtView::workModeChangeRequested(bool batch)
+{
+  typedef Controller::WorkingModeChangeMessage WMCMessage;
+  Controller::MessagePtr msg(
+        new WMCMessage(batch ? WMCMessage::BATCH : WMCMessage::LIVE));
+  messageQueue_->push(msg);
 }
 
 void QtView::quit()
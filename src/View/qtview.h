@@ -5,9 +5,8 @@
 
 #include <View/view.h>
 
-#include <Common/blockingqueue.hpp>
-
 #include <Controller/common/message.h>
+#include <Controller/common/messagequeue.h>
 
 namespace View
 {
@@ -20,7 +19,7 @@ class QtRenderer;
 class QtView : public View
 {
 public:
-  QtView(std::shared_ptr<Common::BlockingQueue<Controller::MessagePtr> >);
+  QtView(std::shared_ptr<Controller::MessageQueue>);
   virtual ~QtView();
   virtual void showState(Model::Snapshot);
   virtual void worldStateChange(std::unique_ptr<Model::WorldSnapshot>);
@@ -31,11 +30,14 @@ public:
   // invoked by renderer
   virtual void requestMapData();
 
+  // invoked by renderer; true - batch (replay), false - online
+  virtual void workModeChangeRequested(bool batch);
+
   // invoked by Controller
   virtual void quit();
 
 private:
-  std::shared_ptr<Common::BlockingQueue<Controller::MessagePtr> > blockingQueue_;
+  std::shared_ptr<Controller::MessageQueue> messageQueue_;
   QtRenderer* renderer_;
 };
 
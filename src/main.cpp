@@ -6,7 +6,6 @@
 #include <QApplication>
 #include <QThread>
 
-#include <Common/blockingqueue.hpp>
 #include <Common/configurationmanager.h>
 #include <Common/logger.h>
 
@@ -17,6 +16,7 @@
 #include <Controller/maincontroller.h>
 #include <Controller/qtcontrollerwrapper.h>
 #include <Controller/common/message.h>
+#include <Controller/common/messagequeue.h>
 
 #include <View/qtview.h>
 
@@ -51,15 +51,15 @@ int main(int argc, char* argv[])
 
   QApplication app(argc,argv);
 
-  std::shared_ptr<Common::BlockingQueue<Controller::MessagePtr> >
-    blockingQueue(new Common::BlockingQueue<Controller::MessagePtr>());
+  std::shared_ptr<Controller::MessageQueue>
+    messageQueue(new Controller::MessageQueue());
 
   std::unique_ptr<Model::Model> model(new Model::DataManager());
   logger.log("main","Model instantiated.");
-  std::unique_ptr<View::View> view(new View::Graphic::QtView(blockingQueue));
+  std::unique_ptr<View::View> view(new View::Graphic::QtView(messageQueue));
   logger.log("main","View instantiated.");
   std::unique_ptr<Controller::Controller> controller(
-         new Controller::MainController(blockingQueue,
+         new Controller::MainController(messageQueue,
                                         std::move(model),
                                         std::move(view))
         );
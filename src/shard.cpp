@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream> // used for logging purpose
+#include <string>
+
+#include <boost/lexical_cast.hpp>
+
+#include <Common/configurationmanager.h>
+#include <Common/logger.h>
+
+#include <Model/datamanager.h>
+#include <Model/Distributed/shardserver.h>
+
+/**
+ * Shard of distributed tracker. Serves one tile of ShardedTracker
+ * to Tracker configured with Model.Distributed.Shards.
+ */
+int main(int argc, char* argv[])
+{
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <port>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  unsigned short port;
+  try
+  {
+    port = boost::lexical_cast<unsigned short>(argv[1]);
+  }
+  catch (const boost::bad_lexical_cast&)
+  {
+    std::cerr << "Invalid port: " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Common::GlobalLogger& logger = Common::GlobalLogger::getInstance();
+  logger.setAgent(std::unique_ptr<Common::LoggerAgent>(
+                    new Common::ConsoleLoggerAgent()));
+
+  Common::Configuration::ConfigurationManager::KeyValueMap options
+      = Common::Configuration::getConfigurationFromFile("settings.ini");
+  Common::Configuration::ConfigurationManager& confMan
+      = Common::Configuration::ConfigurationManager::getInstance();
+  confMan.parseKeyValueMapIntoConfiguration(options);
+
+  Model::Distributed::ShardServer server(
+        port,
+        Model::DataManager::createShardFactory(),
+        Model::DataManager::createFilter());
+
+  { // TODO rewrite this, when logger will be more sophisticated
+    std::stringstream msg;
+    msg << "Listening on port " << server.getPort();
+    logger.log("main",msg.str());
+  }
+
+  server.run();
+
+  return EXIT_SUCCESS;
+}
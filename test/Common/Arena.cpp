@@ -0,0 +1,67 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Common/arena.hpp>
+
+BOOST_AUTO_TEST_SUITE( Arena_test )
+
+BOOST_AUTO_TEST_CASE( Arena_reuses_memory )
+{
+  Common::Arena arena(1024);
+
+  void* first = arena.allocate(10);
+  void* second = arena.allocate(1);
+  BOOST_CHECK(first != second);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(second)
+                    % alignof(std::max_align_t),0);
+
+  // bigger than block - new block is taken
+  arena.allocate(4096);
+  const std::size_t capacity = arena.getCapacity();
+  BOOST_CHECK(capacity >= 1024 + 4096);
+
+  arena.release();
+  BOOST_CHECK(arena.allocate(10) == first);
+  arena.allocate(4096);
+  BOOST_CHECK_EQUAL(arena.getCapacity(),capacity); // nothing more taken
+}
+
+BOOST_AUTO_TEST_CASE( Allocator_uses_scope )
+{
+  Common::Arena arena;
+  BOOST_CHECK(Common::Arena::current() == nullptr);
+
+  typedef std::set<int,std::less<int>,Common::ArenaAllocator<int> > set_t;
+  set_t outside; // global allocator
+  outside.insert(1);
+  BOOST_CHECK(outside.get_allocator().getArena() == nullptr);
+
+  {
+    Common::ArenaScope scope(arena);
+    BOOST_CHECK(Common::Arena::current() == &arena);
+
+    set_t inside;
+    BOOST_CHECK(inside.get_allocator().getArena() == &arena);
+    for (int i = 0; i < 1000; ++i)
+      inside.insert(i);
+    BOOST_CHECK_EQUAL(inside.size(),1000);
+    BOOST_CHECK(arena.getCapacity() > 0);
+
+    { // nested scope of the same arena doesn't release it
+      Common::ArenaScope nested(arena);
+      std::vector<int,Common::ArenaAllocator<int> > v(100,7);
+    }
+    BOOST_CHECK_EQUAL(*inside.rbegin(),999);
+  }
+
+  BOOST_CHECK(Common::Arena::current() == nullptr);
+  outside.insert(2);
+  BOOST_CHECK_EQUAL(outside.size(),2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Common/mpscqueue.hpp>
+
+BOOST_AUTO_TEST_SUITE( MPSCQueue_test )
+
+BOOST_AUTO_TEST_CASE( MPSCQueue_fifo_order )
+{
+  Common::MPSCQueue<int> queue;
+  BOOST_CHECK(queue.empty());
+
+  int value = -1;
+  BOOST_CHECK(!queue.tryPop(value));
+  BOOST_CHECK_EQUAL(value,-1); // untouched, when queue is empty
+
+  for (int i = 0; i < 10; ++i)
+    queue.push(i);
+  BOOST_CHECK(!queue.empty());
+
+  for (int i = 0; i < 10; ++i)
+  {
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value,i);
+  }
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE( MPSCQueue_enqueue_without_notify )
+{
+  Common::MPSCQueue<int> queue;
+  queue.enqueue(1);
+  queue.push(2);
+  queue.enqueue(3);
+
+  int value = -1;
+  for (int expected = 1; expected <= 3; ++expected)
+  {
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value,expected);
+  }
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE( MPSCQueue_many_producers )
+{
+  const int producersCount = 4;
+  const int itemsPerProducer = 10000;
+
+  Common::MPSCQueue<int> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producersCount; ++p)
+  {
+    producers.push_back(std::thread([&queue,p,itemsPerProducer]
+    {
+      for (int i = 0; i < itemsPerProducer; ++i)
+        queue.push(p*itemsPerProducer + i);
+    }));
+  }
+
+  // blocking pop; items of each producer have to come in order of pushing
+  std::vector<int> lastOfProducer(producersCount,-1);
+  for (int i = 0; i < producersCount*itemsPerProducer; ++i)
+  {
+    int value = 0;
+    queue.pop(value);
+    const int producer = value/itemsPerProducer;
+    BOOST_REQUIRE(value%itemsPerProducer > lastOfProducer[producer]);
+    lastOfProducer[producer] = value%itemsPerProducer;
+  }
+
+  for (std::thread& producer : producers)
+    producer.join();
+
+  BOOST_CHECK(queue.empty());
+  for (int last : lastOfProducer)
+    BOOST_CHECK_EQUAL(last,itemsPerProducer-1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
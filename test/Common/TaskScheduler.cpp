@@ -0,0 +1,141 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Common/taskscheduler.h>
+
+BOOST_AUTO_TEST_SUITE( TaskScheduler_test )
+
+BOOST_AUTO_TEST_CASE( TaskDeque_owner_and_thieves )
+{
+  Common::TaskDeque deque(2); // grows
+  std::vector<Common::Task> tasks(100);
+  BOOST_CHECK(deque.empty());
+  BOOST_CHECK(deque.pop() == nullptr);
+  BOOST_CHECK(deque.steal() == nullptr);
+
+  for (Common::Task& task : tasks)
+    deque.push(&task);
+  BOOST_CHECK(!deque.empty());
+
+  // owner takes the latest, thief the oldest
+  BOOST_CHECK(deque.pop() == &tasks.back());
+  BOOST_CHECK(deque.steal() == &tasks.front());
+
+  // each task is taken exactly once
+  const int thievesCount = 3;
+  std::atomic<int> taken(2);
+  std::vector<std::atomic<int> > takenTimes(tasks.size());
+  for (std::atomic<int>& times : takenTimes)
+    times = 0;
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thievesCount; ++i)
+  {
+    thieves.push_back(std::thread([&]
+    {
+      while (taken.load() < int(tasks.size()))
+      {
+        Common::Task* task = deque.steal();
+        if (task)
+        {
+          ++takenTimes[task - &tasks[0]];
+          ++taken;
+        }
+      }
+    }));
+  }
+  while (taken.load() < int(tasks.size()))
+  {
+    Common::Task* task = deque.pop();
+    if (task)
+    {
+      ++takenTimes[task - &tasks[0]];
+      ++taken;
+    }
+  }
+  for (std::thread& thief : thieves)
+    thief.join();
+
+  for (std::size_t i = 1; i + 1 < tasks.size(); ++i)
+    BOOST_CHECK_EQUAL(takenTimes[i].load(),1);
+  BOOST_CHECK(deque.empty());
+}
+
+BOOST_AUTO_TEST_CASE( TaskScheduler_parallel_for )
+{
+  Common::TaskScheduler scheduler(4);
+  BOOST_CHECK_EQUAL(scheduler.getThreadsCount(),4);
+
+  std::vector<int> visited(10000,0);
+  std::atomic<std::size_t> parts(0);
+  std::atomic<bool> tooBig(false); // checks are not thread-safe
+  scheduler.parallelFor(0,visited.size(),64,
+                        [&](std::size_t begin, std::size_t end)
+  {
+    if (end - begin > 64)
+      tooBig = true;
+    for (std::size_t i = begin; i < end; ++i)
+      ++visited[i];
+    ++parts;
+  });
+
+  BOOST_CHECK(!tooBig.load());
+  for (int times : visited)
+    BOOST_REQUIRE_EQUAL(times,1);
+  BOOST_CHECK(parts.load() >= visited.size()/64);
+
+  // empty range - body is not invoked
+  scheduler.parallelFor(5,5,1,[](std::size_t,std::size_t)
+  {
+    BOOST_ERROR("Body invoked for empty range");
+  });
+}
+
+BOOST_AUTO_TEST_CASE( TaskGroup_nested_wait_and_errors )
+{
+  Common::TaskScheduler scheduler(2,true);
+
+  // tasks wait for their own groups - waiting threads run tasks
+  std::atomic<int> sum(0);
+  Common::TaskGroup group(scheduler);
+  for (int i = 0; i < 8; ++i)
+  {
+    group.run([&scheduler,&sum]
+    {
+      Common::TaskGroup nested(scheduler);
+      for (int j = 0; j < 100; ++j)
+        nested.run([&sum]{ ++sum; });
+      nested.wait();
+    });
+  }
+  group.wait();
+  BOOST_CHECK_EQUAL(sum.load(),800);
+
+  // exception of task is rethrown by wait(), other tasks run anyway
+  std::atomic<int> finished(0);
+  Common::TaskGroup failing(scheduler);
+  for (int i = 0; i < 10; ++i)
+  {
+    failing.run([i,&finished]
+    {
+      if (i == 3)
+        throw std::runtime_error("task failed");
+      ++finished;
+    });
+  }
+  BOOST_CHECK_THROW(failing.wait(),std::runtime_error);
+  BOOST_CHECK_EQUAL(finished.load(),9);
+
+  // group is reusable after wait()
+  failing.run([&finished]{ ++finished; });
+  failing.wait();
+  BOOST_CHECK_EQUAL(finished.load(),10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,136 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Model/checkpoint.h>
+#include <Model/estimationfilter.hpp>
+#include <Model/track.h>
+
+BOOST_AUTO_TEST_SUITE( Checkpoint_test )
+
+namespace Checkpoint_test
+{
+  struct Fixture
+  {
+    Fixture()
+      : path("Checkpoint_test.checkpoint"),
+        p1(boost::chrono::seconds(1)), // 1s after epoch
+        p2(boost::chrono::seconds(2)) // 2s after epoch
+    {
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+    }
+
+    ~Fixture()
+    {
+      std::remove(path.c_str());
+    }
+
+    const std::string path;
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+
+    time_types::ptime_t p1;
+    time_types::ptime_t p2;
+  };
+
+} // namespace Checkpoint_test
+
+BOOST_FIXTURE_TEST_CASE( Track_state_roundtrip, Checkpoint_test::Fixture )
+{
+  Track track(filter->clone(),20,52,100,0.1,0.1,0.1,p1);
+  track.applyMeasurement(20.001,52.001,100,boost::chrono::seconds(1));
+  track.refresh(p2);
+
+  Track restored(filter->clone(),track.getState());
+
+  BOOST_CHECK(restored.getUuid() == track.getUuid());
+  BOOST_CHECK(restored.getRefreshTime() == track.getRefreshTime());
+  BOOST_CHECK_EQUAL(restored.getLongitude(),track.getLongitude());
+  BOOST_CHECK_EQUAL(restored.getLatitude(),track.getLatitude());
+  BOOST_CHECK_EQUAL(restored.getPredictedLongitude(),
+                    track.getPredictedLongitude());
+  BOOST_CHECK_EQUAL(restored.getLongitudePredictionVariance(),
+                    track.getLongitudePredictionVariance());
+
+  // filters continue from the same state (with the same covariances)
+  track.applyMeasurement(20.002,52.002,100,boost::chrono::seconds(1));
+  restored.applyMeasurement(20.002,52.002,100,boost::chrono::seconds(1));
+  BOOST_CHECK_CLOSE(restored.getLongitude(),track.getLongitude(),1e-9);
+  BOOST_CHECK_CLOSE(restored.getLatitudeVelocity(),
+                    track.getLatitudeVelocity(),1e-9);
+  BOOST_CHECK_CLOSE(restored.getLatitudePredictionVariance(),
+                    track.getLatitudePredictionVariance(),1e-9);
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_state_not_fitting_filter,
+                         Checkpoint_test::Fixture )
+{
+  Track track(filter->clone(),20,52,100,0.1,0.1,0.1,p1);
+  Track::State state = track.getState();
+  state.filterState.pop_back();
+
+  BOOST_CHECK_THROW(Track(filter->clone(),state),std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( Checkpoint_roundtrip, Checkpoint_test::Fixture )
+{
+  Model::Checkpoint checkpoint(path);
+  Model::TrackerState state;
+  BOOST_CHECK(!checkpoint.load(state)); // no file yet
+
+  Track t1(filter->clone(),20,52,100,0.1,0.1,0.1,p1);
+  Track t2(filter->clone(),21,53,100,0.2,0.2,0.2,p2);
+  t2.setFeature(std::unique_ptr<Feature>(new PlateFeature("WX 12345")));
+  t2.setFeature(std::unique_ptr<Feature>(new ColorFeature(50,10,-20,3)));
+  state.tracks.push_back(t1.getState());
+  state.tracks.push_back(t2.getState());
+  state.cursor.sensorTime = 1234;
+  state.cursor.drId = 56;
+  state.modelTime = p2.time_since_epoch().count();
+
+  BOOST_REQUIRE(checkpoint.store(state));
+
+  Model::TrackerState loaded;
+  BOOST_REQUIRE(checkpoint.load(loaded));
+  BOOST_REQUIRE_EQUAL(loaded.tracks.size(),2);
+  BOOST_CHECK_EQUAL(loaded.cursor.sensorTime,1234);
+  BOOST_CHECK_EQUAL(loaded.cursor.drId,56);
+  BOOST_CHECK_EQUAL(loaded.modelTime,state.modelTime);
+
+  Track restored(filter->clone(),loaded.tracks[1]);
+  BOOST_CHECK(restored.getUuid() == t2.getUuid());
+  BOOST_CHECK(restored.getRefreshTime() == p2);
+  BOOST_CHECK_EQUAL(restored.getLongitude(),21);
+  BOOST_CHECK_EQUAL(restored.getLatitude(),53);
+
+  // features survive restart
+  const Feature* plate = restored.getFeature(Feature::Plate);
+  BOOST_REQUIRE(plate);
+  BOOST_CHECK_EQUAL(static_cast<const PlateFeature*>(plate)->getPlate(),
+                    "WX 12345");
+  const Feature* color = restored.getFeature(Feature::Color);
+  BOOST_REQUIRE(color);
+  BOOST_CHECK_EQUAL(static_cast<const ColorFeature*>(color)->getB(),-20);
+  BOOST_CHECK_EQUAL(static_cast<const ColorFeature*>(color)->getWeight(),3);
+  BOOST_CHECK(Track(filter->clone(),loaded.tracks[0])
+                .getFeature(Feature::Plate) == nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE( Checkpoint_corrupted, Checkpoint_test::Fixture )
+{
+  {
+    std::ofstream file(path.c_str(),std::ios::binary);
+    file << "definitely not a checkpoint";
+  }
+
+  Model::TrackerState state;
+  BOOST_CHECK(!Model::Checkpoint(path).load(state));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -290,4 +290,102 @@ BOOST_AUTO_TEST_CASE( DataAssociator_track_refresh_on_association_test )
                     time_types::ptime_t(boost::chrono::seconds(105)));
 }
 
+BOOST_AUTO_TEST_CASE( DataAssociator_plate_test )
+{
+  std::unique_ptr<estimation::EstimationFilter<> > filter;
+  { // FIXME: really UGLY solution! Only for testing purpose,
+    //  to allow fast tests
+    #include "common/FiltersSetups.h"
+    filter = std::move(kalmanFilter);
+  }
+
+  // two Tracks in the same distance from DR - only plates differ
+  std::shared_ptr<TrackManager> tm(new TrackManager(5000));
+  std::shared_ptr<Track> first(new Track(filter->clone(),20.001,52,0,0,0,0));
+  first->setFeature(std::unique_ptr<Feature>(new PlateFeature("KR 777")));
+  std::shared_ptr<Track> second(new Track(filter->clone(),19.999,52,0,0,0,0));
+  second->setFeature(std::unique_ptr<Feature>(new PlateFeature("WA 12345")));
+  tm->addTrack(first);
+  tm->addTrack(second);
+
+  FeatureTable table;
+  std::vector<std::unique_ptr<Feature> > features;
+  features.emplace_back(new PlateFeature("WA-I2E45")); // OCR noise
+  std::set<DetectionReport> group = {
+    DetectionReport(1,1,20,52,0,100,100,nullptr,
+                    table.addRow(std::move(features)))
+  };
+  std::vector<std::set<DetectionReport> > groups(1,group);
+
+  ResultComparator::feature_grade_map_t gradeRates;
+  gradeRates["Plate"] = 1;
+  DataAssociator da(tm,
+                    std::unique_ptr<ResultComparator>(
+                      new OrComparator(gradeRates)),
+                    std::unique_ptr<ListResultComparator>(
+                      new OrListComparator()),
+                    0.3);
+  da.setFeatureExtractor(
+        std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
+  da.setInput(groups);
+
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > associated
+      = da.getDRsForTracks();
+  BOOST_CHECK(associated[first].empty()); // position alone is too weak
+  BOOST_CHECK_EQUAL(associated[second].size(),1);
+  BOOST_CHECK(da.getNotAssociated()[0].empty());
+}
+
+BOOST_AUTO_TEST_CASE( DataAssociator_plate_skips_other_tracks )
+{
+  std::unique_ptr<estimation::EstimationFilter<> > filter;
+  { // FIXME: really UGLY solution! Only for testing purpose,
+    //  to allow fast tests
+    #include "common/FiltersSetups.h"
+    filter = std::move(kalmanFilter);
+  }
+
+  // Track with other plate lies exactly on DR - position alone
+  //  would be enough, but group with plate is not rated for it
+  std::shared_ptr<TrackManager> tm(new TrackManager(5000));
+  std::shared_ptr<Track> other(new Track(filter->clone(),20,52,0,0,0,0));
+  other->setFeature(std::unique_ptr<Feature>(new PlateFeature("KR 777")));
+  tm->addTrack(other);
+
+  FeatureTable table;
+  std::vector<std::unique_ptr<Feature> > features;
+  features.emplace_back(new PlateFeature("WA 12345"));
+  std::set<DetectionReport> group = {
+    DetectionReport(1,1,20,52,0,100,100,nullptr,
+                    table.addRow(std::move(features)))
+  };
+  std::vector<std::set<DetectionReport> > groups(1,group);
+
+  ResultComparator::feature_grade_map_t gradeRates;
+  gradeRates["Plate"] = 1;
+  DataAssociator da(tm,
+                    std::unique_ptr<ResultComparator>(
+                      new OrComparator(gradeRates)),
+                    std::unique_ptr<ListResultComparator>(
+                      new OrListComparator()),
+                    0.3);
+  da.setFeatureExtractor(
+        std::unique_ptr<FeatureExtractor>(new FeatureExtractor()));
+  std::vector<std::set<DetectionReport> > input = groups;
+  da.setInput(input);
+
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > associated
+      = da.getDRsForTracks();
+  BOOST_CHECK(associated[other].empty());
+  BOOST_CHECK_EQUAL(da.getNotAssociated()[0].size(),1);
+
+  // Track without plate is rated for all groups
+  std::shared_ptr<Track> noPlate(new Track(filter->clone(),20,52,0,0,0,0));
+  tm->addTrack(noPlate);
+  da.setInput(groups);
+  associated = da.getDRsForTracks();
+  BOOST_CHECK(associated[other].empty());
+  BOOST_CHECK_EQUAL(associated[noPlate].size(),1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,240 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+
+#include <Common/configurationmanager.h>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/Distributed/protocol.h>
+#include <Model/Distributed/remoteshard.h>
+#include <Model/Distributed/shardserver.h>
+
+BOOST_AUTO_TEST_SUITE( Distributed_test )
+
+namespace Distributed_test
+{
+  struct Fixture
+  {
+    Fixture()
+    {
+      try
+      {
+        Common::Configuration::ConfigurationManager::KeyValueMap options
+              = Common::Configuration::getConfigurationFromFile("settings.ini");
+        Common::Configuration::ConfigurationManager& confMan
+            = Common::Configuration::ConfigurationManager::getInstance();
+        confMan.parseKeyValueMapIntoConfiguration(options);
+      }
+      catch (const std::exception&)
+      {
+        ; // workaround for multiple loading configuration,
+          // because of lack of pre-initialization block
+      }
+
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+
+      factory.trackManager = []
+      {
+        return std::make_shared<TrackManager>(5000);
+      };
+      factory.dataAssociator = [](std::shared_ptr<TrackManager> tm)
+      {
+        return std::unique_ptr<DataAssociator>(
+              new DataAssociator(tm,
+                                 std::unique_ptr<ResultComparator>(
+                                   new OrComparator(
+                                     ResultComparator::feature_grade_map_t())),
+                                 std::unique_ptr<ListResultComparator>(
+                                   new OrListComparator()),
+                                 0.3));
+      };
+      factory.fusionExecutor = []
+      {
+        return std::unique_ptr<FusionExecutor>(new FusionExecutor());
+      };
+
+      // two tiles, border at lon = 20.01
+      area.minLon = 20.0;
+      area.minLat = 52.0;
+      area.maxLon = 20.02;
+      area.maxLat = 52.01;
+    }
+
+    std::vector<std::set<DetectionReport> > group(int drId, double lon,
+                                                  time_t time)
+    {
+      std::set<DetectionReport> DRs = {
+        DetectionReport(1,drId,lon,52.005,0,time,time)
+      };
+      return std::vector<std::set<DetectionReport> >(1,DRs);
+    }
+
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+    Model::ShardedTracker::ShardFactory factory;
+    Model::Bounds area;
+  };
+
+  /**
+   * @brief Servers serving one session each, in their own threads
+   *  (joined also when test fails).
+   */
+  struct ShardServers
+  {
+    ~ShardServers()
+    {
+      for (std::thread& thread : threads)
+      {
+        thread.join();
+      }
+    }
+
+    std::vector<std::unique_ptr<Model::Distributed::ShardServer> > servers;
+    std::vector<std::thread> threads;
+  };
+
+} // namespace Distributed_test
+
+BOOST_FIXTURE_TEST_CASE( Encoding_roundtrip, Distributed_test::Fixture )
+{
+  Track track(filter->clone(),20.005,52.005,0,0.001,0.001,0);
+  track.setFeature(std::unique_ptr<Feature>(new PlateFeature("WX 12345")));
+  const Track::State state = track.getState();
+
+  FeatureTable features;
+  std::vector<std::unique_ptr<Feature> > row;
+  row.emplace_back(new ColorFeature(50,10,-20,3));
+  row.emplace_back(new PlateFeature("WE 4242"));
+  std::vector<std::set<DetectionReport> > groups = group(7,20.005,10);
+  groups[0].insert(DetectionReport(2,8,20.005,52.005,0,10,10,nullptr,
+                                   features.addRow(std::move(row))));
+  groups.push_back(std::set<DetectionReport>());
+
+  Model::Distributed::Encoder encoder;
+  encoder.putBounds(area);
+  encoder.putGroups(groups);
+  encoder.putTrackStates(std::vector<Track::State>(2,state));
+
+  FeatureTable decodedFeatures;
+  Model::Distributed::Decoder decoder(encoder.getBuffer(),&decodedFeatures);
+  const Model::Bounds bounds = decoder.getBounds();
+  BOOST_CHECK_EQUAL(bounds.minLon,area.minLon);
+  BOOST_CHECK_EQUAL(bounds.maxLat,area.maxLat);
+
+  const std::vector<std::set<DetectionReport> > decodedGroups
+      = decoder.getGroups();
+  BOOST_REQUIRE_EQUAL(decodedGroups.size(),2);
+  BOOST_REQUIRE_EQUAL(decodedGroups[0].size(),2);
+  BOOST_CHECK(decodedGroups[1].empty());
+  const DetectionReport& dr = *decodedGroups[0].begin();
+  BOOST_CHECK_EQUAL(dr.getDrId(),7);
+  BOOST_CHECK_EQUAL(dr.getLongitude(),20.005);
+  BOOST_CHECK(dr.getSensorTime() == groups[0].begin()->getSensorTime());
+  BOOST_CHECK(dr.getFeature(Feature::Color) == nullptr);
+
+  // features of DR are decoded into given table
+  const DetectionReport& withFeatures = *decodedGroups[0].rbegin();
+  BOOST_REQUIRE_EQUAL(withFeatures.getDrId(),8);
+  const ColorFeature* color = static_cast<const ColorFeature*>(
+        withFeatures.getFeature(Feature::Color));
+  const PlateFeature* plate = static_cast<const PlateFeature*>(
+        withFeatures.getFeature(Feature::Plate));
+  BOOST_REQUIRE(color);
+  BOOST_REQUIRE(plate);
+  BOOST_CHECK_EQUAL(color->getB(),-20);
+  BOOST_CHECK_EQUAL(color->getWeight(),3);
+  BOOST_CHECK_EQUAL(plate->getPlate(),"WE 4242");
+  BOOST_CHECK_EQUAL(decodedFeatures.getRowsCount(),1);
+
+  const std::vector<Track::State> states = decoder.getTrackStates();
+  BOOST_REQUIRE_EQUAL(states.size(),2);
+  Track decoded(filter->clone(),states[1]);
+  BOOST_CHECK(decoded.getUuid() == track.getUuid());
+  BOOST_CHECK_EQUAL(decoded.getLongitude(),20.005);
+  BOOST_CHECK(decoded.getRefreshTime() == track.getRefreshTime());
+  const Feature* trackPlate = decoded.getFeature(Feature::Plate);
+  BOOST_REQUIRE(trackPlate);
+  BOOST_CHECK_EQUAL(static_cast<const PlateFeature*>(trackPlate)->getPlate(),
+                    "WX 12345");
+  BOOST_CHECK(decoder.atEnd());
+
+  // truncated message
+  std::vector<char> truncated(encoder.getBuffer().begin(),
+                              encoder.getBuffer().end() - 1);
+  Model::Distributed::Decoder truncatedDecoder(truncated);
+  truncatedDecoder.getBounds();
+  truncatedDecoder.getGroups();
+  BOOST_CHECK_THROW(truncatedDecoder.getTrackStates(),
+                    Model::Distributed::ProtocolError);
+}
+
+BOOST_FIXTURE_TEST_CASE( Tracking_on_localhost, Distributed_test::Fixture )
+{
+  Distributed_test::ShardServers shardServers;
+  std::vector<std::unique_ptr<Model::Distributed::ShardServer> >& servers
+      = shardServers.servers;
+  for (int i = 0; i < 2; ++i)
+  {
+    servers.emplace_back(
+          new Model::Distributed::ShardServer(0,factory,filter->clone()));
+    shardServers.threads.emplace_back(
+          &Model::Distributed::ShardServer::serve,servers.back().get());
+  }
+
+  {
+    const estimation::EstimationFilter<>& prototype = *filter;
+    Model::ShardedTracker tracker(
+          area,2,1,0.001,
+          [&servers,&prototype](const Model::Bounds& tile, std::size_t index)
+          {
+            return std::unique_ptr<Model::Shard>(
+                  new Model::Distributed::RemoteShard(
+                    tile,"127.0.0.1",servers[index]->getPort(),
+                    prototype.clone()));
+          });
+
+    // routing by position
+    tracker.process(group(1,20.005,10),*filter);
+    tracker.process(group(2,20.015,10),*filter);
+    BOOST_CHECK_EQUAL(tracker.getShard(0).getTracks().size(),1);
+    BOOST_CHECK_EQUAL(tracker.getShard(1).getTracks().size(),1);
+
+    // second chance - DR crossed the border, Track is still in the other tile
+    std::map<std::shared_ptr<Track>,std::set<DetectionReport> > updated
+        = tracker.process(group(3,20.0098,11),*filter);
+    BOOST_CHECK_EQUAL(tracker.getTracks().size(),3);
+    updated = tracker.process(group(4,20.0102,12),*filter);
+    BOOST_CHECK_EQUAL(updated.size(),1);
+    BOOST_CHECK_EQUAL(tracker.getTracks().size(),3); // no duplicated Track
+
+    // handoff - Track (restored in remote shard) is outside of it's tile
+    tracker.restoreTracks(std::set<std::shared_ptr<Track> >());
+    BOOST_CHECK(tracker.getTracks().empty());
+    std::shared_ptr<Track> track(
+          new Track(filter->clone(),20.015,52.005,0,0,0,0));
+    track->setFeature(std::unique_ptr<Feature>(new PlateFeature("WX 12345")));
+    tracker.getShard(0).restoreTracks(
+          std::set<std::shared_ptr<Track> >({ track }));
+    BOOST_REQUIRE_EQUAL(tracker.getShard(0).getTracks().size(),1);
+
+    tracker.process(std::vector<std::set<DetectionReport> >(),*filter);
+    BOOST_CHECK_EQUAL(tracker.getShard(0).getTracks().size(),0);
+    BOOST_REQUIRE_EQUAL(tracker.getShard(1).getTracks().size(),1);
+    BOOST_CHECK((*tracker.getTracks().begin())->getUuid() == track->getUuid());
+    // features are handed off with Track
+    BOOST_CHECK((*tracker.getTracks().begin())->getFeature(Feature::Plate));
+
+    BOOST_CHECK_EQUAL(tracker.removeExpiredTracks(
+                        track->getRefreshTime()
+                        + time_types::seconds_t(100),
+                        time_types::seconds_t(3)),1);
+    BOOST_CHECK(tracker.getTracks().empty());
+  } // RemoteShards finish sessions
+}
+
+BOOST_AUTO_TEST_SUITE_END()
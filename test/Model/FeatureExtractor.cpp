@@ -0,0 +1,132 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Model/detectionreport.h>
+#include <Model/estimationfilter.hpp>
+#include <Model/featureextractor.h>
+#include <Model/featuretable.h>
+#include <Model/track.h>
+
+BOOST_AUTO_TEST_SUITE( FeatureExtractor_test )
+
+namespace FeatureExtractor_test
+{
+  double alwaysHalf(const Feature&, const Feature&)
+  {
+    return 0.5;
+  }
+} // namespace FeatureExtractor_test
+
+BOOST_AUTO_TEST_CASE( Dispatch_by_types )
+{
+  FeatureExtractor extractor;
+  const PlateFeature plate("WA 12345");
+  const PlateFeature samePlate("WA 12345");
+  const PlateFeature otherPlate("KR 1");
+  const ColorFeature white = ColorFeature::fromRGB(255,255,255);
+  const ColorFeature black = ColorFeature::fromRGB(0,0,0);
+
+  BOOST_CHECK_EQUAL(extractor.compare(plate,samePlate),1);
+  BOOST_CHECK_EQUAL(extractor.compare(plate,otherPlate),0);
+  BOOST_CHECK_CLOSE(extractor.compare(white,white),1,1e-9);
+  BOOST_CHECK_SMALL(extractor.compare(white,black),1e-9);
+  BOOST_CHECK_EQUAL(extractor.compare(plate,white),0); // no comparator
+
+  std::unique_ptr<Feature> gray(extractor.fuse(white,black));
+  BOOST_REQUIRE(gray != nullptr);
+  BOOST_CHECK_CLOSE(static_cast<ColorFeature&>(*gray).getL(),50,1e-3);
+  BOOST_CHECK_EQUAL(static_cast<ColorFeature&>(*gray).getWeight(),2);
+  // running mean - the next observation has weight of one of three
+  std::unique_ptr<Feature> darker(extractor.fuse(*gray,black));
+  BOOST_CHECK_CLOSE(static_cast<ColorFeature&>(*darker).getL(),100/3.0,1e-3);
+  BOOST_CHECK(extractor.fuse(plate,otherPlate) == nullptr);
+
+  // batch of DR features against one of Track
+  const Feature* features[] = { &samePlate, nullptr, &otherPlate, &white };
+  double grades[4];
+  extractor.compare(plate,features,4,grades);
+  BOOST_CHECK_EQUAL(grades[0],1);
+  BOOST_CHECK_EQUAL(grades[1],0);
+  BOOST_CHECK_EQUAL(grades[2],0);
+  BOOST_CHECK_EQUAL(grades[3],0);
+
+  // new comparator, without changing features
+  extractor.setComparator(Feature::Plate,Feature::Color,
+                          &FeatureExtractor_test::alwaysHalf);
+  BOOST_CHECK_EQUAL(extractor.compare(plate,white),0.5);
+  BOOST_CHECK_EQUAL(extractor.compare(white,plate),0);
+}
+
+BOOST_AUTO_TEST_CASE( Batch_of_colors )
+{
+  FeatureExtractor extractor;
+  const ColorFeature red = ColorFeature::fromRGB(200,30,30);
+
+  std::vector<ColorFeature> colors;
+  for (int i = 0; i < 5; ++i) // odd number - scalar tail is used too
+    colors.push_back(ColorFeature::fromRGB(200 - 40*i,30 + 10*i,30));
+
+  std::vector<const Feature*> features;
+  for (const ColorFeature& color : colors)
+    features.push_back(&color);
+  features.insert(features.begin() + 2,nullptr);
+
+  std::vector<double> grades(features.size());
+  extractor.compare(red,features.data(),features.size(),grades.data());
+
+  BOOST_CHECK_CLOSE(grades[0],1,1e-9);
+  BOOST_CHECK_EQUAL(grades[2],0);
+  for (std::size_t i = 0; i < features.size(); ++i)
+  {
+    if (!features[i])
+      continue;
+    const ColorFeature& color = static_cast<const ColorFeature&>(*features[i]);
+    const double deltaE = std::sqrt(std::pow(color.getL() - red.getL(),2)
+                                    + std::pow(color.getA() - red.getA(),2)
+                                    + std::pow(color.getB() - red.getB(),2));
+    BOOST_CHECK_CLOSE(grades[i],std::max(0.0,1 - deltaE/100),1e-6);
+    BOOST_CHECK_CLOSE(grades[i],extractor.compare(red,color),1e-6);
+  }
+  BOOST_CHECK(grades[1] > grades[3]); // more different - lower grade
+}
+
+BOOST_AUTO_TEST_CASE( Track_features_by_type )
+{
+  #include "common/FiltersSetups.h"
+  Track track(std::move(kalmanFilter),20,52,0,0,0,0);
+  BOOST_CHECK(track.getFeature(Feature::Plate) == nullptr);
+
+  track.setFeature(std::unique_ptr<Feature>(new PlateFeature("WA 1")));
+  track.setFeature(std::unique_ptr<Feature>(new PlateFeature("WA 2")));
+  BOOST_REQUIRE(track.getFeature(Feature::Plate) != nullptr);
+  BOOST_CHECK_EQUAL(static_cast<const PlateFeature*>(
+                      track.getFeature(Feature::Plate))->getPlate(),"WA 2");
+  BOOST_CHECK(track.getFeature(Feature::Color) == nullptr);
+
+  // colors of DRs are fused into Track's
+  FeatureTable table;
+  std::vector<std::unique_ptr<Feature> > features;
+  features.emplace_back(ColorFeature::fromRGB(255,255,255).clone());
+  DetectionReport white(1,1,20,52,0,100,100,nullptr,
+                        table.addRow(std::move(features)));
+  features.clear();
+  features.emplace_back(ColorFeature::fromRGB(0,0,0).clone());
+  DetectionReport black(1,2,20,52,0,100,100,nullptr,
+                        table.addRow(std::move(features)));
+
+  FeatureExtractor extractor;
+  track.updateFeatures(white,&extractor);
+  track.updateFeatures(black,&extractor);
+  const ColorFeature* color = static_cast<const ColorFeature*>(
+        track.getFeature(Feature::Color));
+  BOOST_REQUIRE(color != nullptr);
+  BOOST_CHECK_CLOSE(color->getL(),50,1e-3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
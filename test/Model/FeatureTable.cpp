@@ -0,0 +1,75 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+#include <Model/detectionreport.h>
+#include <Model/featuretable.h>
+
+BOOST_AUTO_TEST_SUITE( FeatureTable_test )
+
+BOOST_AUTO_TEST_CASE( Features_lookup )
+{
+  FeatureTable table;
+
+  std::vector<std::unique_ptr<Feature> > features;
+  features.emplace_back(new PlateFeature());
+  const FeatureTable::row_t* row = table.addRow(std::move(features));
+  BOOST_CHECK_EQUAL(table.getRowsCount(),1);
+
+  DetectionReport dr(1,1,20,52,0,100,100,nullptr,row);
+  DetectionReport withoutFeatures(1,2,20,52,0,100,100);
+
+  BOOST_REQUIRE(dr.getFeature(Feature::Plate) != nullptr);
+  BOOST_CHECK_EQUAL(dr.getFeature(Feature::Plate)->getName(),"Plate");
+  BOOST_CHECK(dr.getFeature(Feature::Color) == nullptr);
+  BOOST_CHECK(dr.getFeatureOfGivenName("Plate")
+              == dr.getFeature(Feature::Plate));
+  BOOST_CHECK(dr.getFeatureOfGivenName("Unknown") == nullptr);
+  BOOST_CHECK(withoutFeatures.getFeature(Feature::Plate) == nullptr);
+
+  // copies share the same row
+  std::set<DetectionReport> DRs = { dr, withoutFeatures };
+  BOOST_CHECK(DRs.begin()->getFeature(Feature::Plate)
+              == dr.getFeature(Feature::Plate));
+
+  table.clear();
+  BOOST_CHECK_EQUAL(table.getRowsCount(),0);
+}
+
+BOOST_AUTO_TEST_CASE( Decoding_into_pool )
+{
+  FeatureTable table;
+
+  const Feature* plate = table.decode(Feature::Plate,"WA 12345");
+  BOOST_REQUIRE(plate != nullptr);
+  BOOST_CHECK_EQUAL(static_cast<const PlateFeature*>(plate)->getPlate(),
+                    "WA 12345");
+
+  const Feature* color = table.decode(Feature::typeOfName("color"),"#FFffFF");
+  BOOST_REQUIRE(color != nullptr);
+  const ColorFeature* white = static_cast<const ColorFeature*>(color);
+  BOOST_CHECK_CLOSE(white->getL(),100,1e-3); // converted into CIELAB
+  BOOST_CHECK_SMALL(white->getA(),1e-3);
+  BOOST_CHECK_SMALL(white->getB(),1e-3);
+
+  BOOST_CHECK(table.decode(Feature::Color,"red") == nullptr);
+  BOOST_CHECK(table.decode(Feature::Plate,"") == nullptr);
+  BOOST_CHECK(table.decode(Feature::TypesCount,"x") == nullptr);
+
+  FeatureTable::row_t row = FeatureTable::emptyRow();
+  row[Feature::Plate] = plate;
+  row[Feature::Color] = color;
+  DetectionReport dr(1,1,20,52,0,100,100,nullptr,table.addRow(row));
+  BOOST_CHECK(dr.getFeature(Feature::Color) == color);
+
+  // pooled features are reused in next cycle
+  table.clear();
+  const Feature* nextPlate = table.decode(Feature::Plate,"KR 1");
+  BOOST_CHECK(nextPlate == plate);
+  BOOST_CHECK_EQUAL(static_cast<const PlateFeature*>(nextPlate)->getPlate(),
+                    "KR 1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Model/detectionreport.h>
+#include <Model/estimationfilter.hpp>
+#include <Model/fusionexecutor.h>
+#include <Model/parallelfusionexecutor.h>
+#include <Model/sensornoisetable.h>
+#include <Model/track.h>
+
+BOOST_AUTO_TEST_SUITE( FusionExecutor_test )
+
+typedef std::map<std::shared_ptr<Track>,std::set<DetectionReport> >
+  collection_t;
+
+namespace FusionExecutor_test
+{
+  struct Fixture
+  {
+    Fixture()
+      : p1(boost::chrono::seconds(1)),
+        noises(std::make_shared<SensorNoiseTable>())
+    {
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+      noises->set(1,1,1);
+      noises->set(2,3,3);
+    }
+
+    std::shared_ptr<Track> makeTrack() const
+    {
+      return std::make_shared<Track>(filter->clone(),0,0,0,0,0,0,p1);
+    }
+
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+    time_types::ptime_t p1;
+    std::shared_ptr<SensorNoiseTable> noises;
+  };
+
+} // namespace FusionExecutor_test
+
+BOOST_FIXTURE_TEST_CASE( Fusion_of_each_DR, FusionExecutor_test::Fixture )
+{
+  FusionExecutor executor;
+  executor.setSensorNoiseTable(noises);
+
+  const DetectionReport first(1,1,0,0,0,2,2);
+  const DetectionReport second(2,2,4,0,0,2,2);
+  collection_t collection;
+  std::shared_ptr<Track> track = makeTrack();
+  collection[track] = { first, second };
+  executor.fuseDRs(collection);
+
+  std::shared_ptr<Track> expected = makeTrack();
+  expected->applyMeasurement(first,noises->find(1));
+  expected->applyMeasurement(second,noises->find(2));
+  BOOST_CHECK_CLOSE(track->getLongitude(),expected->getLongitude(),1e-9);
+  BOOST_CHECK_CLOSE(track->getLongitudePredictionVariance(),
+                    expected->getLongitudePredictionVariance(),1e-9);
+}
+
+BOOST_FIXTURE_TEST_CASE( Fusion_of_combined_DRs, FusionExecutor_test::Fixture )
+{
+  FusionExecutor executor(true);
+  executor.setSensorNoiseTable(noises);
+
+  // the same time - both DRs are from one aligned group
+  collection_t collection;
+  std::shared_ptr<Track> track = makeTrack();
+  collection[track] = { DetectionReport(1,1,0,0,0,2,2),
+                        DetectionReport(2,2,4,0,0,2,2) };
+  executor.fuseDRs(collection);
+
+  // one measurement: (0/1 + 4/3)/(1/1 + 1/3) = 1, variance 1/(1/1 + 1/3)
+  std::shared_ptr<Track> expected = makeTrack();
+  const SensorNoise combined = { 0.75,0.75,-1 };
+  expected->applyMeasurement(DetectionReport(1,1,1,0,0,2,2),&combined);
+  BOOST_CHECK_CLOSE(track->getLongitude(),expected->getLongitude(),1e-9);
+  BOOST_CHECK_CLOSE(track->getLongitudePredictionVariance(),
+                    expected->getLongitudePredictionVariance(),1e-9);
+  BOOST_CHECK(track->getMeasurementTime() == expected->getMeasurementTime());
+
+  // sensor of unknown noise - plain mean with noise of filter
+  collection.clear();
+  track = makeTrack();
+  collection[track] = { DetectionReport(1,1,0,0,0,2,2),
+                        DetectionReport(9,2,4,0,0,2,2) };
+  executor.fuseDRs(collection);
+
+  expected = makeTrack();
+  expected->applyMeasurement(DetectionReport(1,1,2,0,0,2,2));
+  BOOST_CHECK_CLOSE(track->getLongitude(),expected->getLongitude(),1e-9);
+}
+
+BOOST_FIXTURE_TEST_CASE( Parallel_fusion, FusionExecutor_test::Fixture )
+{
+  FusionExecutor serial(true);
+  ParallelFusionExecutor parallel(std::make_shared<Common::TaskScheduler>(4),
+                                  8,true);
+  BOOST_CHECK_EQUAL(parallel.getThreadsCount(),4);
+  serial.setSensorNoiseTable(noises);
+  parallel.setSensorNoiseTable(noises);
+
+  collection_t serialCollection;
+  collection_t parallelCollection;
+  for (int i = 0; i < 200; ++i)
+  {
+    const std::set<DetectionReport> DRs = {
+      DetectionReport(1,2*i,i,-i,0,2,2),
+      DetectionReport(2,2*i + 1,i + 1,-i,1,2,2)
+    };
+    serialCollection[makeTrack()] = DRs;
+    parallelCollection[makeTrack()] = DRs;
+  }
+
+  // the same executor is reused by following cycles
+  for (int cycle = 0; cycle < 3; ++cycle)
+  {
+    serial.fuseDRs(serialCollection);
+    parallel.fuseDRs(parallelCollection);
+  }
+
+  std::map<double,double> expected; // latitude -> longitude
+  for (const auto& item : serialCollection)
+    expected[item.first->getLatitude()] = item.first->getLongitude();
+  for (const auto& item : parallelCollection)
+  {
+    BOOST_REQUIRE(expected.count(item.first->getLatitude()) == 1);
+    BOOST_CHECK_EQUAL(item.first->getLongitude(),
+                      expected[item.first->getLatitude()]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <Model/detectionreport.h>
+#include <Model/fixedmatrix.hpp>
+#include <Model/immfilter.hpp>
+#include <Model/track.h>
+
+BOOST_AUTO_TEST_SUITE( IMMFilter_test )
+
+typedef estimation::IMMFilter<> filter_t;
+
+namespace IMMFilter_test
+{
+  struct Fixture
+  {
+    Fixture()
+    {
+      parameters.measurementNoise = 0.01;
+      parameters.velocityNoise = 0.01;
+      parameters.accelerationNoise = 0.01;
+      parameters.turnNoise = 0.01;
+    }
+
+    // starts at (0,0), moving along longitude with velocity 1
+    std::unique_ptr<filter_t> makeFilter() const
+    {
+      std::unique_ptr<filter_t> filter(new filter_t(parameters));
+      filter_t::vector_t state = {{ 0, 0, 0, 1, 0, 0 }};
+      filter_t::vector_t variance;
+      variance.fill(0.01);
+      filter->initialize(state,variance);
+      return filter;
+    }
+
+    filter_t::Parameters parameters;
+  };
+
+  std::size_t mostProbableModel(const filter_t& filter)
+  {
+    const std::array<double,filter_t::ModelsCount>& probabilities
+        = filter.getModelProbabilities();
+    return std::max_element(probabilities.begin(),probabilities.end())
+           - probabilities.begin();
+  }
+
+} // namespace IMMFilter_test
+
+BOOST_AUTO_TEST_CASE( Fixed_matrix_operations )
+{
+  typedef estimation::FixedMatrix<2,2> matrix_t;
+  matrix_t m;
+  m(0,0) = 4;
+  m(0,1) = 7;
+  m(1,0) = 2;
+  m(1,1) = 6;
+
+  matrix_t inverse;
+  double determinant = 0;
+  BOOST_REQUIRE(estimation::invert(m,inverse,&determinant));
+  BOOST_CHECK_CLOSE(determinant,10,1e-9);
+
+  const matrix_t identity = m*inverse;
+  for (std::size_t i = 0; i < 2; ++i)
+    for (std::size_t j = 0; j < 2; ++j)
+      BOOST_CHECK_SMALL(identity(i,j) - (i == j ? 1 : 0),1e-12);
+
+  estimation::FixedVector<2> v;
+  v[0] = 1;
+  v[1] = 2;
+  const estimation::FixedVector<2> mv = m*v;
+  BOOST_CHECK_EQUAL(mv[0],18);
+  BOOST_CHECK_EQUAL(mv[1],14);
+  BOOST_CHECK_EQUAL(estimation::sandwich(matrix_t::identity(),m)(0,1),7);
+
+  matrix_t singular;
+  singular(0,0) = 1;
+  singular(0,1) = 2;
+  singular(1,0) = 2;
+  singular(1,1) = 4;
+  BOOST_CHECK(!estimation::invert(singular,inverse));
+}
+
+BOOST_FIXTURE_TEST_CASE( Straight_motion, IMMFilter_test::Fixture )
+{
+  std::unique_ptr<filter_t> filter = makeFilter();
+
+  std::pair<filter_t::vector_t,filter_t::vector_t> prediction;
+  for (int t = 1; t <= 20; ++t)
+  {
+    filter_t::vector_t z = {{ double(t), 0, 0, 0, 0, 0 }};
+    filter->correct(z);
+    prediction = filter->predict();
+  }
+
+  BOOST_CHECK_SMALL(prediction.first[0] - 21,0.05);
+  BOOST_CHECK_SMALL(prediction.first[1],0.05);
+  BOOST_CHECK_SMALL(prediction.first[2],0.05);
+  BOOST_CHECK_SMALL(prediction.first[3] - 1,0.05);
+  BOOST_CHECK_EQUAL(IMMFilter_test::mostProbableModel(*filter),
+                    filter_t::ConstantVelocity);
+}
+
+BOOST_FIXTURE_TEST_CASE( Turn_is_recognized, IMMFilter_test::Fixture )
+{
+  std::unique_ptr<filter_t> filter = makeFilter();
+
+  // left turn with turn rate of the model
+  const double omega = parameters.turnRate;
+  std::pair<filter_t::vector_t,filter_t::vector_t> prediction;
+  for (int t = 1; t <= 10; ++t)
+  {
+    filter_t::vector_t z = {{ std::sin(omega*t)/omega,
+                              (1 - std::cos(omega*t))/omega, 0, 0, 0, 0 }};
+    filter->correct(z);
+    prediction = filter->predict();
+  }
+
+  BOOST_CHECK_EQUAL(IMMFilter_test::mostProbableModel(*filter),
+                    filter_t::TurnLeft);
+  BOOST_CHECK_SMALL(prediction.first[0] - std::sin(omega*11)/omega,0.1);
+  BOOST_CHECK_SMALL(prediction.first[1] - (1 - std::cos(omega*11))/omega,0.1);
+}
+
+BOOST_FIXTURE_TEST_CASE( State_export_and_clone, IMMFilter_test::Fixture )
+{
+  std::unique_ptr<filter_t> filter = makeFilter();
+  filter_t::vector_t z = {{ 1.1, 0.1, 0, 0, 0, 0 }};
+  filter->correct(z);
+  filter->predict();
+
+  filter_t imported(parameters);
+  BOOST_REQUIRE(imported.importState(filter->exportState()));
+  BOOST_CHECK(!imported.importState(std::vector<double>(3,0)));
+
+  std::unique_ptr<estimation::EstimationFilter<> > cloned = filter->clone();
+
+  z[0] = 2.2;
+  const filter_t::vector_t expected = filter->correct(z).first;
+  const filter_t::vector_t fromImported = imported.correct(z).first;
+  const filter_t::vector_t fromClone = cloned->correct(z).first;
+  for (std::size_t i = 0; i < expected.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(fromImported[i],expected[i]);
+    BOOST_CHECK_EQUAL(fromClone[i],expected[i]);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_with_IMM, IMMFilter_test::Fixture )
+{
+  std::unique_ptr<estimation::EstimationFilter<> > filter(
+        new filter_t(parameters));
+  Track track(std::move(filter),0,0,0,0.01,0.01,0,
+              time_types::ptime_t(boost::chrono::seconds(1)));
+
+  for (int t = 2; t <= 10; ++t)
+    track.applyMeasurement(DetectionReport(1,t,t - 1,0,0,t,t));
+
+  BOOST_CHECK_SMALL(track.getLongitude() - 9,0.1);
+  BOOST_CHECK(track.getPredictedLongitude() > track.getLongitude());
+
+  // the whole IMM state survives Track's state
+  Track restored(filter_t(parameters).clone(),track.getState());
+  BOOST_CHECK_EQUAL(restored.getPredictedLongitude(),
+                    track.getPredictedLongitude());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
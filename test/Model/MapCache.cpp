@@ -0,0 +1,122 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdio>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Model/mapcache.h>
+
+BOOST_AUTO_TEST_SUITE( MapCache_test )
+
+namespace MapCache_test
+{
+  struct Fixture
+  {
+    Fixture()
+      : path("MapCache_test.cache")
+    {
+      // triangle 1-2-3 with additional street 3-4
+      for (int i = 1; i <= 4; ++i)
+        vertexes.push_back(std::make_shared<Model::StreetNode>(i,
+                                                               20.0+0.01*i,
+                                                               52.0-0.01*i,
+                                                               100+i));
+      edges.push_back(std::make_shared<Model::Street>(vertexes[0],vertexes[1]));
+      edges.push_back(std::make_shared<Model::Street>(vertexes[1],vertexes[2]));
+      edges.push_back(std::make_shared<Model::Street>(vertexes[2],vertexes[0]));
+      edges.push_back(std::make_shared<Model::Street>(vertexes[2],vertexes[3]));
+
+      fingerprint.nodesCount = vertexes.size();
+      fingerprint.edgesCount = edges.size();
+      fingerprint.maxNodeId = 4;
+      fingerprint.nodesChecksum = 12345;
+      fingerprint.edgesChecksum = -678;
+    }
+
+    ~Fixture()
+    {
+      std::remove(path.c_str());
+    }
+
+    const std::string path;
+    Model::StreetNodes vertexes;
+    Model::Streets edges;
+    Model::MapFingerprint fingerprint;
+  };
+
+} // namespace MapCache_test
+
+BOOST_FIXTURE_TEST_CASE( Map_adjacency, MapCache_test::Fixture )
+{
+  Model::Map map(vertexes,edges);
+
+  BOOST_CHECK_EQUAL(map.streetsInVertex(vertexes[0]).size(),2);
+  BOOST_CHECK_EQUAL(map.streetsInVertex(vertexes[2]).size(),3);
+  BOOST_CHECK_EQUAL(map.streetsInVertex(vertexes[3]).size(),1);
+  BOOST_CHECK(map.streetsInVertex(vertexes[3]).front() == edges[3]);
+
+  BOOST_CHECK_EQUAL(map.vertexIndex(4),3);
+  BOOST_CHECK_EQUAL(map.vertexIndex(5),Model::Map::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE( MapCache_roundtrip, MapCache_test::Fixture )
+{
+  Model::MapCache cache(path);
+  BOOST_CHECK(!cache.load(fingerprint)); // no file yet
+
+  BOOST_REQUIRE(cache.store(std::make_shared<Model::Map>(vertexes,edges),
+                            fingerprint));
+
+  Model::MapPtr map = cache.load(fingerprint);
+  BOOST_REQUIRE(map);
+  BOOST_REQUIRE_EQUAL(map->vertexes.size(),vertexes.size());
+  BOOST_REQUIRE_EQUAL(map->edges.size(),edges.size());
+
+  for (std::size_t i = 0; i < vertexes.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(map->vertexes[i]->nodeId,vertexes[i]->nodeId);
+    BOOST_CHECK_CLOSE(map->vertexes[i]->lon.get(),vertexes[i]->lon.get(),1e-9);
+    BOOST_CHECK_CLOSE(map->vertexes[i]->lat.get(),vertexes[i]->lat.get(),1e-9);
+    BOOST_CHECK_CLOSE(map->vertexes[i]->mos.get(),vertexes[i]->mos.get(),1e-9);
+  }
+  for (std::size_t i = 0; i < edges.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(map->edges[i]->first->nodeId,edges[i]->first->nodeId);
+    BOOST_CHECK_EQUAL(map->edges[i]->second->nodeId,edges[i]->second->nodeId);
+  }
+  BOOST_CHECK_EQUAL(map->streetsInVertex(map->vertexes[2]).size(),3);
+}
+
+BOOST_FIXTURE_TEST_CASE( MapCache_incompatible_file, MapCache_test::Fixture )
+{
+  {
+    std::FILE* file = std::fopen(path.c_str(),"wb");
+    BOOST_REQUIRE(file);
+    const char garbage[] = "not a map cache, but long enough to have header";
+    std::fwrite(garbage,1,sizeof(garbage),file);
+    std::fclose(file);
+  }
+
+  BOOST_CHECK(!Model::MapCache(path).load(fingerprint));
+}
+
+BOOST_FIXTURE_TEST_CASE( MapCache_stale_file, MapCache_test::Fixture )
+{
+  Model::MapCache cache(path);
+  BOOST_REQUIRE(cache.store(std::make_shared<Model::Map>(vertexes,edges),
+                            fingerprint));
+  BOOST_CHECK(cache.load(fingerprint));
+
+  // node moved in DB - the same counts, other checksum
+  Model::MapFingerprint changed = fingerprint;
+  changed.nodesChecksum += 1;
+  BOOST_CHECK(!cache.load(changed));
+
+  // node added
+  changed = fingerprint;
+  changed.nodesCount += 1;
+  changed.maxNodeId += 1;
+  BOOST_CHECK(!cache.load(changed));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
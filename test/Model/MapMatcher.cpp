@@ -0,0 +1,80 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/mapmatcher.h>
+#include <Model/track.h>
+
+BOOST_AUTO_TEST_SUITE( MapMatcher_test )
+
+namespace MapMatcher_test
+{
+  struct Fixture
+  {
+    Fixture()
+    {
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+
+      // one horizontal street along latitude 52 and one vertical far away
+      Model::StreetNodes vertexes = {
+        std::make_shared<Model::StreetNode>(1,20.0,52.0,100),
+        std::make_shared<Model::StreetNode>(2,20.01,52.0,100),
+        std::make_shared<Model::StreetNode>(3,21.0,52.0,100),
+        std::make_shared<Model::StreetNode>(4,21.0,52.01,100)
+      };
+      Model::Streets edges = {
+        std::make_shared<Model::Street>(vertexes[0],vertexes[1]),
+        std::make_shared<Model::Street>(vertexes[2],vertexes[3])
+      };
+      map = std::make_shared<Model::Map>(vertexes,edges);
+    }
+
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+    Model::MapPtr map;
+  };
+
+} // namespace MapMatcher_test
+
+BOOST_FIXTURE_TEST_CASE( MapMatcher_nearest_street, MapMatcher_test::Fixture )
+{
+  Model::MapMatcher matcher(map,0.001);
+  Model::MapMatcher::Projection projection;
+
+  BOOST_REQUIRE(matcher.findNearestStreet(20.005,52.0004,projection));
+  BOOST_CHECK_EQUAL(projection.edge,0);
+  BOOST_CHECK_CLOSE(projection.lon,20.005,1e-9);
+  BOOST_CHECK_CLOSE(projection.lat,52.0,1e-9);
+  BOOST_CHECK_CLOSE(projection.directionLon,1.0,1e-9);
+
+  // projection beyond segment end is clamped to it
+  BOOST_REQUIRE(matcher.findNearestStreet(21.0005,52.0105,projection));
+  BOOST_CHECK_EQUAL(projection.edge,1);
+  BOOST_CHECK_CLOSE(projection.lat,52.01,1e-9);
+
+  // too far from any street
+  BOOST_CHECK(!matcher.findNearestStreet(20.5,52.0,projection));
+}
+
+BOOST_FIXTURE_TEST_CASE( MapMatcher_track_snapping, MapMatcher_test::Fixture )
+{
+  Model::MapMatcher matcher(map,0.001);
+
+  Track near(filter->clone(),20.005,52.0004,0,0.1,0.1,0);
+  BOOST_REQUIRE(matcher.matchTrack(near));
+  BOOST_CHECK_CLOSE(near.getLongitude(),20.005,1e-9);
+  BOOST_CHECK_CLOSE(near.getLatitude(),52.0,1e-9);
+  // prediction lies on the street, and it's certain across the street
+  BOOST_CHECK_CLOSE(near.getPredictedLatitude(),52.0,1e-9);
+  BOOST_CHECK_SMALL(near.getLatitudePredictionVariance(),1e-9);
+
+  Track far(filter->clone(),20.5,52.0,0,0.1,0.1,0);
+  BOOST_CHECK(!matcher.matchTrack(far));
+  BOOST_CHECK_CLOSE(far.getLongitude(),20.5,1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <Model/platematcher.h>
+
+BOOST_AUTO_TEST_SUITE( PlateMatcher_test )
+
+namespace PlateMatcher_test
+{
+  std::size_t referenceDistance(const std::string& a, const std::string& b)
+  {
+    std::vector<std::vector<std::size_t> > d(
+          a.size() + 1,std::vector<std::size_t>(b.size() + 1));
+    for (std::size_t i = 0; i <= a.size(); ++i)
+      d[i][0] = i;
+    for (std::size_t j = 0; j <= b.size(); ++j)
+      d[0][j] = j;
+    for (std::size_t i = 1; i <= a.size(); ++i)
+      for (std::size_t j = 1; j <= b.size(); ++j)
+        d[i][j] = std::min(std::min(d[i-1][j] + 1,d[i][j-1] + 1),
+                           d[i-1][j-1] + (a[i-1] == b[j-1] ? 0 : 1));
+    return d[a.size()][b.size()];
+  }
+
+  std::string randomPlate(std::size_t length)
+  {
+    static const char alphabet[] = "0125AC8";
+    std::string plate;
+    for (std::size_t i = 0; i < length; ++i)
+      plate.push_back(alphabet[std::rand() % (sizeof(alphabet) - 1)]);
+    return plate;
+  }
+} // namespace PlateMatcher_test
+
+BOOST_AUTO_TEST_CASE( Canonical_plates )
+{
+  BOOST_CHECK_EQUAL(canonicalPlate("wa-b0i 1s"),"WA80115");
+  BOOST_CHECK_EQUAL(canonicalPlate("WO 8I2"),canonicalPlate("w0-bi2"));
+  BOOST_CHECK_EQUAL(plateSimilarity(canonicalPlate("WO 8I2"),
+                                    canonicalPlate("W0 B12")),1);
+}
+
+BOOST_AUTO_TEST_CASE( Bounded_distance )
+{
+  BOOST_CHECK_EQUAL(plateDistance("WA12345","WA12345"),0);
+  BOOST_CHECK_EQUAL(plateDistance("WA12345","WA1245"),1);
+  BOOST_CHECK_EQUAL(plateDistance("WA12345","WX12346"),2);
+  BOOST_CHECK_EQUAL(plateDistance("WA12345","KR999"),maxPlateDistance + 1);
+  BOOST_CHECK_EQUAL(plateDistance("","AB",5),2);
+
+  std::srand(7);
+  for (int i = 0; i < 500; ++i)
+  {
+    const std::string a = PlateMatcher_test::randomPlate(std::rand() % 9);
+    const std::string b = PlateMatcher_test::randomPlate(std::rand() % 9);
+    const std::size_t expected = PlateMatcher_test::referenceDistance(a,b);
+    BOOST_CHECK_EQUAL(plateDistance(a,b,10),expected);
+    BOOST_CHECK_EQUAL(plateDistance(a,b,2),std::min<std::size_t>(expected,3));
+  }
+
+  // longer than 64 characters
+  const std::string longPlate(70,'A');
+  BOOST_CHECK_EQUAL(plateDistance(longPlate,longPlate + "B"),1);
+}
+
+BOOST_AUTO_TEST_CASE( Inverted_index )
+{
+  const Track* first = reinterpret_cast<const Track*>(0x10);
+  const Track* second = reinterpret_cast<const Track*>(0x20);
+
+  PlateIndex index;
+  index.add("WA12345",first);
+  index.add("KR99",second);
+  BOOST_CHECK_EQUAL(index.size(),2);
+
+  std::vector<const Track*> candidates;
+  index.find("WA1235",candidates); // one deletion
+  BOOST_REQUIRE_EQUAL(candidates.size(),1);
+  BOOST_CHECK(candidates[0] == first);
+
+  candidates.clear();
+  index.find("WX12346",candidates); // two substitutions
+  BOOST_REQUIRE_EQUAL(candidates.size(),1);
+  BOOST_CHECK(candidates[0] == first);
+
+  candidates.clear();
+  index.find("GD777",candidates);
+  BOOST_CHECK(candidates.empty());
+
+  index.clear();
+  index.find("WA12345",candidates);
+  BOOST_CHECK(candidates.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/roadmotionmodel.h>
+#include <Model/trackmanager.h>
+
+BOOST_AUTO_TEST_SUITE( RoadMotionModel_test )
+
+namespace RoadMotionModel_test
+{
+  struct Fixture
+  {
+    Fixture()
+    {
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+
+      // T-junction: 1-2-3 is straight street, 2-4 turns left from it
+      Model::StreetNodes vertexes = {
+        std::make_shared<Model::StreetNode>(1,20.0,52.0,100),
+        std::make_shared<Model::StreetNode>(2,20.001,52.0,100),
+        std::make_shared<Model::StreetNode>(3,20.002,52.0,100),
+        std::make_shared<Model::StreetNode>(4,20.001,52.001,100)
+      };
+      Model::Streets edges = {
+        std::make_shared<Model::Street>(vertexes[0],vertexes[1]),
+        std::make_shared<Model::Street>(vertexes[1],vertexes[2]),
+        std::make_shared<Model::Street>(vertexes[1],vertexes[3])
+      };
+      model = std::make_shared<Model::RoadMotionModel>(
+            std::make_shared<Model::Map>(vertexes,edges),0.0002);
+    }
+
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+    std::shared_ptr<Model::RoadMotionModel> model;
+  };
+
+} // namespace RoadMotionModel_test
+
+BOOST_FIXTURE_TEST_CASE( RoadMotionModel_propagation, RoadMotionModel_test::Fixture )
+{
+  Model::RoadMotionModel::Location location;
+  // moving east, along the first street
+  BOOST_REQUIRE(model->locate(20.0002,52.0,1,0,location));
+  BOOST_CHECK_EQUAL(location.directedEdge,0);
+  BOOST_CHECK_CLOSE(location.offset,0.0002,1e-6);
+
+  std::vector<Model::RoadMotionModel::Hypothesis> hypotheses;
+  model->propagate(location,0.0013,hypotheses); // 0.0005 behind junction
+  BOOST_REQUIRE_EQUAL(hypotheses.size(),2);
+
+  double sum = 0;
+  const Model::RoadMotionModel::Hypothesis* straight = nullptr;
+  const Model::RoadMotionModel::Hypothesis* turn = nullptr;
+  for (const Model::RoadMotionModel::Hypothesis& hypothesis : hypotheses)
+  {
+    sum += hypothesis.probability;
+    if (hypothesis.lat < 52.0001)
+      straight = &hypothesis;
+    else
+      turn = &hypothesis;
+  }
+  BOOST_REQUIRE(straight && turn);
+  BOOST_CHECK_CLOSE(sum,1.0,1e-4);
+  BOOST_CHECK_CLOSE(straight->lon,20.0015,1e-6);
+  BOOST_CHECK_CLOSE(turn->lat,52.0005,1e-6);
+  BOOST_CHECK(straight->probability > turn->probability); // going straight is more probable
+
+  // propagation stops at dead end
+  hypotheses.clear();
+  model->propagate(location,0.01,hypotheses);
+  for (const Model::RoadMotionModel::Hypothesis& hypothesis : hypotheses)
+  {
+    BOOST_CHECK(hypothesis.lon <= 20.002 + 1e-9);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE( TrackManager_dormant_reacquisition, RoadMotionModel_test::Fixture )
+{
+  TrackManager tm(1);
+  tm.setRoadMotionModel(model,time_types::duration_t(30),0.0002);
+
+  std::vector<std::set<DetectionReport> > groups = {
+    { DetectionReport(1,1,20.0005,52.0,0,100,100) }
+  };
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > initialized
+      = tm.initializeTracks(groups,filter->clone());
+  BOOST_REQUIRE_EQUAL(initialized.size(),1);
+  const boost::uuids::uuid uuid = initialized.begin()->first->getUuid();
+
+  time_types::ptime_t expiration(boost::chrono::seconds(110));
+  BOOST_CHECK_EQUAL(tm.removeExpiredTracks(expiration,
+                                           time_types::duration_t(3)),1);
+  BOOST_CHECK(tm.getTracksRef().empty());
+  BOOST_CHECK_EQUAL(tm.getDormantTracksCount(),1);
+
+  // DRs far from dormant track initialize new Track
+  groups = { { DetectionReport(1,2,20.5,52.0,0,115,115) } };
+  initialized = tm.initializeTracks(groups,filter->clone());
+  BOOST_REQUIRE_EQUAL(initialized.size(),1);
+  BOOST_CHECK(initialized.begin()->first->getUuid() != uuid);
+  BOOST_CHECK_EQUAL(tm.getDormantTracksCount(),1);
+
+  // DRs near propagated position reacquire dormant Track
+  groups = { { DetectionReport(1,3,20.0006,52.0,0,115,115) } };
+  initialized = tm.initializeTracks(groups,filter->clone());
+  BOOST_REQUIRE_EQUAL(initialized.size(),1);
+  BOOST_CHECK(initialized.begin()->first->getUuid() == uuid);
+  BOOST_CHECK_EQUAL(tm.getDormantTracksCount(),0);
+  BOOST_CHECK_EQUAL(tm.getTracksRef().size(),2);
+}
+
+BOOST_FIXTURE_TEST_CASE( TrackManager_dormant_without_distance, RoadMotionModel_test::Fixture )
+{
+  TrackManager tm(1);
+  tm.setRoadMotionModel(model,time_types::duration_t(30),0); // disabled
+
+  std::vector<std::set<DetectionReport> > groups = {
+    { DetectionReport(1,1,20.0005,52.0,0,100,100) }
+  };
+  BOOST_REQUIRE_EQUAL(tm.initializeTracks(groups,filter->clone()).size(),1);
+
+  time_types::ptime_t expiration(boost::chrono::seconds(110));
+  BOOST_CHECK_EQUAL(tm.removeExpiredTracks(expiration,
+                                           time_types::duration_t(3)),1);
+  BOOST_CHECK_EQUAL(tm.getDormantTracksCount(),0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
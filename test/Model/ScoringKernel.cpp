@@ -0,0 +1,88 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <Common/configurationmanager.h>
+
+#include <Model/detectionreport.h>
+#include <Model/resultcomparator.h>
+#include <Model/scoringkernel.h>
+
+BOOST_AUTO_TEST_SUITE( ScoringKernel_test )
+
+BOOST_AUTO_TEST_CASE( Kernel_matches_scalar_rate )
+{
+  const double maximumPositionRate = 5000;
+  const double lon = 20.0;
+  const double lat = 52.0;
+  const double mos = 0;
+
+  CandidatePositions candidates;
+  std::vector<DetectionReport> DRs;
+  for (int i = 0; i < 7; ++i) // odd number - scalar tail is used too
+  {
+    DRs.push_back(DetectionReport(1,i,lon + i*0.0001,lat - i*0.00005,i,10,10));
+    candidates.add(DRs.back());
+  }
+  BOOST_REQUIRE_EQUAL(candidates.size(),7);
+
+  std::vector<double> rates(candidates.size());
+  rateCandidatePositions(candidates,lon,lat,mos,maximumPositionRate,
+                         rates.data());
+
+  BOOST_CHECK_EQUAL(rates[0],1); // the same position
+  for (std::size_t i = 1; i < DRs.size(); ++i)
+  {
+    const DetectionReport& dr = DRs[i];
+    double expected = 1/std::sqrt(
+          std::pow(dr.getLongitude() - lon,2)
+          + std::pow(dr.getLatitude() - lat,2)
+          + std::pow(dr.getMetersOverSea() - mos,2));
+    expected = std::min(expected,maximumPositionRate)/maximumPositionRate;
+    BOOST_CHECK_CLOSE(rates[i],expected,1e-9);
+    BOOST_CHECK(rates[i] < rates[i-1]); // further is worse
+  }
+
+  candidates.clear();
+  BOOST_CHECK_EQUAL(candidates.size(),0);
+}
+
+BOOST_AUTO_TEST_CASE( Position_gate )
+{
+  try
+  {
+    Common::Configuration::ConfigurationManager::KeyValueMap options
+          = Common::Configuration::getConfigurationFromFile("settings.ini");
+    Common::Configuration::ConfigurationManager& confMan
+        = Common::Configuration::ConfigurationManager::getInstance();
+    confMan.parseKeyValueMapIntoConfiguration(options);
+  }
+  catch (const std::exception&)
+  {
+    ; // workaround for multiple loading configuration,
+      // because of lack of pre-initialization block
+  }
+
+  ResultComparator::feature_grade_map_t gradeRates;
+  gradeRates["Plate"] = 0.8;
+
+  OrComparator orComparator(gradeRates);
+  const double orGate = orComparator.gate(0.5);
+  BOOST_CHECK_CLOSE(orGate,0.2,1e-9);
+  // the best features with position at the gate give exactly threshold
+  ResultComparator::feature_grade_map_t best;
+  best["Plate"] = 1;
+  BOOST_CHECK_CLOSE(orComparator.combine(best,orGate),0.5,1e-9);
+  // without features position alone counts
+  BOOST_CHECK_EQUAL(orComparator.combine(
+                      ResultComparator::feature_grade_map_t(),0.3),0.3);
+
+  AndComparator andComparator(gradeRates);
+  BOOST_CHECK_EQUAL(andComparator.gate(0.5),0.5);
+  gradeRates["Plate"] = 2;
+  BOOST_CHECK_EQUAL(AndComparator(gradeRates).gate(0.5),0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <Common/configurationmanager.h>
+
+#include <Model/estimationfilter.hpp>
+#include <Model/shardedtracker.h>
+
+BOOST_AUTO_TEST_SUITE( ShardedTracker_test )
+
+namespace ShardedTracker_test
+{
+  struct Fixture
+  {
+    Fixture()
+    {
+      try
+      {
+        Common::Configuration::ConfigurationManager::KeyValueMap options
+              = Common::Configuration::getConfigurationFromFile("settings.ini");
+        Common::Configuration::ConfigurationManager& confMan
+            = Common::Configuration::ConfigurationManager::getInstance();
+        confMan.parseKeyValueMapIntoConfiguration(options);
+      }
+      catch (const std::exception&)
+      {
+        ; // workaround for multiple loading configuration,
+          // because of lack of pre-initialization block
+      }
+
+      { // FIXME: really UGLY solution! Only for testing purpose,
+        //  to allow fast tests
+        #include "common/FiltersSetups.h"
+        filter = std::move(kalmanFilter);
+      }
+
+      factory.trackManager = []
+      {
+        return std::make_shared<TrackManager>(5000);
+      };
+      factory.dataAssociator = [](std::shared_ptr<TrackManager> tm)
+      {
+        return std::unique_ptr<DataAssociator>(
+              new DataAssociator(tm,
+                                 std::unique_ptr<ResultComparator>(
+                                   new OrComparator(
+                                     ResultComparator::feature_grade_map_t())),
+                                 std::unique_ptr<ListResultComparator>(
+                                   new OrListComparator()),
+                                 0.3));
+      };
+      factory.fusionExecutor = []
+      {
+        return std::unique_ptr<FusionExecutor>(new FusionExecutor());
+      };
+
+      // two tiles, border at lon = 20.01
+      area.minLon = 20.0;
+      area.minLat = 52.0;
+      area.maxLon = 20.02;
+      area.maxLat = 52.01;
+    }
+
+    std::size_t tracksInShard(Model::ShardedTracker& tracker, std::size_t i)
+    {
+      return tracker.getShard(i).getTracks().size();
+    }
+
+    std::vector<std::set<DetectionReport> > group(int drId, double lon,
+                                                  time_t time)
+    {
+      std::set<DetectionReport> DRs = {
+        DetectionReport(1,drId,lon,52.005,0,time,time)
+      };
+      return std::vector<std::set<DetectionReport> >(1,DRs);
+    }
+
+    std::unique_ptr<estimation::EstimationFilter<> > filter;
+    Model::ShardedTracker::ShardFactory factory;
+    Model::Bounds area;
+  };
+
+} // namespace ShardedTracker_test
+
+BOOST_FIXTURE_TEST_CASE( Routing_by_position, ShardedTracker_test::Fixture )
+{
+  Model::ShardedTracker tracker(area,2,1,0.001,factory,false);
+  BOOST_REQUIRE_EQUAL(tracker.getShardsCount(),2);
+
+  BOOST_CHECK_EQUAL(tracker.shardIndex(20.005,52.005),0);
+  BOOST_CHECK_EQUAL(tracker.shardIndex(20.015,52.005),1);
+  // outside of area - the nearest tile
+  BOOST_CHECK_EQUAL(tracker.shardIndex(19.0,50.0),0);
+  BOOST_CHECK_EQUAL(tracker.shardIndex(21.0,53.0),1);
+
+  tracker.process(group(1,20.005,10),*filter);
+  tracker.process(group(2,20.015,10),*filter);
+  BOOST_CHECK_EQUAL(tracksInShard(tracker,0),1);
+  BOOST_CHECK_EQUAL(tracksInShard(tracker,1),1);
+  BOOST_CHECK_EQUAL(tracker.getTracks().size(),2);
+}
+
+BOOST_FIXTURE_TEST_CASE( Overlap_second_chance, ShardedTracker_test::Fixture )
+{
+  Model::ShardedTracker tracker(area,2,1,0.001,factory,false);
+
+  tracker.process(group(1,20.0098,10),*filter);
+  BOOST_REQUIRE_EQUAL(tracksInShard(tracker,0),1);
+
+  // DR crossed the border, but Track is still in the other tile
+  std::map<std::shared_ptr<Track>,std::set<DetectionReport> > updated
+      = tracker.process(group(2,20.0102,11),*filter);
+  BOOST_CHECK_EQUAL(updated.size(),1);
+  BOOST_CHECK_EQUAL(tracker.getTracks().size(),1); // no duplicated Track
+
+  // far from border - new Track in owning shard
+  tracker.process(group(3,20.018,11),*filter);
+  BOOST_CHECK_EQUAL(tracker.getTracks().size(),2);
+  BOOST_CHECK_EQUAL(tracksInShard(tracker,1),
+                    tracker.getTracks().size() - tracksInShard(tracker,0));
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_handoff, ShardedTracker_test::Fixture )
+{
+  Model::ShardedTracker tracker(area,2,1,0.001,factory,false);
+
+  std::shared_ptr<Track> track(
+        new Track(filter->clone(),20.005,52.005,0,0,0,0));
+  tracker.restoreTracks(std::set<std::shared_ptr<Track> >({ track }));
+  BOOST_REQUIRE_EQUAL(tracksInShard(tracker,0),1);
+
+  track->relocate(20.015,52.005,0,0);
+  tracker.process(std::vector<std::set<DetectionReport> >(),*filter);
+
+  BOOST_CHECK_EQUAL(tracksInShard(tracker,0),0);
+  BOOST_CHECK_EQUAL(tracksInShard(tracker,1),1);
+  BOOST_CHECK(*tracker.getTracks().begin() == track);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
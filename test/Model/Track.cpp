@@ -2,7 +2,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <Model/detectionreport.h>
 #include <Model/estimationfilter.hpp>
+#include <Model/sensornoisetable.h>
 #include <Model/track.h>
 
 BOOST_AUTO_TEST_SUITE( Track_test )
@@ -86,5 +88,238 @@ BOOST_FIXTURE_TEST_CASE( Track_refreshing_simple_test, Track_test::Fixture )
   delete t;
 }
 
+BOOST_FIXTURE_TEST_CASE( Filter_prediction_for_time_step, Track_test::Fixture )
+{
+  estimation::KalmanFilter<>::vector_t state = {{ 0, 0, 0, 1, 0, 0 }};
+  estimation::KalmanFilter<>::vector_t variance;
+  variance.fill(0.1);
+  filter->initialize(state,variance);
+
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > unitStep = filter->predict();
+  BOOST_CHECK_EQUAL(unitStep.first[0],1);
+  // the same as predict()
+  BOOST_CHECK_EQUAL(filter->predictFor(1.0).second[0],unitStep.second[0]);
+
+  // always from the last correction
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > longStep = filter->predictFor(4.0);
+  BOOST_CHECK_CLOSE(longStep.first[0],4,1e-9);
+  BOOST_CHECK_EQUAL(longStep.first[3],1);
+  BOOST_CHECK(longStep.second[0] > unitStep.second[0]);
+
+  // to the same instant (simultaneous measurements) - nothing changes
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > noStep = filter->predictFor(0);
+  BOOST_CHECK_EQUAL(noStep.first[0],0);
+  BOOST_CHECK_CLOSE(noStep.second[0],0.1,1e-9);
+}
+
+BOOST_FIXTURE_TEST_CASE( Filter_process_noise_for_time_step, Track_test::Fixture )
+{
+  // setup: P = 0.1*I, spectral density q = 0.01 (velocity noise of Q)
+  const double p = 0.1;
+  const double q = 0.01;
+  estimation::KalmanFilter<>& kf
+      = dynamic_cast<estimation::KalmanFilter<>&>(*filter);
+
+  for (double dt : { 0.5, 3.0 })
+  {
+    kf.predictFor(dt);
+    const estimation::KalmanFilter<>::Matrix P = kf.getPredictedCovErr();
+    for (std::size_t axis = 0; axis < 3; ++axis)
+    {
+      const std::size_t pos = axis;
+      const std::size_t vel = axis + 3;
+      // A*P*trans(A) + Q(dt)
+      BOOST_CHECK_CLOSE(P(pos,pos),p + dt*dt*p + q*dt*dt*dt/3,1e-9);
+      BOOST_CHECK_CLOSE(P(pos,vel),dt*p + q*dt*dt/2,1e-9);
+      BOOST_CHECK_CLOSE(P(vel,pos),dt*p + q*dt*dt/2,1e-9);
+      BOOST_CHECK_CLOSE(P(vel,vel),p + q*dt,1e-9);
+    }
+    BOOST_CHECK_SMALL(P(0,1),1e-12); // axes are independent
+    BOOST_CHECK_SMALL(P(0,4),1e-12);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE( Filter_steady_state_gain, Track_test::Fixture )
+{
+  estimation::KalmanFilter<>& reference
+      = dynamic_cast<estimation::KalmanFilter<>&>(*filter);
+  estimation::KalmanFilter<> steady(reference);
+  steady.setSteadyStateTolerance(1e-9);
+
+  estimation::KalmanFilter<>::vector_t z;
+  z.fill(0);
+  for (int i = 1; i <= 300; ++i)
+  {
+    z[0] = i;
+    reference.predictFor(1.0);
+    steady.predictFor(1.0);
+    reference.correct(z);
+    steady.correct(z);
+  }
+  BOOST_REQUIRE(steady.isSteadyState());
+  BOOST_CHECK(!reference.isSteadyState());
+
+  // cached gain gives (almost) the same estimates
+  z[0] = 301;
+  reference.predictFor(1.0);
+  steady.predictFor(1.0);
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > expected = reference.correct(z);
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > corrected = steady.correct(z);
+  BOOST_CHECK(steady.isSteadyState());
+  BOOST_CHECK_CLOSE(corrected.first[0],expected.first[0],1e-4);
+  BOOST_CHECK_CLOSE(corrected.first[3],expected.first[3],1e-4);
+  BOOST_CHECK_CLOSE(corrected.second[0],expected.second[0],1e-4);
+
+  // gap - time step differs
+  z[0] = 305;
+  steady.predictFor(4.0);
+  steady.correct(z);
+  BOOST_CHECK(!steady.isSteadyState());
+}
+
+BOOST_FIXTURE_TEST_CASE( Filter_steady_state_gain_jittered_time_step,
+                         Track_test::Fixture )
+{
+  estimation::KalmanFilter<>& reference
+      = dynamic_cast<estimation::KalmanFilter<>&>(*filter);
+  estimation::KalmanFilter<> steady(reference);
+  steady.setSteadyStateTolerance(1e-6);
+  steady.setSteadyTimeStepTolerance(0.01);
+
+  // time steps of camera jitter by milliseconds (1.0+-0.002),
+  //  second (overlapping) camera reports at the same instant
+  estimation::KalmanFilter<>::vector_t z;
+  z.fill(0);
+  double time = 0;
+  for (int i = 1; i <= 300; ++i)
+  {
+    const double timeStep = 1.0 + 0.002*((i*7)%5 - 2)/2;
+    time += timeStep;
+    z[0] = time;
+    reference.predictFor(timeStep);
+    steady.predictFor(timeStep);
+    reference.correct(z);
+    steady.correct(z);
+    reference.predictFor(0);
+    steady.predictFor(0);
+    reference.correct(z);
+    steady.correct(z);
+  }
+  BOOST_REQUIRE(steady.isSteadyState());
+
+  // cached gain gives (almost) the same estimates
+  time += 1.001;
+  z[0] = time;
+  reference.predictFor(1.001);
+  steady.predictFor(1.001);
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > expected = reference.correct(z);
+  std::pair<
+        estimation::EstimationFilter<>::vector_t,
+        estimation::EstimationFilter<>::vector_t
+      > corrected = steady.correct(z);
+  BOOST_CHECK(steady.isSteadyState());
+  BOOST_CHECK_CLOSE(corrected.first[0],expected.first[0],1e-2);
+  BOOST_CHECK_CLOSE(corrected.first[3],expected.first[3],1e-2);
+
+  // simultaneous measurement doesn't break the mode
+  reference.predictFor(0);
+  steady.predictFor(0);
+  expected = reference.correct(z);
+  corrected = steady.correct(z);
+  BOOST_CHECK(steady.isSteadyState());
+  BOOST_CHECK_CLOSE(corrected.second[0],expected.second[0],1e-2);
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_measurement_time_test, Track_test::Fixture )
+{
+  Track t(filter->clone(),0,0,0,0,0,0,p1);
+
+  t.applyMeasurement(DetectionReport(1,1,1,0,0,2,2));
+  BOOST_CHECK(t.getMeasurementTime() == p2);
+
+  // association refreshes Track before DRs are fused
+  t.refresh(p4);
+  t.applyMeasurement(DetectionReport(1,2,3,0,0,4,4));
+  BOOST_CHECK(t.getMeasurementTime() == p4);
+  BOOST_CHECK(t.getRefreshTime() == p4);
+  // moved since p2 (not since refresh time) - velocity is estimated
+  BOOST_CHECK(t.getLongitudeVelocity() > 0);
+  BOOST_CHECK(t.getPredictedLongitude() > t.getLongitude());
+
+  // older measurement doesn't move time back
+  t.applyMeasurement(DetectionReport(1,3,3,0,0,2,2));
+  BOOST_CHECK(t.getMeasurementTime() == p4);
+
+  Track restored(filter->clone(),t.getState());
+  BOOST_CHECK(restored.getMeasurementTime() == p4);
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_meters_over_sea_test, Track_test::Fixture )
+{
+  Track t(filter->clone(),0,0,10,0,0,1,p1);
+  BOOST_CHECK_EQUAL(t.getPredictedMetersOverSea(),10);
+  BOOST_CHECK(t.getMetersOverSeaPredictionVariance() > 0);
+
+  // going up the ramp of parking structure
+  t.applyMeasurement(DetectionReport(1,1,0,0,13,2,2));
+  t.applyMeasurement(DetectionReport(1,2,0,0,16,4,4));
+  BOOST_CHECK(t.getMetersOverSea() > 10);
+  BOOST_CHECK(t.getMetersOverSeaVelocity() > 0);
+  BOOST_CHECK(t.getPredictedMetersOverSea() > t.getMetersOverSea());
+  BOOST_CHECK_SMALL(t.getPredictedLongitude(),1e-9); // axes are independent
+}
+
+BOOST_FIXTURE_TEST_CASE( Track_sensor_noise_test, Track_test::Fixture )
+{
+  SensorNoiseTable noises;
+  noises.set(3,100,100);
+  noises.set(7,0.01,0.01);
+  noises.set(5,100,100);
+  noises.set(-1,1,1); // ignored
+  BOOST_CHECK_EQUAL(noises.size(),3);
+  BOOST_REQUIRE(noises.find(3) != nullptr);
+  BOOST_REQUIRE(noises.find(7) != nullptr);
+  BOOST_REQUIRE(noises.find(5) != nullptr);
+  BOOST_CHECK(noises.find(4) == nullptr);
+  BOOST_CHECK(noises.find(100) == nullptr);
+  BOOST_CHECK(noises.find(-1) == nullptr);
+  BOOST_CHECK_EQUAL(noises.find(3)->noiseClass,noises.find(5)->noiseClass);
+  BOOST_CHECK(noises.find(3)->noiseClass != noises.find(7)->noiseClass);
+  BOOST_CHECK_EQUAL(noises.find(7)->positionVariance,0.01);
+
+  Track filterNoise(filter->clone(),0,0,0,0,0,0,p1);
+  Track noisy(filter->clone(),0,0,0,0,0,0,p1);
+  Track precise(filter->clone(),0,0,0,0,0,0,p1);
+  const DetectionReport dr(3,1,10,0,0,2,2);
+  filterNoise.applyMeasurement(dr);
+  noisy.applyMeasurement(dr,noises.find(3));
+  precise.applyMeasurement(DetectionReport(7,1,10,0,0,2,2),noises.find(7));
+
+  // sensor noise equal to filter's gives the same estimate
+  BOOST_CHECK_CLOSE(noisy.getLongitude(),filterNoise.getLongitude(),1e-9);
+  // precise sensor is trusted more
+  BOOST_CHECK(precise.getLongitude() > noisy.getLongitude());
+  BOOST_CHECK(precise.getLongitudePredictionVariance()
+              < noisy.getLongitudePredictionVariance());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -8,6 +8,7 @@
 
 #include <Model/estimationfilter.hpp>
 #include <Model/featureextractor.h>
+#include <Model/sensornoisetable.h>
 #include <Model/trackmanager.h>
 
 BOOST_AUTO_TEST_SUITE( TrackManager_test )
@@ -261,5 +262,53 @@ BOOST_FIXTURE_TEST_CASE( Expired_tracks_removing, TrackManager_test::Fixture )
   delete tm;
 }
 
-BOOST_AUTO_TEST_SUITE_END()
+BOOST_FIXTURE_TEST_CASE( TrackInitialization_sensor_noise, TrackManager_test::Fixture )
+{
+  std::shared_ptr<SensorNoiseTable> noises
+      = std::make_shared<SensorNoiseTable>();
+  noises->set(1,4,1);
+  noises->set(2,8,1);
+
+  TrackManager tm(1);
+  tm.setFeatureExtractor(std::move(featureExtractor));
+  tm.setSensorNoiseTable(noises);
+
+  std::vector<std::set<DetectionReport> > groups;
+  {
+    std::set<DetectionReport> group = {
+      DetectionReport(1,1,0,0,0,100,95),
+      DetectionReport(2,2,0,0,0,100,95)
+    };
+    groups.push_back(group);
+  }
+  {
+    std::set<DetectionReport> group = {
+      DetectionReport(9,3,50,50,0,100,95) // sensor of unknown noise
+    };
+    groups.push_back(group);
+  }
+
+  tm.initializeTracks(groups,std::move(filter));
+  BOOST_REQUIRE_EQUAL(tm.getTracksRef().size(),2);
 
+  std::shared_ptr<Track> known;
+  std::shared_ptr<Track> unknown;
+  for (const std::shared_ptr<Track>& track : tm.getTracksRef())
+  {
+    if (track->getLongitude() == 0)
+      known = track;
+    else
+      unknown = track;
+  }
+  BOOST_REQUIRE(known && unknown);
+
+  // variance of centroid of two DRs: (4 + 8)/2^2, on top of prediction
+  BOOST_CHECK_CLOSE(known->getLongitudePredictionVariance()
+                      - unknown->getLongitudePredictionVariance(),
+                    3,1e-6);
+  BOOST_CHECK_CLOSE(known->getMetersOverSeaPredictionVariance()
+                      - unknown->getMetersOverSeaPredictionVariance(),
+                    0.5,1e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()